@@ -0,0 +1,88 @@
+#ifndef BENCH_ACCESS_H
+#define BENCH_ACCESS_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "BatteryTypes.h"
+#include "Logger.h"
+#include "UI.h"
+#include "WebUI.h"
+#include "ResultStore.h"
+
+// ============================================
+// FIRMWARE GLOBALS (main.cpp)
+// ============================================
+
+extern PortData portData[NUM_PORTS];
+extern BatteryLogger* logger;
+extern WebUI* webUI;
+extern PhysicalUI* physicalUI;
+extern ResultStore* resultStore;
+
+void setup();
+void loop();
+void updateMOSFETs();
+
+// Runs setup() on the host board once (all sensors present, cells attached)
+void benchBoot();
+
+// Every port mid-discharge with plausible readings and accumulators
+void benchLoadPorts();
+
+// ============================================
+// PRIVATE ACCESS
+// ============================================
+
+// Friend of BatteryLogger, PhysicalUI and WebUI in HOST_BUILD only
+class BenchAccess {
+public:
+    static float medianFilter(BatteryLogger* log, float* buffer, int size) {
+        return log->medianFilter(buffer, size);
+    }
+    
+    static void updateAccumulators(BatteryLogger* log, int port, float voltage,
+                                   float current, int64_t deltaUs) {
+        log->updateAccumulators(port, voltage, current, deltaUs);
+    }
+    
+    // As if every port already had its first reading of the run
+    static void markSampled(BatteryLogger* log) {
+        for (int i = 0; i < NUM_PORTS; i++) log->filterPrimed[i] = true;
+    }
+    
+    static String getStatusJSON(WebUI* web) {
+        return web->getStatusJSON();
+    }
+    
+    static String getPerfJSON(WebUI* web) {
+        return web->getPerfJSON();
+    }
+    
+    // Walks the menus with the real button handlers, as a user would
+    static void openMenu(PhysicalUI* ui, MenuState menu) {
+        ui->returnToMain();
+        switch (menu) {
+            case MENU_MAIN:
+                break;
+            case MENU_PERF:
+                ui->handleLongPress();
+                break;
+            case MENU_BINS:
+                ui->handleButtonPress();
+                ui->menuIndex = NUM_PORTS;
+                ui->handleButtonPress();
+                break;
+            default:
+                for (int m = MENU_MAIN; m < menu; m++) ui->handleButtonPress();
+                break;
+        }
+    }
+    
+    // One full frame of the current menu (draw* + display())
+    static void redraw(PhysicalUI* ui) {
+        ui->displayNeedsUpdate = true;
+        ui->update();
+    }
+};
+
+#endif // BENCH_ACCESS_H
@@ -0,0 +1,25 @@
+#include <benchmark/benchmark.h>
+#include "BenchAccess.h"
+
+// ============================================
+// CONTROL LOOP
+// ============================================
+
+static void BM_UpdateMOSFETs(benchmark::State& state) {
+    benchLoadPorts();
+    
+    for (auto _ : state) {
+        updateMOSFETs();
+    }
+}
+BENCHMARK(BM_UpdateMOSFETs);
+
+// One loop() pass; each one also moves the virtual clock by its delay(10)
+static void BM_Loop(benchmark::State& state) {
+    benchLoadPorts();
+    
+    for (auto _ : state) {
+        loop();
+    }
+}
+BENCHMARK(BM_Loop);
@@ -0,0 +1,28 @@
+#include <benchmark/benchmark.h>
+#include "BenchAccess.h"
+
+// ============================================
+// OLED FRAMES
+// ============================================
+
+// Full frame of one menu: clear, draw* composition, display()
+static void BM_DrawMenu(benchmark::State& state) {
+    MenuState menu = (MenuState)state.range(0);
+    benchLoadPorts();
+    BenchAccess::openMenu(physicalUI, menu);
+    
+    for (auto _ : state) {
+        BenchAccess::redraw(physicalUI);
+    }
+    BenchAccess::openMenu(physicalUI, MENU_MAIN);
+}
+BENCHMARK(BM_DrawMenu)
+    ->ArgName("menu")
+    ->Arg(MENU_MAIN)
+    ->Arg(MENU_PORT_SELECT)
+    ->Arg(MENU_MODE_SELECT)
+    ->Arg(MENU_BATTERY_SELECT)
+    ->Arg(MENU_CUTOFF_ADJUST)
+    ->Arg(MENU_CONFIRM)
+    ->Arg(MENU_PERF)
+    ->Arg(MENU_BINS);
@@ -0,0 +1,72 @@
+#include <benchmark/benchmark.h>
+#include "BenchAccess.h"
+
+// ============================================
+// SAMPLE PATH
+// ============================================
+
+static void BM_MedianFilter(benchmark::State& state) {
+    float buffer[FILTER_SAMPLES];
+    for (int i = 0; i < FILTER_SAMPLES; i++) {
+        buffer[i] = 3.7f + ((i * 7) % FILTER_SAMPLES) * 0.001f;
+    }
+    
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(buffer);
+        benchmark::DoNotOptimize(BenchAccess::medianFilter(logger, buffer, FILTER_SAMPLES));
+    }
+}
+BENCHMARK(BM_MedianFilter);
+
+static void BM_UpdateAccumulators(benchmark::State& state) {
+    benchLoadPorts();
+    int port = 0;
+    
+    for (auto _ : state) {
+        BenchAccess::updateAccumulators(logger, port, 3.7f, 1.0f, SAMPLE_INTERVAL_MS * 1000LL);
+        port = (port + 1) % NUM_PORTS;
+    }
+    benchmark::DoNotOptimize(portData[0].mAh);
+}
+BENCHMARK(BM_UpdateAccumulators);
+
+// Whole per-port sample: read, calibrate, filter, validate, integrate
+static void BM_LoggerUpdatePort(benchmark::State& state) {
+    benchLoadPorts();
+    int port = 0;
+    
+    for (auto _ : state) {
+        logger->updatePort(port);
+        port = (port + 1) % NUM_PORTS;
+    }
+}
+BENCHMARK(BM_LoggerUpdatePort);
+
+// ============================================
+// LOG OUTPUT
+// ============================================
+
+static void BM_GetCSVLine(benchmark::State& state) {
+    benchLoadPorts();
+    size_t bytes = 0;
+    
+    for (auto _ : state) {
+        String line = logger->getCSVLine(0);
+        bytes += line.length();
+        benchmark::DoNotOptimize(line);
+    }
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_GetCSVLine);
+
+static void BM_GetLogRecord(benchmark::State& state) {
+    benchLoadPorts();
+    LogRecord record;
+    
+    for (auto _ : state) {
+        logger->getLogRecord(0, record);
+        benchmark::DoNotOptimize(record);
+    }
+    state.SetBytesProcessed(state.iterations() * sizeof(LogRecord));
+}
+BENCHMARK(BM_GetLogRecord);
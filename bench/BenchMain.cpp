@@ -0,0 +1,52 @@
+#include <benchmark/benchmark.h>
+#include "HostHarness.h"
+#include "BenchAccess.h"
+
+// ============================================
+// HOST BOARD BRING-UP
+// ============================================
+
+void benchBoot() {
+    HostHarness::reset();
+    for (int i = 0; i < NUM_PORTS; i++) {
+        HostHarness::setIna226Reading(HostHarness::ina226Device(i), 3.85f, 1.0f);
+    }
+    setup();
+    
+    // A few hundred finished cells so the bins screen has rows to draw
+    for (int n = 0; n < 300; n++) {
+        int port = n % NUM_PORTS;
+        snprintf(portData[port].cellLabel, sizeof(portData[port].cellLabel), "C%03d", n);
+        portData[port].mAh = 1800 + (n * 37) % 1400;
+        portData[port].Wh = portData[port].mAh * 3.6f / 1000.0f;
+        resultStore->recordCompletion(port);
+    }
+    benchLoadPorts();
+}
+
+void benchLoadPorts() {
+    for (int i = 0; i < NUM_PORTS; i++) {
+        PortData& p = portData[i];
+        p.mode = DISCHARGING;
+        p.batteryType = LIION;
+        p.active = true;
+        p.status = ACTIVE;
+        p.voltage = 3.612f + i * 0.011f;
+        p.current = 0.987f;
+        p.power = p.voltage * p.current;
+        p.mAh = 1234.5f + i * 10.0f;
+        p.Wh = 4.52f + i * 0.1f;
+        p.startTime = 0;
+        snprintf(p.cellLabel, sizeof(p.cellLabel), "B%02d", i);
+    }
+    BenchAccess::markSampled(logger);
+}
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchBoot();
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,31 @@
+#include <benchmark/benchmark.h>
+#include "BenchAccess.h"
+
+// ============================================
+// JSON
+// ============================================
+
+static void BM_GetStatusJSON(benchmark::State& state) {
+    benchLoadPorts();
+    size_t bytes = 0;
+    
+    for (auto _ : state) {
+        String json = BenchAccess::getStatusJSON(webUI);
+        bytes += json.length();
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_GetStatusJSON);
+
+static void BM_GetPerfJSON(benchmark::State& state) {
+    size_t bytes = 0;
+    
+    for (auto _ : state) {
+        String json = BenchAccess::getPerfJSON(webUI);
+        bytes += json.length();
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_GetPerfJSON);
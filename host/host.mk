@@ -0,0 +1,51 @@
+# Shared rules for host builds of the firmware (bench/, sim/)
+# Include from a Makefile one level below the repo root. It defines
+# FIRMWARE_OBJS and HOST_OBJS plus build rules for them and for the
+# including directory's own *.cpp (LOCAL_OBJS).
+
+ROOT := ..
+BUILD := build
+
+# ArduinoJson is header-only; PlatformIO fetches it on the first 'pio run'
+ARDUINOJSON_DIR ?= $(ROOT)/.pio/libdeps/esp32dev/ArduinoJson/src
+
+CXX ?= g++
+CXXFLAGS ?= -O2 -g
+CPPFLAGS += -DHOST_BUILD -I$(ROOT)/host/include -I$(ROOT)/include -I$(ARDUINOJSON_DIR) -I.
+LDLIBS += -lpthread
+
+# Port count override, e.g. 'make NUM_PORTS=16' (run 'make clean' when switching)
+ifdef NUM_PORTS
+CPPFLAGS += -DNUM_PORTS=$(NUM_PORTS)
+endif
+
+FIRMWARE_OBJS := $(patsubst $(ROOT)/src/%.cpp,$(BUILD)/src/%.o,$(wildcard $(ROOT)/src/*.cpp))
+HOST_OBJS := $(patsubst $(ROOT)/host/src/%.cpp,$(BUILD)/host/%.o,$(wildcard $(ROOT)/host/src/*.cpp))
+LOCAL_OBJS := $(patsubst %.cpp,$(BUILD)/local/%.o,$(wildcard *.cpp))
+COMPILE = $(CXX) -std=gnu++17 $(CPPFLAGS) $(CXXFLAGS) -MMD -MP -c $< -o $@
+
+.PHONY: check-deps clean
+
+check-deps:
+	@if [ ! -f "$(ARDUINOJSON_DIR)/ArduinoJson.h" ]; then \
+		echo "❌ ArduinoJson not found in $(ARDUINOJSON_DIR)"; \
+		echo "   Run 'pio run' once, or pass ARDUINOJSON_DIR=<path to ArduinoJson/src>"; \
+		exit 1; \
+	fi
+
+$(BUILD)/src/%.o: $(ROOT)/src/%.cpp | check-deps
+	@mkdir -p $(dir $@)
+	$(COMPILE)
+
+$(BUILD)/host/%.o: $(ROOT)/host/src/%.cpp | check-deps
+	@mkdir -p $(dir $@)
+	$(COMPILE)
+
+$(BUILD)/local/%.o: %.cpp | check-deps
+	@mkdir -p $(dir $@)
+	$(COMPILE)
+
+clean:
+	rm -rf $(BUILD)
+
+-include $(FIRMWARE_OBJS:.o=.d) $(HOST_OBJS:.o=.d) $(LOCAL_OBJS:.o=.d)
@@ -0,0 +1,43 @@
+#ifndef HOST_ADAFRUIT_SSD1306_H
+#define HOST_ADAFRUIT_SSD1306_H
+
+#include <stdint.h>
+#include "Adafruit_GFX.h"
+#include "Wire.h"
+
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+#define SSD1306_INVERSE 2
+#define SSD1306_SWITCHCAPVCC 0x02
+#define SSD1306_DISPLAYOFF 0xAE
+#define SSD1306_DISPLAYON 0xAF
+
+// ============================================
+// SSD1306 (HOST)
+// ============================================
+
+// Page-organised 1bpp framebuffer in RAM, exactly like the library.
+// display() counts frames instead of sending them over I2C.
+class Adafruit_SSD1306 : public Adafruit_GFX {
+private:
+    uint8_t* buffer;
+    uint32_t frames;
+
+public:
+    Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi = &Wire, int8_t rst = -1);
+    ~Adafruit_SSD1306();
+
+    bool begin(uint8_t switchvcc = SSD1306_SWITCHCAPVCC, uint8_t i2caddr = 0x3C,
+               bool reset = true, bool periphBegin = true);
+    void display() { frames++; }
+    void clearDisplay();
+    void dim(bool dim) {}
+    void ssd1306_command(uint8_t c) {}
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    bool getPixel(int16_t x, int16_t y) const;
+
+    uint8_t* getBuffer() { return buffer; }
+    uint32_t getFrameCount() const { return frames; }
+};
+
+#endif // HOST_ADAFRUIT_SSD1306_H
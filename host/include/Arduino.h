@@ -0,0 +1,136 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// ============================================
+// ARDUINO CORE (HOST)
+// ============================================
+
+// Stand-in for the ESP32 Arduino core when firmware sources are compiled
+// for the host (benchmarks, simulator). Only what the firmware uses.
+// Time is virtual: millis()/micros()/esp_timer follow a clock that only
+// moves through delay() or HostHarness::advanceMicros().
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <math.h>
+#include <algorithm>
+#include <cmath>
+
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "WString.h"
+#include "Print.h"
+
+using std::abs;
+using std::isinf;
+using std::isnan;
+using std::max;
+using std::min;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+#define PI 3.1415926535897932384626433832795
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define IRAM_ATTR
+
+// ============================================
+// TIMING / GPIO
+// ============================================
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int digitalRead(uint8_t pin);
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t val);
+
+// Interrupts are recorded, never fired (nothing toggles pins asynchronously)
+#define digitalPinToInterrupt(p) (p)
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t pin);
+
+// CPU clock (feeds ESP.getCpuFreqMHz)
+bool setCpuFrequencyMhz(uint32_t mhz);
+uint32_t getCpuFrequencyMhz();
+
+// LEDC (buzzer tone)
+uint32_t ledcSetup(uint8_t channel, uint32_t freq, uint8_t resolutionBits);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+uint32_t ledcWriteTone(uint8_t channel, uint32_t freq);
+void ledcWrite(uint8_t channel, uint32_t duty);
+
+long random(long max);
+long random(long min, long max);
+
+// No PSRAM on the host: buffers fall back to the internal heap
+bool psramFound();
+
+// newlib has it; glibc only from 2.38
+#if defined(__GLIBC__) && !__GLIBC_PREREQ(2, 38)
+#define HOST_NEEDS_STRLCPY
+size_t strlcpy(char* dst, const char* src, size_t size);
+#endif
+
+// ============================================
+// SERIAL
+// ============================================
+
+// Discarded unless HostHarness::setSerialEcho(true)
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long baud) {}
+    void end() {}
+    int available() { return 0; }
+    int read() { return -1; }
+    void flush() {}
+    operator bool() const { return true; }
+
+    using Print::write;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+};
+
+extern HardwareSerial Serial;
+
+// ============================================
+// ESP
+// ============================================
+
+class EspClass {
+public:
+    // Cycle counter runs on host wall time scaled to the ESP32 clock, so
+    // Profiler figures read as "cycles at 240 MHz" (or the idle clock)
+    uint32_t getCycleCount();
+    uint32_t getCpuFreqMHz() { return getCpuFrequencyMhz(); }
+    uint32_t getFreeHeap();
+    uint32_t getHeapSize() { return 327680; }
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    const char* getSdkVersion() { return "host"; }
+    void restart();
+};
+
+extern EspClass ESP;
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,6 @@
+#ifndef HOST_ASYNCTCP_H
+#define HOST_ASYNCTCP_H
+
+// Networking is not simulated on the host; see ESPAsyncWebServer.h
+
+#endif // HOST_ASYNCTCP_H
@@ -0,0 +1,292 @@
+#ifndef HOST_ESPASYNCWEBSERVER_H
+#define HOST_ESPASYNCWEBSERVER_H
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+#include "Print.h"
+#include "WString.h"
+
+// ============================================
+// ESPASYNCWEBSERVER (HOST)
+// ============================================
+
+// No sockets: routes are registered as usual and can be invoked with
+// AsyncWebServer::dispatch() on a host-built request. Responses are
+// captured on the request for inspection.
+
+typedef enum {
+    HTTP_GET = 0b00000001,
+    HTTP_POST = 0b00000010,
+    HTTP_DELETE = 0b00000100,
+    HTTP_PUT = 0b00001000,
+    HTTP_ANY = 0b01111111
+} WebRequestMethod;
+
+typedef enum {
+    WS_EVT_CONNECT,
+    WS_EVT_DISCONNECT,
+    WS_EVT_PONG,
+    WS_EVT_ERROR,
+    WS_EVT_DATA
+} AwsEventType;
+
+class AsyncWebParameter {
+private:
+    String _name;
+    String _value;
+    bool _isPost;
+
+public:
+    AsyncWebParameter(const String& name, const String& value, bool post)
+        : _name(name), _value(value), _isPost(post) {}
+    const String& name() const { return _name; }
+    const String& value() const { return _value; }
+    bool isPost() const { return _isPost; }
+};
+
+class AsyncResponseStream : public Print {
+private:
+    String _contentType;
+    String _body;
+
+public:
+    AsyncResponseStream(const String& contentType) : _contentType(contentType) {}
+
+    using Print::write;
+    size_t write(uint8_t c) override { _body += (char)c; return 1; }
+    size_t write(const uint8_t* data, size_t len) override { _body.concat((const char*)data, len); return len; }
+
+    const String& contentType() const { return _contentType; }
+    const String& body() const { return _body; }
+};
+
+typedef std::function<size_t(uint8_t*, size_t, size_t)> AwsResponseFiller;
+
+// Fixed-length response produced by a chunk callback; drained on send()
+class AsyncWebServerResponse {
+private:
+    String _contentType;
+    size_t _length;
+    AwsResponseFiller _filler;
+
+public:
+    AsyncWebServerResponse(const String& contentType, size_t len, AwsResponseFiller filler)
+        : _contentType(contentType), _length(len), _filler(filler) {}
+
+    void addHeader(const String& name, const String& value) {}
+
+    const String& contentType() const { return _contentType; }
+    String drain();
+};
+
+class AsyncWebServerRequest {
+private:
+    WebRequestMethod _method;
+    String _url;
+    String _body;
+    std::vector<AsyncWebParameter> params;
+    AsyncResponseStream* stream;
+    AsyncWebServerResponse* response;
+
+public:
+    // Handler scratch (body accumulation); freed with the request like the library
+    void* _tempObject;
+
+    // Captured response
+    int responseCode;
+    String responseType;
+    String responseBody;
+
+    AsyncWebServerRequest(WebRequestMethod method, const String& url)
+        : _method(method), _url(url), stream(nullptr), response(nullptr), _tempObject(nullptr), responseCode(0) {}
+    ~AsyncWebServerRequest() { delete stream; delete response; free(_tempObject); }
+
+    // Host: raw request body, delivered to the route's body handler
+    void setBody(const String& body) { _body = body; }
+    const String& body() const { return _body; }
+    size_t contentLength() const { return _body.length(); }
+
+    void addParam(const String& name, const String& value, bool post = false) {
+        params.push_back(AsyncWebParameter(name, value, post));
+    }
+
+    WebRequestMethod method() const { return _method; }
+    const String& url() const { return _url; }
+    bool hasParam(const String& name, bool post = false) const;
+    AsyncWebParameter* getParam(const String& name, bool post = false);
+
+    void send(int code, const String& contentType = String(), const String& content = String());
+    AsyncResponseStream* beginResponseStream(const String& contentType);
+    void send(AsyncResponseStream* response);
+    AsyncWebServerResponse* beginResponse(const String& contentType, size_t len, AwsResponseFiller filler);
+    void send(AsyncWebServerResponse* response);
+};
+
+typedef std::function<void(AsyncWebServerRequest*)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest*, const String&, size_t, uint8_t*, size_t, bool)> ArUploadHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest*, uint8_t*, size_t, size_t, size_t)> ArBodyHandlerFunction;
+
+class AsyncWebHandler {
+public:
+    virtual ~AsyncWebHandler() {}
+};
+
+typedef enum {
+    WS_CONTINUATION,
+    WS_TEXT,
+    WS_BINARY,
+    WS_DISCONNECT = 0x08,
+    WS_PING,
+    WS_PONG
+} AwsFrameType;
+
+typedef struct {
+    uint8_t message_opcode;
+    uint32_t num;
+    uint8_t final;
+    uint8_t masked;
+    uint8_t opcode;
+    uint64_t len;
+    uint8_t mask[4];
+    uint64_t index;
+} AwsFrameInfo;
+
+class AsyncWebSocket;
+
+class AsyncWebSocketClient {
+private:
+    uint32_t _id;
+    AsyncWebSocket* _server;
+    bool _queueFull;
+    bool _closing;
+
+public:
+    // Host counters
+    uint32_t messagesSent;
+    uint64_t bytesSent;
+
+    AsyncWebSocketClient(uint32_t id, AsyncWebSocket* server)
+        : _id(id), _server(server), _queueFull(false), _closing(false), messagesSent(0), bytesSent(0) {}
+    uint32_t id() const { return _id; }
+    void text(const String& message);
+    void close() { _closing = true; }
+    bool queueIsFull() const { return _queueFull || _closing; }
+
+    // Host: simulate a slow link whose send queue is backed up
+    void setQueueFull(bool full) { _queueFull = full; }
+    bool isClosing() const { return _closing; }
+};
+
+typedef std::function<void(AsyncWebSocket*, AsyncWebSocketClient*, AwsEventType,
+                           void*, uint8_t*, size_t)> AwsEventHandler;
+
+// Clients are created with connect(); close() takes effect (and fires
+// WS_EVT_DISCONNECT) on the next cleanupClients(), as on the device.
+class AsyncWebSocket : public AsyncWebHandler {
+private:
+    String _url;
+    AwsEventHandler handler;
+    std::vector<AsyncWebSocketClient*> clients;
+    uint32_t nextId;
+
+public:
+    // Host counters
+    uint32_t messagesSent;
+    uint64_t bytesSent;
+
+    AsyncWebSocket(const String& url) : _url(url), nextId(1), messagesSent(0), bytesSent(0) {}
+    ~AsyncWebSocket();
+
+    void onEvent(AwsEventHandler h) { handler = h; }
+    size_t count() const;
+    AsyncWebSocketClient* client(uint32_t id);
+    void textAll(const String& message);
+    void cleanupClients(uint16_t maxClients = 8);
+
+    // Host: simulated dashboards
+    AsyncWebSocketClient* connect();
+    void disconnect(uint32_t id);
+    void receive(AsyncWebSocketClient* c, const String& message);
+};
+
+class AsyncEventSource;
+
+class AsyncEventSourceClient {
+private:
+    AsyncEventSource* _server;
+    uint32_t _lastId;
+    bool _connected;
+
+public:
+    // Host counters
+    uint32_t messagesSent;
+    uint64_t bytesSent;
+
+    AsyncEventSourceClient(AsyncEventSource* server)
+        : _server(server), _lastId(0), _connected(true), messagesSent(0), bytesSent(0) {}
+    void send(const char* message, const char* event = NULL, uint32_t id = 0, uint32_t reconnect = 0);
+    void close() { _connected = false; }
+    bool connected() const { return _connected; }
+    uint32_t lastId() const { return _lastId; }
+    size_t packetsWaiting() const { return 0; }
+};
+
+typedef std::function<void(AsyncEventSourceClient*)> ArEventHandlerFunction;
+
+// Clients are created with connect(); a closed one is dropped on the next send
+class AsyncEventSource : public AsyncWebHandler {
+private:
+    String _url;
+    ArEventHandlerFunction connectHandler;
+    std::vector<AsyncEventSourceClient*> clients;
+
+public:
+    // Host counters (one per event, whatever the client count)
+    uint32_t messagesSent;
+    uint64_t bytesSent;
+
+    AsyncEventSource(const String& url) : _url(url), messagesSent(0), bytesSent(0) {}
+    ~AsyncEventSource();
+
+    const char* url() const { return _url.c_str(); }
+    void onConnect(ArEventHandlerFunction cb) { connectHandler = cb; }
+    void send(const char* message, const char* event = NULL, uint32_t id = 0, uint32_t reconnect = 0);
+    size_t count() const;
+    size_t avgPacketsWaiting() const { return 0; }
+    void close();
+
+    // Host: simulated subscribers
+    AsyncEventSourceClient* connect();
+};
+
+class AsyncWebServer {
+private:
+    struct Route {
+        String path;
+        WebRequestMethod method;
+        ArRequestHandlerFunction handler;
+        ArBodyHandlerFunction body;
+    };
+    std::vector<Route> routes;
+
+public:
+    AsyncWebServer(uint16_t port) {}
+
+    void on(const char* uri, WebRequestMethod method, ArRequestHandlerFunction handler) {
+        routes.push_back({String(uri), method, handler, nullptr});
+    }
+    void on(const char* uri, WebRequestMethod method, ArRequestHandlerFunction handler,
+            ArUploadHandlerFunction upload, ArBodyHandlerFunction body) {
+        routes.push_back({String(uri), method, handler, body});
+    }
+    void addHandler(AsyncWebHandler* handler) {}
+    void begin() {}
+    void end() {}
+
+    // Host: run the matching route; returns false (and sends 404) if none
+    bool dispatch(AsyncWebServerRequest* request);
+};
+
+#endif // HOST_ESPASYNCWEBSERVER_H
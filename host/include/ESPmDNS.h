@@ -0,0 +1,19 @@
+#ifndef HOST_ESPMDNS_H
+#define HOST_ESPMDNS_H
+
+#include <stdint.h>
+
+// ============================================
+// MDNS (HOST)
+// ============================================
+
+class MDNSResponder {
+public:
+    bool begin(const char* hostname) { return true; }
+    void end() {}
+    bool addService(const char* service, const char* proto, uint16_t port) { return true; }
+};
+
+extern MDNSResponder MDNS;
+
+#endif // HOST_ESPMDNS_H
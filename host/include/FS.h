@@ -0,0 +1,66 @@
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "WString.h"
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+// ============================================
+// FILE SYSTEM (HOST)
+// ============================================
+
+// Files live in memory (HostHarness::reset() clears them). Handles share
+// the underlying bytes, so data written through one is seen by the next open.
+struct HostFileData {
+    std::vector<uint8_t> bytes;
+};
+
+class File {
+private:
+    std::shared_ptr<HostFileData> data;
+    size_t pos;
+    bool writable;
+
+public:
+    File() : pos(0), writable(false) {}
+    File(std::shared_ptr<HostFileData> d, size_t position, bool canWrite)
+        : data(d), pos(position), writable(canWrite) {}
+
+    operator bool() const { return (bool)data; }
+
+    size_t read(uint8_t* buf, size_t size);
+    int read();
+    size_t write(const uint8_t* buf, size_t size);
+    size_t write(uint8_t c) { return write(&c, 1); }
+    bool seek(uint32_t position);
+    size_t position() const { return pos; }
+    size_t size() const { return data ? data->bytes.size() : 0; }
+    int available() const { return data ? (int)(data->bytes.size() - pos) : 0; }
+    void flush() {}
+    void close() { data.reset(); }
+};
+
+class FS {
+public:
+    File open(const char* path, const char* mode = FILE_READ);
+    File open(const String& path, const char* mode = FILE_READ) { return open(path.c_str(), mode); }
+    bool exists(const char* path);
+    bool remove(const char* path);
+    bool rename(const char* from, const char* to);
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif // HOST_FS_H
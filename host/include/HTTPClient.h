@@ -0,0 +1,39 @@
+#ifndef HOST_HTTPCLIENT_H
+#define HOST_HTTPCLIENT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "WString.h"
+
+// ============================================
+// HTTP CLIENT (HOST)
+// ============================================
+
+// No network on the host: every request fails to connect. Only the OTA
+// download task uses it, and host tasks are never scheduled.
+
+#define HTTP_CODE_OK 200
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+
+class WiFiClient {
+public:
+    int available() { return 0; }
+    size_t readBytes(uint8_t* buffer, size_t length) { return 0; }
+    bool connected() { return false; }
+};
+
+class HTTPClient {
+public:
+    bool begin(const String& url) { return true; }
+    void setTimeout(uint16_t timeout) {}
+    int GET() { return HTTPC_ERROR_CONNECTION_REFUSED; }
+    int getSize() { return -1; }
+    WiFiClient* getStreamPtr() { return &client; }
+    bool connected() { return false; }
+    void end() {}
+
+private:
+    WiFiClient client;
+};
+
+#endif // HOST_HTTPCLIENT_H
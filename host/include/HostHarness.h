@@ -0,0 +1,56 @@
+#ifndef HOST_HARNESS_H
+#define HOST_HARNESS_H
+
+#include <stdint.h>
+#include "INA226_WE.h"
+
+// ============================================
+// HOST HARNESS
+// ============================================
+
+// Controls the simulated board around firmware code built for the host:
+// virtual clock, GPIO levels, sensor readings and peripheral presence.
+class HostHarness {
+public:
+    typedef void (*PinWriteHook)(uint8_t pin, uint8_t level, void* ctx);
+    
+    // Back to power-on state: clock 0, pins low, NVS and files erased
+    static void reset();
+    
+    // Virtual clock; due esp_timer callbacks fire in deadline order
+    static uint64_t nowMicros();
+    static void advanceMicros(uint64_t us);
+    static void advanceMillis(uint32_t ms) { advanceMicros((uint64_t)ms * 1000ULL); }
+    
+    // GPIO
+    static int pinLevel(uint8_t pin);
+    static void setPinInput(uint8_t pin, int level);
+    static void setPinWriteHook(PinWriteHook hook, void* ctx);
+    
+    // Peripherals
+    static void setPcntCount(int unit, int16_t count);
+    static void setI2cPresent(I2cDevice device, bool present);
+    static bool isI2cPresent(I2cDevice device);
+    static void setIna226Reading(I2cDevice device, float busVoltage, float currentA);
+    static void setIna226Source(Ina226Source* source);   // nullptr = fixed readings
+    static Ina226Source* getIna226Source();
+    static uint32_t getBuzzerFrequency();
+    
+    // I2C topology (TCA9548A at I2C_MUX_ADDR when I2C_MUX_ENABLED)
+    static I2cDevice i2cDevice(uint8_t address, int muxChannel = -1);
+    static I2cDevice ina226Device(int port);
+    static I2cDevice selectedDevice(uint8_t address);   // Through the current mux channel
+    static void setMuxSelection(uint8_t channelMask);
+    
+    // ESP-NOW: frames the firmware sent, frames "received" from other units
+    static uint32_t getEspNowSent();
+    static void espNowDeliver(const uint8_t* mac, const uint8_t* data, int len);
+    
+    // Heap figures reported through heap_caps_* and ESP
+    static void setHeap(uint32_t freeBytes, uint32_t largestBlock);
+    
+    // Serial output to stdout (off by default)
+    static void setSerialEcho(bool on);
+};
+
+#endif // HOST_HARNESS_H
@@ -0,0 +1,57 @@
+#ifndef HOST_INA226_WE_H
+#define HOST_INA226_WE_H
+
+#include <stdint.h>
+
+// ============================================
+// INA226_WE (HOST)
+// ============================================
+
+typedef enum {
+    INA226_AVERAGE_1, INA226_AVERAGE_4, INA226_AVERAGE_16, INA226_AVERAGE_64,
+    INA226_AVERAGE_128, INA226_AVERAGE_256, INA226_AVERAGE_512, INA226_AVERAGE_1024
+} INA226_AVERAGES;
+
+typedef enum {
+    INA226_CONV_TIME_140, INA226_CONV_TIME_204, INA226_CONV_TIME_332, INA226_CONV_TIME_588,
+    INA226_CONV_TIME_1100, INA226_CONV_TIME_2116, INA226_CONV_TIME_4156, INA226_CONV_TIME_8244
+} INA226_CONV_TIME;
+
+// I2C device: 7-bit address, plus (TCA9548A channel + 1) << 8 for a
+// device behind the mux
+typedef uint16_t I2cDevice;
+
+// Source of the "true" bus voltage and shunt current of a device. The
+// default source returns values set with HostHarness::setIna226Reading();
+// the simulator installs its own.
+class Ina226Source {
+public:
+    virtual ~Ina226Source() {}
+    
+    // Return false to simulate a NACK (I2C error)
+    virtual bool read(I2cDevice device, float& busVoltage, float& currentA) = 0;
+};
+
+class INA226_WE {
+private:
+    uint8_t address;
+    float correctionFactor;
+    uint8_t errorCode;
+
+public:
+    INA226_WE(uint8_t addr = 0x40) : address(addr), correctionFactor(1.0f), errorCode(0) {}
+
+    bool init() { return true; }
+    void setAverage(INA226_AVERAGES averages) {}
+    void setConversionTime(INA226_CONV_TIME shuntTime, INA226_CONV_TIME busTime) {}
+    void setResistorRange(float resistor, float range) {}
+    void setCorrectionFactor(float factor) { correctionFactor = factor; }
+    void powerDown() {}
+    void powerUp() {}
+
+    float getBusVoltage_V();
+    float getCurrent_mA();
+    uint8_t getI2cErrorCode() const { return errorCode; }
+};
+
+#endif // HOST_INA226_WE_H
@@ -0,0 +1,18 @@
+#ifndef HOST_LITTLEFS_H
+#define HOST_LITTLEFS_H
+
+#include "FS.h"
+
+class LittleFSFS : public fs::FS {
+public:
+    bool begin(bool formatOnFail = false, const char* basePath = "/littlefs",
+               uint8_t maxOpenFiles = 10, const char* partitionLabel = "spiffs");
+    void end() {}
+    bool format();
+    size_t totalBytes() { return 1441792; }
+    size_t usedBytes();
+};
+
+extern LittleFSFS LittleFS;
+
+#endif // HOST_LITTLEFS_H
@@ -0,0 +1,38 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include "WString.h"
+
+// ============================================
+// PREFERENCES / NVS (HOST)
+// ============================================
+
+// In-memory NVS shared by all instances; survives object lifetime like
+// flash does, cleared with HostHarness::reset().
+class Preferences {
+private:
+    std::string ns;
+    bool opened;
+
+public:
+    Preferences() : opened(false) {}
+    ~Preferences() { end(); }
+
+    bool begin(const char* name, bool readOnly = false);
+    void end() { opened = false; }
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+
+    size_t putBytes(const char* key, const void* value, size_t len);
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buf, size_t maxLen);
+
+    size_t putUInt(const char* key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0);
+};
+
+#endif // HOST_PREFERENCES_H
@@ -0,0 +1,27 @@
+#ifndef HOST_UPDATE_H
+#define HOST_UPDATE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================
+// FIRMWARE UPDATE (HOST)
+// ============================================
+
+// Accepts and discards the image; there is no second app partition.
+
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+#define U_FLASH 0
+
+class UpdateClass {
+public:
+    bool begin(size_t size = UPDATE_SIZE_UNKNOWN, int command = U_FLASH) { return true; }
+    size_t write(uint8_t* data, size_t len) { return len; }
+    bool end(bool evenIfRemaining = false) { return true; }
+    void abort() {}
+    const char* errorString() { return "No Error"; }
+};
+
+extern UpdateClass Update;
+
+#endif // HOST_UPDATE_H
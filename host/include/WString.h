@@ -0,0 +1,75 @@
+#ifndef HOST_WSTRING_H
+#define HOST_WSTRING_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+// ============================================
+// ARDUINO STRING (HOST)
+// ============================================
+
+// Heap-backed like the core's WString, so allocation behaviour of String
+// building code (JSON, CSV, HTML) is comparable on the host.
+class String {
+private:
+    std::string s;
+
+public:
+    String() {}
+    String(const char* str) : s(str ? str : "") {}
+    String(const std::string& str) : s(str) {}
+    String(char c) : s(1, c) {}
+    String(int value, unsigned char base = 10);
+    String(unsigned int value, unsigned char base = 10);
+    String(long value, unsigned char base = 10);
+    String(unsigned long value, unsigned char base = 10);
+    String(float value, unsigned int decimalPlaces = 2);
+    String(double value, unsigned int decimalPlaces = 2);
+
+    const char* c_str() const { return s.c_str(); }
+    unsigned int length() const { return s.length(); }
+    bool isEmpty() const { return s.empty(); }
+    bool reserve(unsigned int size) { s.reserve(size); return true; }
+
+    char operator[](unsigned int index) const { return index < s.size() ? s[index] : 0; }
+    char& operator[](unsigned int index) { return s[index]; }
+
+    String& operator+=(const String& rhs) { s += rhs.s; return *this; }
+    String& operator+=(const char* rhs) { if (rhs) s += rhs; return *this; }
+    String& operator+=(char c) { s += c; return *this; }
+    String& operator+=(int value) { return *this += String(value); }
+    String& operator+=(unsigned int value) { return *this += String(value); }
+    String& operator+=(long value) { return *this += String(value); }
+    String& operator+=(unsigned long value) { return *this += String(value); }
+    String& operator+=(float value) { return *this += String(value); }
+    String& operator+=(double value) { return *this += String(value); }
+    bool concat(const char* str, unsigned int len) { s.append(str, len); return true; }
+    bool concat(const String& str) { s += str.s; return true; }
+
+    friend String operator+(const String& lhs, const String& rhs) { String r(lhs); r += rhs; return r; }
+    friend String operator+(const String& lhs, const char* rhs) { String r(lhs); r += rhs; return r; }
+    friend String operator+(const char* lhs, const String& rhs) { String r(lhs); r += rhs; return r; }
+
+    bool operator==(const String& rhs) const { return s == rhs.s; }
+    bool operator==(const char* rhs) const { return rhs && s == rhs; }
+    bool operator!=(const String& rhs) const { return s != rhs.s; }
+    bool operator!=(const char* rhs) const { return !(*this == rhs); }
+    bool equals(const String& rhs) const { return s == rhs.s; }
+
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String& str, unsigned int from = 0) const;
+    bool startsWith(const String& prefix) const { return s.compare(0, prefix.s.size(), prefix.s) == 0; }
+    bool endsWith(const String& suffix) const;
+    String substring(unsigned int begin) const { return begin < s.size() ? String(s.substr(begin)) : String(); }
+    String substring(unsigned int begin, unsigned int end) const;
+    void trim();
+    void toLowerCase();
+    void toUpperCase();
+
+    long toInt() const { return strtol(s.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(s.c_str(), nullptr); }
+    double toDouble() const { return strtod(s.c_str(), nullptr); }
+};
+
+#endif // HOST_WSTRING_H
@@ -0,0 +1,66 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include <stdint.h>
+#include "Print.h"
+
+typedef enum { WIFI_OFF, WIFI_STA, WIFI_AP, WIFI_AP_STA } wifi_mode_t;
+typedef enum { WIFI_IF_STA, WIFI_IF_AP } wifi_interface_t;
+typedef enum { WL_IDLE_STATUS = 0, WL_CONNECTED = 3, WL_CONNECT_FAILED = 4, WL_DISCONNECTED = 6 } wl_status_t;
+
+// Quarter-dBm units, as in the core
+typedef enum {
+    WIFI_POWER_19_5dBm = 78,
+    WIFI_POWER_2dBm = 8
+} wifi_power_t;
+
+class IPAddress : public Printable {
+private:
+    uint8_t octets[4];
+
+public:
+    IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : octets{a, b, c, d} {}
+    uint8_t operator[](int i) const { return octets[i]; }
+    String toString() const;
+    size_t printTo(Print& p) const override;
+};
+
+// ============================================
+// WIFI (HOST)
+// ============================================
+
+// The station never associates: status() stays WL_DISCONNECTED.
+class WiFiClass {
+private:
+    wifi_mode_t currentMode;
+    wifi_power_t txPower;
+    const char* hostname;
+
+public:
+    WiFiClass() : currentMode(WIFI_OFF), txPower(WIFI_POWER_19_5dBm), hostname("") {}
+
+    bool mode(wifi_mode_t m) { currentMode = m; return true; }
+    wifi_mode_t getMode() const { return currentMode; }
+    wl_status_t begin(const char* ssid, const char* password = nullptr) { return WL_DISCONNECTED; }
+    wl_status_t status() const { return WL_DISCONNECTED; }
+    bool setAutoReconnect(bool on) { return true; }
+    bool setHostname(const char* name) { hostname = name; return true; }
+    const char* getHostname() const { return hostname; }
+    IPAddress localIP() { return IPAddress(); }
+    int8_t RSSI() { return 0; }
+    uint8_t* macAddress(uint8_t* mac) {
+        static const uint8_t hostMac[6] = {0x24, 0x0A, 0xC4, 0x00, 0x3F, 0x2A};
+        for (int i = 0; i < 6; i++) mac[i] = hostMac[i];
+        return mac;
+    }
+    bool softAP(const char* ssid, const char* password = nullptr, int channel = 1,
+                int hidden = 0, int maxConnection = 4) { return true; }
+    IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+    uint8_t softAPgetStationNum() { return 0; }
+    bool setTxPower(wifi_power_t power) { txPower = power; return true; }
+    wifi_power_t getTxPower() const { return txPower; }
+};
+
+extern WiFiClass WiFi;
+
+#endif // HOST_WIFI_H
@@ -0,0 +1,31 @@
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================
+// I2C (HOST)
+// ============================================
+
+// Only device presence and TCA9548A channel selection are modelled;
+// register traffic goes through the device classes (INA226_WE,
+// Adafruit_SSD1306) directly.
+class TwoWire {
+private:
+    uint8_t txAddress;
+    uint8_t txData;
+
+public:
+    TwoWire() : txAddress(0), txData(0) {}
+
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) { return true; }
+    bool setClock(uint32_t frequency) { return true; }
+    void beginTransmission(uint8_t address) { txAddress = address; }
+    size_t write(uint8_t data) { txData = data; return 1; }
+    uint8_t endTransmission(bool sendStop = true);   // 0 = ACK, 2 = NACK on address
+};
+
+extern TwoWire Wire;
+
+#endif // HOST_WIRE_H
@@ -0,0 +1,25 @@
+#ifndef HOST_ESP_MAC_H
+#define HOST_ESP_MAC_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// ============================================
+// ESP_MAC (HOST)
+// ============================================
+
+// Factory MAC, the same one the host WiFi.macAddress() returns
+
+typedef enum {
+    ESP_MAC_WIFI_STA,
+    ESP_MAC_WIFI_SOFTAP
+} esp_mac_type_t;
+
+inline esp_err_t esp_read_mac(uint8_t* mac, esp_mac_type_t type) {
+    static const uint8_t hostMac[6] = {0x24, 0x0A, 0xC4, 0x00, 0x3F, 0x2A};
+    for (int i = 0; i < 6; i++) mac[i] = hostMac[i];
+    if (type == ESP_MAC_WIFI_SOFTAP) mac[5]++;
+    return ESP_OK;
+}
+
+#endif // HOST_ESP_MAC_H
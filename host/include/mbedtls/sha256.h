@@ -0,0 +1,25 @@
+#ifndef HOST_MBEDTLS_SHA256_H
+#define HOST_MBEDTLS_SHA256_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// ============================================
+// SHA-256 (HOST)
+// ============================================
+
+// Link-only stand-in: the digest is all zeros. Only the OTA download task
+// hashes, and host tasks are never scheduled.
+
+typedef struct {
+    uint32_t unused;
+} mbedtls_sha256_context;
+
+static inline void mbedtls_sha256_init(mbedtls_sha256_context* ctx) {}
+static inline void mbedtls_sha256_free(mbedtls_sha256_context* ctx) {}
+static inline void mbedtls_sha256_starts(mbedtls_sha256_context* ctx, int is224) {}
+static inline void mbedtls_sha256_update(mbedtls_sha256_context* ctx, const unsigned char* input, size_t len) {}
+static inline void mbedtls_sha256_finish(mbedtls_sha256_context* ctx, unsigned char output[32]) { memset(output, 0, 32); }
+
+#endif // HOST_MBEDTLS_SHA256_H
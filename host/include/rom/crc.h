@@ -0,0 +1,9 @@
+#ifndef HOST_ROM_CRC_H
+#define HOST_ROM_CRC_H
+
+#include <stdint.h>
+
+// Same polynomial and conventions as the ESP32 ROM (CRC-32/ISO-HDLC)
+uint32_t crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len);
+
+#endif // HOST_ROM_CRC_H
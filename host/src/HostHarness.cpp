@@ -0,0 +1,344 @@
+#include <Arduino.h>
+#include <driver/pcnt.h>
+#include <esp_heap_caps.h>
+#include <rom/crc.h>
+#include <chrono>
+#include <map>
+#include <vector>
+#include "HostHarness.h"
+
+// Storage and peripherals keep their own state (HostStorage.cpp etc.)
+void hostStorageReset();
+void hostPeripheralsReset();
+void hostNetworkReset();
+
+// ============================================
+// BOARD STATE
+// ============================================
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void* arg;
+    uint64_t deadline;
+    uint64_t period;        // 0 = one-shot
+    bool active;
+};
+
+static uint64_t nowUs = 0;
+static uint8_t pinLevels[64];
+static HostHarness::PinWriteHook pinWriteHook = nullptr;
+static void* pinWriteContext = nullptr;
+static int16_t pcntCounts[PCNT_UNIT_MAX];
+static uint32_t ledcFrequency[16];
+static uint32_t heapFree = 200000;
+static uint32_t heapLargest = 110000;
+static uint32_t heapMinFree = 200000;
+static uint32_t cpuMhz = 240;
+static void (*interruptHandlers[64])(void);
+static uint32_t pendingNotify = 0;
+static bool serialEcho = false;
+static std::vector<esp_timer*> timers;
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// ============================================
+// HARNESS CONTROL
+// ============================================
+
+void HostHarness::reset() {
+    nowUs = 0;
+    memset(pinLevels, 0, sizeof(pinLevels));
+    memset(pcntCounts, 0, sizeof(pcntCounts));
+    memset(ledcFrequency, 0, sizeof(ledcFrequency));
+    pinWriteHook = nullptr;
+    pinWriteContext = nullptr;
+    cpuMhz = 240;
+    memset(interruptHandlers, 0, sizeof(interruptHandlers));
+    pendingNotify = 0;
+    for (esp_timer* t : timers) t->active = false;
+    heapFree = heapMinFree = 200000;
+    heapLargest = 110000;
+    hostStorageReset();
+    hostPeripheralsReset();
+    hostNetworkReset();
+}
+
+uint64_t HostHarness::nowMicros() {
+    return nowUs;
+}
+
+void HostHarness::advanceMicros(uint64_t us) {
+    uint64_t target = nowUs + us;
+
+    while (true) {
+        esp_timer* next = nullptr;
+        for (esp_timer* t : timers) {
+            if (t->active && t->deadline <= target && (!next || t->deadline < next->deadline)) {
+                next = t;
+            }
+        }
+        if (!next) break;
+
+        if (next->deadline > nowUs) nowUs = next->deadline;
+        if (next->period) {
+            next->deadline += next->period;
+        } else {
+            next->active = false;
+        }
+        next->callback(next->arg);
+    }
+    nowUs = target;
+}
+
+int HostHarness::pinLevel(uint8_t pin) {
+    return pin < sizeof(pinLevels) ? pinLevels[pin] : LOW;
+}
+
+void HostHarness::setPinInput(uint8_t pin, int level) {
+    if (pin < sizeof(pinLevels)) pinLevels[pin] = level ? HIGH : LOW;
+}
+
+void HostHarness::setPinWriteHook(PinWriteHook hook, void* ctx) {
+    pinWriteHook = hook;
+    pinWriteContext = ctx;
+}
+
+void HostHarness::setPcntCount(int unit, int16_t count) {
+    if (unit >= 0 && unit < PCNT_UNIT_MAX) pcntCounts[unit] = count;
+}
+
+uint32_t HostHarness::getBuzzerFrequency() {
+    for (uint32_t f : ledcFrequency) {
+        if (f) return f;
+    }
+    return 0;
+}
+
+void HostHarness::setHeap(uint32_t freeBytes, uint32_t largestBlock) {
+    heapFree = freeBytes;
+    heapLargest = largestBlock;
+    if (freeBytes < heapMinFree) heapMinFree = freeBytes;
+}
+
+void HostHarness::setSerialEcho(bool on) {
+    serialEcho = on;
+}
+
+// ============================================
+// TIMING / GPIO
+// ============================================
+
+unsigned long millis() { return (unsigned long)(nowUs / 1000); }
+unsigned long micros() { return (unsigned long)nowUs; }
+void delay(uint32_t ms) { HostHarness::advanceMicros((uint64_t)ms * 1000ULL); }
+void delayMicroseconds(uint32_t us) { HostHarness::advanceMicros(us); }
+void yield() {}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (mode == INPUT_PULLUP) HostHarness::setPinInput(pin, HIGH);
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+    if (pin >= sizeof(pinLevels)) return;
+    pinLevels[pin] = level ? HIGH : LOW;
+    if (pinWriteHook) pinWriteHook(pin, pinLevels[pin], pinWriteContext);
+}
+
+int digitalRead(uint8_t pin) {
+    return HostHarness::pinLevel(pin);
+}
+
+// Bit-banged like the core, so pin hooks see every clock edge
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t val) {
+    for (int i = 0; i < 8; i++) {
+        int bit = bitOrder == LSBFIRST ? i : 7 - i;
+        digitalWrite(dataPin, (val >> bit) & 1);
+        digitalWrite(clockPin, HIGH);
+        digitalWrite(clockPin, LOW);
+    }
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode) {
+    if (pin < 64) interruptHandlers[pin] = handler;
+}
+
+void detachInterrupt(uint8_t pin) {
+    if (pin < 64) interruptHandlers[pin] = nullptr;
+}
+
+bool setCpuFrequencyMhz(uint32_t mhz) {
+    if (mhz != 240 && mhz != 160 && mhz != 80) return false;
+    cpuMhz = mhz;
+    return true;
+}
+
+uint32_t getCpuFrequencyMhz() { return cpuMhz; }
+
+uint32_t ledcSetup(uint8_t channel, uint32_t freq, uint8_t resolutionBits) { return freq; }
+void ledcAttachPin(uint8_t pin, uint8_t channel) {}
+void ledcWrite(uint8_t channel, uint32_t duty) {}
+
+uint32_t ledcWriteTone(uint8_t channel, uint32_t freq) {
+    if (channel < 16) ledcFrequency[channel] = freq;
+    return freq;
+}
+
+long random(long max) { return max > 0 ? rand() % max : 0; }
+long random(long min, long max) { return max > min ? min + rand() % (max - min) : min; }
+bool psramFound() { return false; }
+
+// ============================================
+// SERIAL / ESP
+// ============================================
+
+size_t HardwareSerial::write(uint8_t c) {
+    if (serialEcho) fputc(c, stdout);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    if (serialEcho) fwrite(buffer, 1, size, stdout);
+    return size;
+}
+
+uint32_t EspClass::getCycleCount() {
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    return (uint32_t)(ns * getCpuFreqMHz() / 1000);
+}
+
+uint32_t EspClass::getFreeHeap() { return heapFree; }
+uint32_t EspClass::getMinFreeHeap() { return heapMinFree; }
+uint32_t EspClass::getMaxAllocHeap() { return heapLargest; }
+
+void EspClass::restart() {
+    fprintf(stderr, "ESP.restart() called on host\n");
+    abort();
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) { return heapFree; }
+size_t heap_caps_get_minimum_free_size(uint32_t caps) { return heapMinFree; }
+size_t heap_caps_get_largest_free_block(uint32_t caps) { return heapLargest; }
+esp_err_t heap_caps_register_failed_alloc_callback(esp_alloc_failed_hook_t callback) { return ESP_OK; }
+void* heap_caps_malloc(size_t size, uint32_t caps) { return (caps & MALLOC_CAP_SPIRAM) ? nullptr : malloc(size); }
+void heap_caps_free(void* ptr) { free(ptr); }
+
+// ============================================
+// ESP_TIMER
+// ============================================
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out) {
+    if (!args || !args->callback || !out) return ESP_ERR_INVALID_ARG;
+    esp_timer* t = new esp_timer{args->callback, args->arg, 0, 0, false};
+    timers.push_back(t);
+    *out = t;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs) {
+    if (timer->active) return ESP_ERR_INVALID_STATE;
+    timer->deadline = nowUs + timeoutUs;
+    timer->period = 0;
+    timer->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs) {
+    if (timer->active) return ESP_ERR_INVALID_STATE;
+    timer->deadline = nowUs + periodUs;
+    timer->period = periodUs;
+    timer->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (!timer->active) return ESP_ERR_INVALID_STATE;
+    timer->active = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    for (size_t i = 0; i < timers.size(); i++) {
+        if (timers[i] == timer) timers.erase(timers.begin() + i);
+    }
+    delete timer;
+    return ESP_OK;
+}
+
+int64_t esp_timer_get_time() {
+    return (int64_t)nowUs;
+}
+
+// ============================================
+// PULSE COUNTER
+// ============================================
+
+esp_err_t pcnt_unit_config(const pcnt_config_t* config) { return ESP_OK; }
+esp_err_t pcnt_set_filter_value(pcnt_unit_t unit, uint16_t value) { return ESP_OK; }
+esp_err_t pcnt_filter_enable(pcnt_unit_t unit) { return ESP_OK; }
+esp_err_t pcnt_counter_pause(pcnt_unit_t unit) { return ESP_OK; }
+esp_err_t pcnt_counter_resume(pcnt_unit_t unit) { return ESP_OK; }
+
+esp_err_t pcnt_counter_clear(pcnt_unit_t unit) {
+    pcntCounts[unit] = 0;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_get_counter_value(pcnt_unit_t unit, int16_t* count) {
+    *count = pcntCounts[unit];
+    return ESP_OK;
+}
+
+// ============================================
+// FREERTOS
+// ============================================
+
+static int dummyTask;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t stackDepth,
+                                   void* param, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core) {
+    if (handle) *handle = &dummyTask;
+    return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() { return nullptr; }
+BaseType_t xTaskNotifyGive(TaskHandle_t task) { return pdPASS; }
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken) {
+    pendingNotify++;
+}
+
+// The loop task is the only waiter: without a pending notification the
+// wait times out, so the virtual clock moves by the full timeout
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait) {
+    if (pendingNotify == 0 && ticksToWait != portMAX_DELAY) {
+        delay(ticksToWait * portTICK_PERIOD_MS);
+    }
+    uint32_t count = pendingNotify;
+    pendingNotify = clearOnExit ? 0 : (count ? count - 1 : 0);
+    return count;
+}
+void vTaskDelay(TickType_t ticks) { delay(ticks * portTICK_PERIOD_MS); }
+void vTaskDelete(TaskHandle_t task) {}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() { return new int(0); }
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticksToWait) { return pdTRUE; }
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) { return pdTRUE; }
+void vSemaphoreDelete(SemaphoreHandle_t sem) { delete (int*)sem; }
+
+// ============================================
+// ROM CRC
+// ============================================
+
+uint32_t crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
@@ -0,0 +1,281 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <ESPAsyncWebServer.h>
+#include <esp_now.h>
+#include <ESPmDNS.h>
+#include "HostHarness.h"
+
+WiFiClass WiFi;
+MDNSResponder MDNS;
+
+static bool espNowReady = false;
+static esp_now_send_cb_t espNowSendCb = nullptr;
+static esp_now_recv_cb_t espNowRecvCb = nullptr;
+static uint32_t espNowSent = 0;
+
+void hostNetworkReset() {
+    espNowReady = false;
+    espNowSendCb = nullptr;
+    espNowRecvCb = nullptr;
+    espNowSent = 0;
+}
+
+// ============================================
+// IP ADDRESS
+// ============================================
+
+String IPAddress::toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+    return String(buf);
+}
+
+size_t IPAddress::printTo(Print& p) const {
+    return p.print(toString());
+}
+
+// ============================================
+// WEB SERVER
+// ============================================
+
+bool AsyncWebServerRequest::hasParam(const String& name, bool post) const {
+    for (const AsyncWebParameter& p : params) {
+        if (p.name() == name && p.isPost() == post) return true;
+    }
+    return false;
+}
+
+AsyncWebParameter* AsyncWebServerRequest::getParam(const String& name, bool post) {
+    for (AsyncWebParameter& p : params) {
+        if (p.name() == name && p.isPost() == post) return &p;
+    }
+    return nullptr;
+}
+
+void AsyncWebServerRequest::send(int code, const String& contentType, const String& content) {
+    responseCode = code;
+    responseType = contentType;
+    responseBody = content;
+}
+
+AsyncResponseStream* AsyncWebServerRequest::beginResponseStream(const String& contentType) {
+    delete stream;
+    stream = new AsyncResponseStream(contentType);
+    return stream;
+}
+
+void AsyncWebServerRequest::send(AsyncResponseStream* response) {
+    responseCode = 200;
+    responseType = response->contentType();
+    responseBody = response->body();
+}
+
+// Same chunking as a TCP send window; an empty fill ends the body early
+String AsyncWebServerResponse::drain() {
+    String body;
+    uint8_t chunk[1436];
+    size_t index = 0;
+    while (index < _length) {
+        size_t n = _filler(chunk, min(sizeof(chunk), _length - index), index);
+        if (n == 0) break;
+        body.concat((const char*)chunk, n);
+        index += n;
+    }
+    return body;
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(const String& contentType, size_t len,
+                                                             AwsResponseFiller filler) {
+    delete response;
+    response = new AsyncWebServerResponse(contentType, len, filler);
+    return response;
+}
+
+void AsyncWebServerRequest::send(AsyncWebServerResponse* r) {
+    responseCode = 200;
+    responseType = r->contentType();
+    responseBody = r->drain();
+}
+
+bool AsyncWebServer::dispatch(AsyncWebServerRequest* request) {
+    for (const Route& r : routes) {
+        if (r.path == request->url() && (r.method & request->method())) {
+            // Body arrives in TCP-sized pieces before the request handler runs
+            const String& body = request->body();
+            size_t total = body.length();
+            for (size_t index = 0; r.body && index < total; index += 1436) {
+                size_t len = min((size_t)1436, total - index);
+                r.body(request, (uint8_t*)body.c_str() + index, len, index, total);
+            }
+            r.handler(request);
+            return true;
+        }
+    }
+    request->send(404, "text/plain", "Not found");
+    return false;
+}
+
+// ============================================
+// WEBSOCKET
+// ============================================
+
+void AsyncWebSocketClient::text(const String& message) {
+    if (queueIsFull()) return;      // The library drops it too
+    messagesSent++;
+    bytesSent += message.length();
+    _server->messagesSent++;
+    _server->bytesSent += message.length();
+}
+
+AsyncWebSocket::~AsyncWebSocket() {
+    for (AsyncWebSocketClient* c : clients) delete c;
+}
+
+size_t AsyncWebSocket::count() const {
+    size_t n = 0;
+    for (AsyncWebSocketClient* c : clients) {
+        if (!c->isClosing()) n++;
+    }
+    return n;
+}
+
+AsyncWebSocketClient* AsyncWebSocket::client(uint32_t id) {
+    for (AsyncWebSocketClient* c : clients) {
+        if (c->id() == id) return c;
+    }
+    return nullptr;
+}
+
+void AsyncWebSocket::textAll(const String& message) {
+    for (AsyncWebSocketClient* c : clients) c->text(message);
+}
+
+void AsyncWebSocket::cleanupClients(uint16_t maxClients) {
+    // Oldest first, like the library
+    if (count() > maxClients) clients.front()->close();
+    for (size_t i = 0; i < clients.size(); ) {
+        if (clients[i]->isClosing()) {
+            disconnect(clients[i]->id());
+        } else {
+            i++;
+        }
+    }
+}
+
+AsyncWebSocketClient* AsyncWebSocket::connect() {
+    AsyncWebSocketClient* c = new AsyncWebSocketClient(nextId++, this);
+    clients.push_back(c);
+    if (handler) handler(this, c, WS_EVT_CONNECT, nullptr, nullptr, 0);
+    return c;
+}
+
+void AsyncWebSocket::disconnect(uint32_t id) {
+    for (size_t i = 0; i < clients.size(); i++) {
+        if (clients[i]->id() != id) continue;
+        AsyncWebSocketClient* c = clients[i];
+        clients.erase(clients.begin() + i);
+        if (handler) handler(this, c, WS_EVT_DISCONNECT, nullptr, nullptr, 0);
+        delete c;
+        return;
+    }
+}
+
+void AsyncWebSocket::receive(AsyncWebSocketClient* c, const String& message) {
+    AwsFrameInfo info = {};
+    info.message_opcode = info.opcode = WS_TEXT;
+    info.final = 1;
+    info.len = message.length();
+    if (handler) handler(this, c, WS_EVT_DATA, &info, (uint8_t*)message.c_str(), message.length());
+}
+
+// ============================================
+// SERVER-SENT EVENTS
+// ============================================
+
+void AsyncEventSourceClient::send(const char* message, const char* event, uint32_t id, uint32_t reconnect) {
+    if (!_connected) return;
+    if (id) _lastId = id;
+    messagesSent++;
+    bytesSent += strlen(message);
+}
+
+AsyncEventSource::~AsyncEventSource() {
+    for (AsyncEventSourceClient* c : clients) delete c;
+}
+
+void AsyncEventSource::send(const char* message, const char* event, uint32_t id, uint32_t reconnect) {
+    for (size_t i = 0; i < clients.size(); ) {
+        if (!clients[i]->connected()) {
+            delete clients[i];
+            clients.erase(clients.begin() + i);
+            continue;
+        }
+        clients[i]->send(message, event, id, reconnect);
+        i++;
+    }
+    messagesSent++;
+    bytesSent += strlen(message);
+}
+
+size_t AsyncEventSource::count() const {
+    size_t n = 0;
+    for (AsyncEventSourceClient* c : clients) {
+        if (c->connected()) n++;
+    }
+    return n;
+}
+
+void AsyncEventSource::close() {
+    for (AsyncEventSourceClient* c : clients) c->close();
+}
+
+AsyncEventSourceClient* AsyncEventSource::connect() {
+    AsyncEventSourceClient* c = new AsyncEventSourceClient(this);
+    clients.push_back(c);
+    if (connectHandler) connectHandler(c);
+    return c;
+}
+
+// ============================================
+// ESP-NOW
+// ============================================
+
+esp_err_t esp_now_init() {
+    espNowReady = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_now_deinit() {
+    hostNetworkReset();
+    return ESP_OK;
+}
+
+esp_err_t esp_now_add_peer(const esp_now_peer_info_t* peer) {
+    return espNowReady ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t esp_now_register_send_cb(esp_now_send_cb_t cb) {
+    espNowSendCb = cb;
+    return ESP_OK;
+}
+
+esp_err_t esp_now_register_recv_cb(esp_now_recv_cb_t cb) {
+    espNowRecvCb = cb;
+    return ESP_OK;
+}
+
+esp_err_t esp_now_send(const uint8_t* peer, const uint8_t* data, size_t len) {
+    if (!espNowReady) return ESP_ERR_INVALID_STATE;
+    if (len > ESP_NOW_MAX_DATA_LEN) return ESP_ERR_INVALID_ARG;
+    espNowSent++;
+    if (espNowSendCb) espNowSendCb(peer, ESP_NOW_SEND_SUCCESS);
+    return ESP_OK;
+}
+
+uint32_t HostHarness::getEspNowSent() {
+    return espNowSent;
+}
+
+void HostHarness::espNowDeliver(const uint8_t* mac, const uint8_t* data, int len) {
+    if (espNowReady && espNowRecvCb) espNowRecvCb(mac, data, len);
+}
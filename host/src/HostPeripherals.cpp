@@ -0,0 +1,270 @@
+#include <Arduino.h>
+#include <Wire.h>
+#include <INA226_WE.h>
+#include <Adafruit_GFX.h>
+#include <Adafruit_SSD1306.h>
+#include <map>
+#include <set>
+#include "HostHarness.h"
+#include "Config.h"
+
+// ============================================
+// I2C DEVICES
+// ============================================
+
+TwoWire Wire;
+
+static std::set<I2cDevice> absentDevices;
+static uint8_t muxSelection = 0;
+
+struct FixedReading {
+    float busVoltage;
+    float currentA;
+};
+
+// Default INA226 source: whatever the host last set per device
+class FixedIna226Source : public Ina226Source {
+public:
+    std::map<I2cDevice, FixedReading> readings;
+
+    bool read(I2cDevice device, float& busVoltage, float& currentA) override {
+        if (!HostHarness::isI2cPresent(device)) return false;
+        auto it = readings.find(device);
+        busVoltage = it == readings.end() ? 0.0f : it->second.busVoltage;
+        currentA = it == readings.end() ? 0.0f : it->second.currentA;
+        return true;
+    }
+};
+
+static FixedIna226Source fixedSource;
+static Ina226Source* inaSource = &fixedSource;
+
+void hostPeripheralsReset() {
+    absentDevices.clear();
+    muxSelection = 0;
+    fixedSource.readings.clear();
+    inaSource = &fixedSource;
+}
+
+void HostHarness::setI2cPresent(I2cDevice device, bool present) {
+    if (present) {
+        absentDevices.erase(device);
+    } else {
+        absentDevices.insert(device);
+    }
+}
+
+bool HostHarness::isI2cPresent(I2cDevice device) {
+    return absentDevices.count(device) == 0;
+}
+
+void HostHarness::setIna226Reading(I2cDevice device, float busVoltage, float currentA) {
+    fixedSource.readings[device] = {busVoltage, currentA};
+}
+
+I2cDevice HostHarness::i2cDevice(uint8_t address, int muxChannel) {
+    return muxChannel < 0 ? address : (I2cDevice)(((muxChannel + 1) << 8) | address);
+}
+
+I2cDevice HostHarness::ina226Device(int port) {
+    return i2cDevice(ina226Address(port), ina226Channel(port));
+}
+
+// Main-bus devices (OLED, the mux itself) answer whatever channel is open
+I2cDevice HostHarness::selectedDevice(uint8_t address) {
+    if (!I2C_MUX_ENABLED || muxSelection == 0 || address == I2C_MUX_ADDR || address == OLED_ADDR) {
+        return address;
+    }
+    return i2cDevice(address, __builtin_ctz(muxSelection));
+}
+
+void HostHarness::setMuxSelection(uint8_t channelMask) {
+    muxSelection = channelMask;
+}
+
+void HostHarness::setIna226Source(Ina226Source* source) {
+    inaSource = source ? source : &fixedSource;
+}
+
+Ina226Source* HostHarness::getIna226Source() {
+    return inaSource;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    if (!HostHarness::isI2cPresent(HostHarness::selectedDevice(txAddress))) return 2;
+    if (I2C_MUX_ENABLED && txAddress == I2C_MUX_ADDR) HostHarness::setMuxSelection(txData);
+    return 0;
+}
+
+// ============================================
+// INA226
+// ============================================
+
+float INA226_WE::getBusVoltage_V() {
+    float voltage, current;
+    if (!inaSource->read(HostHarness::selectedDevice(address), voltage, current)) {
+        errorCode = 2;
+        return 0.0f;
+    }
+    errorCode = 0;
+    return voltage;
+}
+
+// The correction factor scales the calibration register, i.e. the current
+float INA226_WE::getCurrent_mA() {
+    float voltage, current;
+    if (!inaSource->read(HostHarness::selectedDevice(address), voltage, current)) {
+        errorCode = 2;
+        return 0.0f;
+    }
+    errorCode = 0;
+    return current * 1000.0f * correctionFactor;
+}
+
+// ============================================
+// GFX
+// ============================================
+
+// Synthetic 5x7 glyph column (about half the pixels lit); space is blank
+static uint8_t glyphColumn(unsigned char c, int col) {
+    if (c == ' ') return 0;
+    return (uint8_t)(c * 37 + col * 91) & 0x7F;
+}
+
+Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h)
+    : _width(w), _height(h), cursor_x(0), cursor_y(0),
+      textcolor(0xFFFF), textbgcolor(0xFFFF), textsize(1), wrap(true) {}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    for (int16_t i = 0; i < w; i++) drawPixel(x + i, y, color);
+}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    for (int16_t i = 0; i < h; i++) drawPixel(x, y + i, color);
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    for (int16_t i = x; i < x + w; i++) drawFastVLine(i, y, h, color);
+}
+
+void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+    int16_t dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int16_t dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int16_t err = dx + dy;
+    while (true) {
+        drawPixel(x0, y0, color);
+        if (x0 == x1 && y0 == y1) break;
+        int16_t e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x0 += sx; }
+        if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+}
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, y + h - 1, w, color);
+    drawFastVLine(x, y, h, color);
+    drawFastVLine(x + w - 1, y, h, color);
+}
+
+void Adafruit_GFX::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+    int16_t f = 1 - r, ddx = 1, ddy = -2 * r, x = 0, y = r;
+    drawPixel(x0, y0 + r, color);
+    drawPixel(x0, y0 - r, color);
+    drawPixel(x0 + r, y0, color);
+    drawPixel(x0 - r, y0, color);
+    while (x < y) {
+        if (f >= 0) { y--; ddy += 2; f += ddy; }
+        x++; ddx += 2; f += ddx;
+        drawPixel(x0 + x, y0 + y, color);
+        drawPixel(x0 - x, y0 + y, color);
+        drawPixel(x0 + x, y0 - y, color);
+        drawPixel(x0 - x, y0 - y, color);
+        drawPixel(x0 + y, y0 + x, color);
+        drawPixel(x0 - y, y0 + x, color);
+        drawPixel(x0 + y, y0 - x, color);
+        drawPixel(x0 - y, y0 - x, color);
+    }
+}
+
+void Adafruit_GFX::fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+    for (int16_t dy = -r; dy <= r; dy++) {
+        int16_t dx = (int16_t)sqrtf((float)(r * r - dy * dy));
+        drawFastHLine(x0 - dx, y0 + dy, 2 * dx + 1, color);
+    }
+}
+
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+                            uint16_t bg, uint8_t size) {
+    if (x >= _width || y >= _height || x + 6 * size - 1 < 0 || y + 8 * size - 1 < 0) return;
+
+    for (int8_t i = 0; i < 5; i++) {
+        uint8_t line = glyphColumn(c, i);
+        for (int8_t j = 0; j < 8; j++, line >>= 1) {
+            if (line & 1) {
+                if (size == 1) drawPixel(x + i, y + j, color);
+                else fillRect(x + i * size, y + j * size, size, size, color);
+            } else if (bg != color) {
+                if (size == 1) drawPixel(x + i, y + j, bg);
+                else fillRect(x + i * size, y + j * size, size, size, bg);
+            }
+        }
+    }
+    if (bg != color) {
+        if (size == 1) drawFastVLine(x + 5, y, 8, bg);
+        else fillRect(x + 5 * size, y, size, 8 * size, bg);
+    }
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+    if (c == '\n') {
+        cursor_x = 0;
+        cursor_y += textsize * 8;
+    } else if (c != '\r') {
+        if (wrap && cursor_x + textsize * 6 > _width) {
+            cursor_x = 0;
+            cursor_y += textsize * 8;
+        }
+        drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize);
+        cursor_x += textsize * 6;
+    }
+    return 1;
+}
+
+// ============================================
+// SSD1306
+// ============================================
+
+Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi, int8_t rst)
+    : Adafruit_GFX(w, h), frames(0) {
+    buffer = new uint8_t[w * ((h + 7) / 8)];
+    memset(buffer, 0, w * ((h + 7) / 8));
+}
+
+Adafruit_SSD1306::~Adafruit_SSD1306() {
+    delete[] buffer;
+}
+
+bool Adafruit_SSD1306::begin(uint8_t switchvcc, uint8_t i2caddr, bool reset, bool periphBegin) {
+    return HostHarness::isI2cPresent(i2caddr);
+}
+
+void Adafruit_SSD1306::clearDisplay() {
+    memset(buffer, 0, _width * ((_height + 7) / 8));
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (x < 0 || x >= _width || y < 0 || y >= _height) return;
+    uint8_t& byte = buffer[x + (y / 8) * _width];
+    uint8_t bit = 1 << (y & 7);
+    switch (color) {
+        case SSD1306_WHITE: byte |= bit; break;
+        case SSD1306_BLACK: byte &= ~bit; break;
+        case SSD1306_INVERSE: byte ^= bit; break;
+    }
+}
+
+bool Adafruit_SSD1306::getPixel(int16_t x, int16_t y) const {
+    if (x < 0 || x >= _width || y < 0 || y >= _height) return false;
+    return buffer[x + (y / 8) * _width] & (1 << (y & 7));
+}
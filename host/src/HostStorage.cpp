@@ -0,0 +1,191 @@
+#include <Arduino.h>
+#include <Preferences.h>
+#include <LittleFS.h>
+#include <Update.h>
+#include <esp_ota_ops.h>
+#include <map>
+#include <vector>
+
+// ============================================
+// NVS (PREFERENCES)
+// ============================================
+
+typedef std::map<std::string, std::vector<uint8_t>> NvsNamespace;
+static std::map<std::string, NvsNamespace> nvs;
+
+bool Preferences::begin(const char* name, bool readOnly) {
+    ns = name;
+    opened = true;
+    return true;
+}
+
+bool Preferences::clear() {
+    if (!opened) return false;
+    nvs[ns].clear();
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    return opened && nvs[ns].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+    return opened && nvs[ns].count(key) > 0;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+    if (!opened) return 0;
+    const uint8_t* bytes = (const uint8_t*)value;
+    nvs[ns][key] = std::vector<uint8_t>(bytes, bytes + len);
+    return len;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    if (!opened) return 0;
+    NvsNamespace& space = nvs[ns];
+    auto it = space.find(key);
+    return it == space.end() ? 0 : it->second.size();
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+    if (!opened) return 0;
+    NvsNamespace& space = nvs[ns];
+    auto it = space.find(key);
+    if (it == space.end() || it->second.size() > maxLen) return 0;
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+}
+
+uint32_t Preferences::getUInt(const char* key, uint32_t defaultValue) {
+    uint32_t value;
+    return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+}
+
+// ============================================
+// FILE SYSTEM
+// ============================================
+
+static std::map<std::string, std::shared_ptr<fs::HostFileData>> files;
+static bool mounted = false;
+
+LittleFSFS LittleFS;
+
+void hostStorageReset() {
+    nvs.clear();
+    files.clear();
+    mounted = false;
+}
+
+size_t fs::File::read(uint8_t* buf, size_t size) {
+    if (!data || pos >= data->bytes.size()) return 0;
+    size_t n = std::min(size, data->bytes.size() - pos);
+    memcpy(buf, data->bytes.data() + pos, n);
+    pos += n;
+    return n;
+}
+
+int fs::File::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+size_t fs::File::write(const uint8_t* buf, size_t size) {
+    if (!data || !writable) return 0;
+    if (pos + size > data->bytes.size()) data->bytes.resize(pos + size);
+    memcpy(data->bytes.data() + pos, buf, size);
+    pos += size;
+    return size;
+}
+
+bool fs::File::seek(uint32_t position) {
+    if (!data || position > data->bytes.size()) return false;
+    pos = position;
+    return true;
+}
+
+fs::File fs::FS::open(const char* path, const char* mode) {
+    if (!mounted) return File();
+    auto it = files.find(path);
+
+    if (mode[0] == 'r') {
+        if (it == files.end()) return File();
+        return File(it->second, 0, false);
+    }
+
+    if (it == files.end() || mode[0] == 'w') {
+        files[path] = std::make_shared<HostFileData>();
+        it = files.find(path);
+    }
+    return File(it->second, mode[0] == 'a' ? it->second->bytes.size() : 0, true);
+}
+
+bool fs::FS::exists(const char* path) {
+    return mounted && files.count(path) > 0;
+}
+
+bool fs::FS::remove(const char* path) {
+    return mounted && files.erase(path) > 0;
+}
+
+bool fs::FS::rename(const char* from, const char* to) {
+    if (!mounted) return false;
+    auto it = files.find(from);
+    if (it == files.end()) return false;
+    files[to] = it->second;
+    files.erase(it);
+    return true;
+}
+
+bool LittleFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles,
+                       const char* partitionLabel) {
+    mounted = true;
+    return true;
+}
+
+bool LittleFSFS::format() {
+    files.clear();
+    return true;
+}
+
+size_t LittleFSFS::usedBytes() {
+    size_t used = 0;
+    for (auto& f : files) used += f.second->bytes.size();
+    return used;
+}
+
+// ============================================
+// FIRMWARE UPDATE / OTA PARTITIONS
+// ============================================
+
+UpdateClass Update;
+
+static const esp_partition_t appPartitions[2] = {
+    {0x10000, 0x140000, "app0"},
+    {0x150000, 0x140000, "app1"}
+};
+
+static const esp_app_desc_t appDescription = {"host", "charger", __TIME__, __DATE__};
+
+const esp_partition_t* esp_ota_get_running_partition() {
+    return &appPartitions[0];
+}
+
+const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t* start_from) {
+    return &appPartitions[1];
+}
+
+esp_err_t esp_ota_get_state_partition(const esp_partition_t* partition, esp_ota_img_states_t* state) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t* partition) {
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_mark_app_valid_cancel_rollback() {
+    return ESP_OK;
+}
+
+const esp_app_desc_t* esp_ota_get_app_description() {
+    return &appDescription;
+}
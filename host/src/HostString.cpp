@@ -0,0 +1,129 @@
+#include <Arduino.h>
+
+// ============================================
+// STRING
+// ============================================
+
+static std::string formatInteger(unsigned long value, bool negative, unsigned char base) {
+    char buf[8 * sizeof(long) + 2];
+    char* p = &buf[sizeof(buf) - 1];
+    *p = '\0';
+    if (base < 2) base = 10;
+    do {
+        unsigned digit = value % base;
+        *--p = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        value /= base;
+    } while (value);
+    if (negative) *--p = '-';
+    return std::string(p);
+}
+
+String::String(int value, unsigned char base) : String((long)value, base) {}
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {}
+
+String::String(long value, unsigned char base) {
+    if (base == 10 && value < 0) {
+        s = formatInteger(-(unsigned long)value, true, base);
+    } else {
+        s = formatInteger((unsigned long)value, false, base);
+    }
+}
+
+String::String(unsigned long value, unsigned char base) : s(formatInteger(value, false, base)) {}
+
+String::String(float value, unsigned int decimalPlaces) : String((double)value, decimalPlaces) {}
+
+String::String(double value, unsigned int decimalPlaces) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimalPlaces, value);
+    s = buf;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    size_t pos = s.find(c, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String& str, unsigned int from) const {
+    size_t pos = s.find(str.s, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+bool String::endsWith(const String& suffix) const {
+    return s.size() >= suffix.s.size() &&
+           s.compare(s.size() - suffix.s.size(), suffix.s.size(), suffix.s) == 0;
+}
+
+String String::substring(unsigned int begin, unsigned int end) const {
+    if (begin > end) std::swap(begin, end);
+    if (begin >= s.size()) return String();
+    return String(s.substr(begin, end - begin));
+}
+
+void String::trim() {
+    size_t first = s.find_first_not_of(" \t\r\n");
+    size_t last = s.find_last_not_of(" \t\r\n");
+    s = first == std::string::npos ? std::string() : s.substr(first, last - first + 1);
+}
+
+void String::toLowerCase() {
+    for (char& c : s) c = tolower(c);
+}
+
+void String::toUpperCase() {
+    for (char& c : s) c = toupper(c);
+}
+
+#ifdef HOST_NEEDS_STRLCPY
+size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+    if (size) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+#endif
+
+// ============================================
+// PRINT
+// ============================================
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buffer++);
+    return n;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (len < 0) return 0;
+
+    if ((size_t)len < sizeof(buf)) {
+        return write((const uint8_t*)buf, len);
+    }
+
+    // Long output: same heap fallback as the core
+    std::string big(len + 1, '\0');
+    va_start(args, format);
+    vsnprintf(&big[0], big.size(), format, args);
+    va_end(args);
+    return write((const uint8_t*)big.data(), len);
+}
+
+size_t Print::print(long value, int base) {
+    return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(unsigned long value, int base) {
+    return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(double value, int digits) {
+    return print(String(value, (unsigned int)digits));
+}
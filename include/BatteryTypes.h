@@ -61,6 +61,11 @@ struct PortData {
     float customCutoff;
     bool useCustomCutoff;
     
+    // Cell identification / internal resistance
+    char cellLabel[12];         // Optional label for the result record
+    float dcir;                 // mOhm from start-of-discharge load step, 0 = none
+    bool dcirPending;           // Measure DCIR at next discharge start
+    
     // Status
     PortStatus status;
     bool active;
@@ -68,18 +73,26 @@ struct PortData {
     unsigned long lastUpdate;
     
     // Error tracking
-    int errorCount;
+    int errorCount;             // Consecutive invalid readings
     char errorMsg[64];
     
+    // Lifetime counters (not cleared by reset)
+    uint32_t sampleCount;       // Valid samples taken
+    uint32_t invalidCount;      // Readings rejected by validation
+    uint32_t i2cErrorCount;     // Failed INA226 I2C transactions
+    
     // Constructor with defaults
     PortData() : 
         voltage(0), current(0), mAh(0), Wh(0), power(0),
         mode(SAFETY), batteryType(LIION), 
         customCutoff(3.0), useCustomCutoff(false),
+        dcir(0), dcirPending(true),
         status(IDLE), active(false), 
         startTime(0), lastUpdate(0),
-        errorCount(0) {
+        errorCount(0),
+        sampleCount(0), invalidCount(0), i2cErrorCount(0) {
         errorMsg[0] = '\0';
+        cellLabel[0] = '\0';
     }
     
     // Get effective cutoff voltage
@@ -126,6 +139,8 @@ struct PortData {
     void reset() {
         mAh = 0;
         Wh = 0;
+        dcir = 0;
+        dcirPending = true;
         startTime = millis();
         errorCount = 0;
         errorMsg[0] = '\0';
@@ -0,0 +1,68 @@
+#ifndef BUZZER_H
+#define BUZZER_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "Config.h"
+
+// ============================================
+// ENUMERATIONS
+// ============================================
+
+enum BuzzerPattern {
+    BEEP_NONE = 0,
+    BEEP_MENU,          // Short beep for menu navigation
+    BEEP_SELECT,        // Medium beep for selection
+    BEEP_COMPLETE,      // Port number in pips + long beep
+    BEEP_ERROR          // Port number in low pips + error tone
+};
+
+// ============================================
+// NOTE STRUCT
+// ============================================
+
+struct BuzzerNote {
+    uint16_t freq;       // Hz, 0 = rest
+    uint16_t durationMs;
+};
+
+// ============================================
+// BUZZER SEQUENCER CLASS
+// ============================================
+
+// Plays multi-note patterns on a LEDC channel. Note changes are driven by
+// a one-shot esp_timer, so timing does not depend on the main loop rate.
+// play()/stop() (loop) and the timer callback (esp_timer task) hold one
+// mutex around the sequence and the LEDC writes. A callback that was
+// already running when stop() was called sees the generation changed and
+// leaves the new sequence alone.
+class Buzzer {
+private:
+    esp_timer_handle_t timer;
+    SemaphoreHandle_t mutex;
+    
+    // Sequence being played (copied from pattern table)
+    BuzzerNote sequence[BUZZER_MAX_NOTES];
+    volatile uint8_t length;
+    volatile uint8_t position;
+    volatile uint32_t generation;   // Bumped by every play() and stop()
+    
+    uint8_t append(uint8_t count, const BuzzerNote* notes, uint8_t noteCount);
+    void silence();
+    void startNote(uint8_t index);
+    void advance(uint32_t fired);
+    
+    static void onTimer(void* arg);
+
+public:
+    Buzzer();
+    
+    bool begin();
+    void play(BuzzerPattern pattern, int port = -1);
+    void stop();
+    bool isPlaying() const { return position < length; }
+};
+
+#endif // BUZZER_H
@@ -0,0 +1,151 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "Config.h"
+#include "BatteryTypes.h"
+#include "Logger.h"
+
+// ============================================
+// ENUMERATIONS
+// ============================================
+
+enum CaptureTrigger {
+    CAPTURE_TRIGGER_LOAD = 0,   // Load held off for the pre window, then switched on
+    CAPTURE_TRIGGER_DIP         // Voltage drops CAPTURE_DIP_MV below the running baseline
+};
+
+enum CaptureState {
+    CAPTURE_IDLE = 0,
+    CAPTURE_ARMED,
+    CAPTURE_DONE,
+    CAPTURE_TIMEOUT,
+    CAPTURE_FAILED
+};
+
+// ============================================
+// BINARY CAPTURE FORMAT
+// ============================================
+
+// GET /api/capture?format=bin: header followed by sampleCount samples in
+// time order. Little-endian, same packing rules as the log records.
+#define CAPTURE_BIN_MAGIC 0x50414357    // "WCAP"
+#define CAPTURE_BIN_VERSION 1
+
+struct __attribute__((packed)) CaptureFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t sampleSize;
+    uint8_t port;
+    uint8_t trigger;
+    uint16_t reserved;
+    uint32_t sampleCount;
+    uint32_t triggerIndex;      // First sample at or after the trigger
+    uint32_t intervalUs;        // Requested spacing; timeUs has the real one
+    uint32_t capturedAt;        // Uptime seconds at the trigger
+};
+
+struct __attribute__((packed)) CaptureSample {
+    int32_t timeUs;             // Relative to the trigger (negative = before)
+    uint16_t millivolts;
+    int16_t milliamps;
+};
+
+// Switches a port's discharge MOSFET immediately (outside updateMOSFETs)
+typedef void (*LoadSwitchFn)(int port, bool on);
+
+// ============================================
+// WAVEFORM CAPTURE CLASS
+// ============================================
+
+// Samples one port in logger burst mode around a trigger. Armed from the
+// web task; all sampling runs in loop(), CAPTURE_SLICE_MS per pass so the
+// MOSFETs, cutoff and web keep running (timestamps show the gaps). A
+// trigger starts a fresh slice, so the edge and the first slice after it
+// are always back to back: the load step opens a pass, a dip extends the
+// pass it fired in.
+class WaveformCapture {
+private:
+    PortData* portData;
+    BatteryLogger* logger;
+    LoadSwitchFn loadSwitch;
+    
+    // Sample ring, allocated once at boot
+    CaptureSample* samples;
+    uint32_t capacity;
+    bool inPsram;
+    
+    // Request
+    volatile CaptureState state;
+    volatile bool cancelPending;
+    uint32_t generation;            // Bumped on every arm (stale downloads stop)
+    int port;
+    CaptureTrigger trigger;
+    uint32_t preSamples;
+    uint32_t postSamples;
+    uint32_t intervalUs;
+    float dipVolts;
+    unsigned long armedAt;
+    bool started;                   // Burst mode entered (first loop pass after arming)
+    bool holdLoad;
+    bool triggered;                 // Post window in progress
+    uint32_t readErrors;            // Consecutive failed reads, across slices
+    
+    // Pre-trigger ring [0, preSamples), post window linear after it
+    uint32_t head;
+    uint32_t preFilled;
+    int64_t nextSampleUs;
+    float baseline;
+    uint32_t triggerTime;
+    uint32_t postTaken;
+    
+    // Result
+    uint32_t sampleCount;
+    uint32_t triggerIndex;
+    uint32_t capturedAt;
+    uint32_t actualIntervalUs;
+    uint16_t minMillivolts;
+    uint16_t maxMillivolts;
+    int16_t maxMilliamps;
+    char result[48];
+    
+    bool takeSample(CaptureSample& s);
+    bool readFailed();
+    void startPost(uint32_t time, uint32_t taken);
+    bool samplePost(int64_t sliceEnd, float& volts);
+    void linearize();
+    void finish(CaptureState next, const char* message);
+    
+public:
+    WaveformCapture(PortData* data);
+    
+    void setLogger(BatteryLogger* l) { logger = l; }
+    void setLoadSwitch(LoadSwitchFn fn) { loadSwitch = fn; }
+    
+    bool begin();
+    void update();
+    
+    // loop() (queued by the web handler); false with a reason in getResult()
+    bool arm(int port, CaptureTrigger trigger, uint32_t preMs, uint32_t postMs, uint32_t dipMv);
+    
+    // Why arm() would refuse right now, or nullptr (read-only, any task)
+    const char* checkArm(int port, CaptureTrigger trigger) const;
+    void cancel();
+    
+    CaptureState getState() const { return state; }
+    const char* getResult() const { return result; }
+    uint32_t getGeneration() const { return generation; }
+    
+    // Load-step capture keeps the MOSFET off until the pre window is sampled
+    bool isLoadHeld(int p) const { return holdLoad && p == port; }
+    
+    // Download (valid while getState() == CAPTURE_DONE)
+    void getHeader(CaptureFileHeader& header);
+    size_t getBinarySize() const { return sizeof(CaptureFileHeader) + sampleCount * sizeof(CaptureSample); }
+    size_t readBinary(uint8_t* out, size_t maxLen, size_t index);
+    
+    void addStatusJSON(JsonObject out);
+};
+
+#endif // CAPTURE_H
@@ -0,0 +1,80 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "Config.h"
+#include "BatteryTypes.h"
+
+// ============================================
+// CHECKPOINT RECORD
+// ============================================
+
+struct PortCheckpoint {
+    float mAh;
+    float Wh;
+    uint32_t elapsedMs;         // millis() is reset on boot - store duration
+    float customCutoff;
+    uint8_t mode;
+    uint8_t batteryType;
+    uint8_t status;
+    uint8_t flags;              // bit0 = active, bit1 = useCustomCutoff
+};
+
+struct CheckpointRecord {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t portCount;
+    uint32_t sequence;          // Higher wins when both slots are valid
+    PortCheckpoint ports[NUM_PORTS];
+    uint32_t crc;               // CRC32 of everything above
+};
+
+// ============================================
+// CHECKPOINT STORE CLASS
+// ============================================
+
+// Double-buffered NVS checkpoint of in-progress tests. Records alternate
+// between two keys, so a reset mid-write always leaves one valid copy.
+// Writes happen on a low-priority task; loop() only copies a snapshot.
+class CheckpointStore {
+private:
+    PortData* portData;
+    Preferences prefs;
+    
+    // Writer task handoff
+    TaskHandle_t writerTask;
+    portMUX_TYPE lock;
+    CheckpointRecord outgoing;
+    uint32_t sequence;
+    
+    // Change detection
+    OperationMode lastMode[NUM_PORTS];
+    PortStatus lastStatus[NUM_PORTS];
+    unsigned long lastWrite;
+    
+    // Record found at boot, waiting for resume/discard
+    CheckpointRecord saved;
+    bool resumePending;
+    unsigned long offerTime;
+    
+    bool readSlot(const char* key, CheckpointRecord& out);
+    void requestWrite();
+    void writeRecord(CheckpointRecord& record);
+    static uint32_t computeCRC(const CheckpointRecord& record);
+    static void writerLoop(void* arg);
+
+public:
+    CheckpointStore(PortData* data);
+    
+    bool begin();
+    void update();
+    
+    // Resume offer (OLED prompt / web API)
+    bool hasPendingResume() const { return resumePending; }
+    const CheckpointRecord& getPending() const { return saved; }
+    void resume();
+    void discard();
+};
+
+#endif // CHECKPOINT_H
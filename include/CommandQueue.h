@@ -0,0 +1,153 @@
+#ifndef COMMAND_QUEUE_H
+#define COMMAND_QUEUE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <atomic>
+#include "Config.h"
+#include "BatteryTypes.h"
+#include "Checkpoint.h"
+#include "Logger.h"
+#include "Capture.h"
+#include "Compressor.h"
+
+static_assert((COMMAND_QUEUE_SIZE & (COMMAND_QUEUE_SIZE - 1)) == 0, "COMMAND_QUEUE_SIZE must be a power of two");
+static_assert(COMMAND_QUEUE_SIZE >= NUM_PORTS, "A full-width batch must fit the command queue");
+
+// ============================================
+// COMMANDS
+// ============================================
+
+#define PORT_SET_MODE 0x01
+#define PORT_SET_BATTERY 0x02
+#define PORT_SET_CUTOFF 0x04
+#define PORT_SET_RESET 0x08
+#define PORT_SET_START 0x10     // Reset and run (encoder confirm), after the settings
+
+// One port's settings; only the flagged fields apply
+struct PortSettings {
+    uint8_t port;
+    uint8_t fields;
+    OperationMode mode;
+    BatteryType batteryType;
+    float cutoff;
+};
+
+#define CAL_SET_VOLTAGE_GAIN 0x01
+#define CAL_SET_VOLTAGE_OFFSET 0x02
+#define CAL_SET_CURRENT_GAIN 0x04
+#define CAL_SET_CURRENT_OFFSET 0x08
+#define CAL_SET_ALL 0x0F
+
+// Coefficients to merge into the port's calibration (flagged fields), or
+// a reference step to start
+struct CalibrationCommand {
+    uint8_t port;
+    uint8_t fields;
+    PortCalibration values;
+    CalibrationStep step;
+    float reference;
+    bool referenceIsLoad;
+};
+
+struct CaptureCommand {
+    uint8_t port;
+    CaptureTrigger trigger;
+    uint32_t preMs;
+    uint32_t postMs;
+    uint32_t dipMv;
+};
+
+struct LabelCommand {
+    uint8_t port;
+    char label[sizeof(PortData::cellLabel)];
+};
+
+// Log history tolerances; bit s of fields flags tolerance[s]
+struct CompressionCommand {
+    uint8_t fields;
+    float tolerance[SIGNAL_COUNT];
+};
+
+enum PortCommandType {
+    CMD_PORT_SETTINGS = 0,
+    CMD_RESUME,             // Restore the checkpointed runs
+    CMD_DISCARD_RESUME,
+    CMD_CALIBRATE_SET,      // Writes the INA226 correction factor
+    CMD_CALIBRATE_START,
+    CMD_CAPTURE_ARM,
+    CMD_CELL_LABEL,
+    CMD_COMPRESSION         // Unit-wide, not a port
+};
+
+struct PortCommand {
+    PortCommandType type;
+    uint8_t groupSize;      // Set by push(): first slot of a group only
+    union {
+        PortSettings settings;
+        CalibrationCommand calibration;
+        CaptureCommand capture;
+        LabelCommand label;
+        CompressionCommand compression;
+    };
+};
+
+// ============================================
+// COMMAND QUEUE CLASS
+// ============================================
+
+// Every change to a port's mode, type, cutoff, run state, calibration,
+// cell label or capture, and to the log compression tolerances, goes
+// through here, so the I2C bus, PortData and the compressor are only
+// ever written from loop(). Producers (web handlers on the AsyncTCP
+// task, the encoder menu) never block: push() reserves slots with one
+// compare-and-swap and fails when the queue is full. loop() drains the queue at one point, before the
+// MOSFETs are updated. A group pushed together is applied in a single
+// drain, or waits whole for the next one.
+class CommandQueue {
+private:
+    struct Slot {
+        std::atomic<uint32_t> sequence;     // == position + 1 when readable
+        PortCommand command;
+    };
+    
+    PortData* portData;
+    CheckpointStore* checkpoint;
+    BatteryLogger* logger;
+    WaveformCapture* capture;
+    TelemetryCompressor* compressor;
+    
+    Slot slots[COMMAND_QUEUE_SIZE];
+    std::atomic<uint32_t> head;             // Next position to reserve (producers)
+    uint32_t tail;                          // Next position to apply (loop only)
+    
+    // Counters for /api/perf
+    std::atomic<uint32_t> pushed;
+    std::atomic<uint32_t> rejected;
+    uint32_t applied;
+    uint32_t maxDepth;
+    
+    void apply(const PortCommand& command);
+    void applySettings(const PortSettings& settings);
+    void applyCalibration(const PortCommand& command);
+    
+public:
+    CommandQueue(PortData* data);
+    
+    void setCheckpointStore(CheckpointStore* store) { checkpoint = store; }
+    void setLogger(BatteryLogger* l) { logger = l; }
+    void setCapture(WaveformCapture* wc) { capture = wc; }
+    void setCompressor(TelemetryCompressor* c) { compressor = c; }
+    
+    // Any task; false (nothing queued) when there is no room for all of them
+    bool push(const PortCommand* commands, int count);
+    bool push(const PortCommand& command) { return push(&command, 1); }
+    bool pushSettings(const PortSettings& settings);
+    
+    // loop() only
+    void drain();
+    
+    void addStatsJSON(JsonObject out);
+};
+
+#endif // COMMAND_QUEUE_H
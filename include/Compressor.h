@@ -0,0 +1,106 @@
+#ifndef COMPRESSOR_H
+#define COMPRESSOR_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "Config.h"
+#include "BatteryTypes.h"
+#include "Logger.h"
+
+// ============================================
+// ENUMERATIONS
+// ============================================
+
+enum CompressSignal {
+    SIGNAL_VOLTAGE = 0,
+    SIGNAL_CURRENT,
+    SIGNAL_POWER,
+    SIGNAL_COUNT
+};
+
+// ============================================
+// PER-PORT COMPRESSION STATE
+// ============================================
+
+// Narrowest slopes (per ms) from the anchor that keep every sample since
+// within +-tolerance of one straight line. The door closes once they cross.
+struct SwingingDoor {
+    float anchor;
+    float upper;
+    float lower;
+};
+
+struct PortCompression {
+    bool open;                      // Anchor kept, doors running
+    bool pendingValid;              // Latest sample, not yet kept
+    unsigned long anchorMs;
+    unsigned long pendingMs;
+    SwingingDoor doors[SIGNAL_COUNT];
+    LogRecord pending;
+    
+    // Last seen settings; a change ends the segment
+    OperationMode mode;
+    BatteryType batteryType;
+    PortStatus status;
+    bool active;
+    float cutoff;
+    float dcir;
+};
+
+// ============================================
+// TELEMETRY COMPRESSOR CLASS
+// ============================================
+
+// Swinging-door compression of the log history. The logger feeds every
+// filtered sample; kept points go to a ring that GET /api/logs?format=bin
+// streams. Live pushes do not use it (see the SSE deadbands in WebUI): a
+// steady slope keeps one point per COMPRESS_MAX_GAP_MS. Each segment is
+// anchored on a raw sample rather than on the best-fit line, so linear
+// interpolation between kept points is within about 2x the tolerance of
+// every sample, not 1x. Everything except the history download runs in
+// loop().
+class TelemetryCompressor {
+private:
+    PortData* portData;
+    PortCompression ports[NUM_PORTS];
+    float tolerance[SIGNAL_COUNT];
+    
+    // Kept-point history, allocated once at boot; read from the web task
+    LogRecord* history;
+    uint32_t capacity;
+    bool inPsram;
+    volatile uint32_t written;      // Total records ever kept
+    portMUX_TYPE lock;
+    
+    // Counters for /api/perf
+    uint32_t samplesIn;
+    uint32_t pointsKept;
+    
+    void openDoors(PortCompression& c, unsigned long timeMs, const LogRecord& record);
+    bool narrowDoors(PortCompression& c, unsigned long timeMs, const LogRecord& record);
+    void keep(int port, const LogRecord& record);
+    void flush(int port);
+    
+public:
+    TelemetryCompressor(PortData* data);
+    
+    bool begin();
+    
+    // Logger: after each filtered sample of an active port
+    void addSample(int port, const LogRecord& record);
+    
+    // loop(): ends segments on mode/status/setting changes and on stop
+    void update();
+    
+    float getTolerance(CompressSignal s) const { return tolerance[s]; }
+    void setTolerance(CompressSignal s, float value) { tolerance[s] = value; }
+    
+    // History download: header then records oldest first. first/count are
+    // taken once per download; reads stop if the ring overtakes them.
+    void getHistoryRange(uint32_t& first, uint32_t& count);
+    size_t readHistory(uint8_t* out, size_t maxLen, size_t index, uint32_t first, uint32_t count);
+    
+    void addStatsJSON(JsonObject out);
+};
+
+#endif // COMPRESSOR_H
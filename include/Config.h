@@ -5,14 +5,43 @@
 // HARDWARE CONFIGURATION - LOCKED GPIO MAPPING
 // ============================================
 
-// Number of battery ports
+// Number of battery ports (override with -D NUM_PORTS=8 in build_flags)
+#ifndef NUM_PORTS
 #define NUM_PORTS 4
+#endif
+static_assert(NUM_PORTS >= 1 && NUM_PORTS <= 16, "NUM_PORTS must be 1..16");
 
 // MOSFET Control Pins (for discharge) - LOCKED
-const int MOSFET_PINS[NUM_PORTS] = {26, 14, 12, 13};
+// Up to 4 ports each gate has its own pin. Above that the same pins drive
+// a chain of 74HC595s (bit n = port n, gate pull-downs hold loads off
+// while OE is high during boot).
+const int MOSFET_PINS[4] = {26, 14, 12, 13};
+#define MOSFET_SHIFT_REGISTER (NUM_PORTS > 4)
+#define SR_DATA_PIN 26
+#define SR_CLOCK_PIN 14
+#define SR_LATCH_PIN 12
+#define SR_OE_PIN 13                 // Active low
+#define SR_BYTES ((NUM_PORTS + 7) / 8)
+
+// INA226 addressing: 0x40 + n via the A0/A1 straps. With the mux, a
+// TCA9548A carries INA226_PER_CHANNEL sensors per channel (same straps on
+// every channel). Ports are read in batches of INA226_PER_CHANNEL, one
+// batch (= one mux channel) per loop pass.
+#ifndef I2C_MUX_ENABLED
+#define I2C_MUX_ENABLED (NUM_PORTS > 4)
+#endif
+#define I2C_MUX_ADDR 0x70
+#define INA226_BASE_ADDR 0x40
+#define INA226_PER_CHANNEL 4
+#define INA226_BATCHES ((NUM_PORTS + INA226_PER_CHANNEL - 1) / INA226_PER_CHANNEL)
 
-// INA226 I2C Addresses (0x40, 0x41, 0x42, 0x43)
-const uint8_t INA226_ADDR[NUM_PORTS] = {0x40, 0x41, 0x42, 0x43};
+inline uint8_t ina226Address(int port) {
+    return INA226_BASE_ADDR + (I2C_MUX_ENABLED ? port % INA226_PER_CHANNEL : port);
+}
+
+inline int ina226Channel(int port) {
+    return I2C_MUX_ENABLED ? port / INA226_PER_CHANNEL : -1;
+}
 
 // I2C Configuration (shared by INA226 and OLED) - LOCKED
 #define I2C_SDA 21
@@ -43,10 +72,49 @@ const uint8_t INA226_ADDR[NUM_PORTS] = {0x40, 0x41, 0x42, 0x43};
 // Median filter samples
 #define FILTER_SAMPLES 5
 
+// Consecutive failed (I2C) or invalid readings before a running port goes to ERROR
+#define SENSOR_ERROR_LIMIT 10
+
+// A started port with no reading by then goes to ERROR ("No reading")
+#define FIRST_SAMPLE_TIMEOUT_MS (INA226_WAKE_SETTLE_MS + 4 * SAMPLE_INTERVAL_MS)
+
 // INA226 Calibration
 #define SHUNT_RESISTOR 0.1  // 100mOhm
 #define MAX_CURRENT 3.2     // 3.2A max
 
+// Per-port reference calibration
+#define CALIBRATION_SAMPLES 16            // Readings averaged per step (8s at 2Hz)
+#define CALIBRATION_MAX_GAIN_ERROR 0.15   // Reject gains outside 1 +/- 15%
+#define CALIBRATION_MAX_OFFSET_A 0.05     // Reject zero offsets above 50mA
+
+// DCIR load step at discharge start (>= 2 INA226 conversions each)
+#define DCIR_REST_MS 5000         // Load held off to read open-circuit voltage
+#define DCIR_SETTLE_MS 5000       // Load on before reading loaded voltage
+#define DCIR_MIN_CURRENT 0.1      // A, below this the result is meaningless
+
+// Waveform capture: one port at the fastest INA226 setting (140us, no
+// averaging) into a sample ring allocated at boot (PSRAM when fitted)
+#define CAPTURE_SAMPLE_US 300             // One 140us shunt + 140us bus conversion pair
+#define CAPTURE_DRAM_SAMPLES 4096         // 32 KB internal RAM, ~1.2s at full rate
+#define CAPTURE_PSRAM_SAMPLES 65536       // 512 KB on PSRAM boards
+#define CAPTURE_MAX_WINDOW_MS 5000        // Pre + post trigger, sampled in slices
+#define CAPTURE_DEFAULT_PRE_MS 100
+#define CAPTURE_DEFAULT_POST_MS 400
+#define CAPTURE_DIP_MV 50                 // Default dip below the running baseline
+#define CAPTURE_BASELINE_SAMPLES 1024     // Dip baseline moving average (samples)
+#define CAPTURE_SLICE_MS 20               // Capture sampling per loop pass (two when a dip fires)
+#define CAPTURE_ARM_TIMEOUT_MS 60000      // Give up waiting for a dip
+
+// Telemetry compression: a swinging door per signal after every sample. A
+// sample is kept (logged) only when a straight line from the last kept one
+// would miss V, I or P by more than its tolerance; 0 keeps all
+#define COMPRESS_TOL_V 0.005              // V
+#define COMPRESS_TOL_A 0.005              // A
+#define COMPRESS_TOL_W 0.02               // W
+#define COMPRESS_MAX_GAP_MS 30000         // Keep a point at least this often
+#define COMPRESS_DRAM_RECORDS 512         // Kept-point history, 12 KB internal RAM
+#define COMPRESS_PSRAM_RECORDS 32768      // 768 KB on PSRAM boards
+
 // ============================================
 // BATTERY CONFIGURATION
 // ============================================
@@ -71,12 +139,85 @@ const uint8_t INA226_ADDR[NUM_PORTS] = {0x40, 0x41, 0x42, 0x43};
 #define AP_CHANNEL 6
 #define AP_MAX_CLIENTS 4
 
+// Network mode (override with -D NET_MODE=2 and the STA_* credentials)
+#define NET_MODE_AP 0                     // Own AP only, 192.168.4.1
+#define NET_MODE_STA 1                    // Join STA_SSID; AP comes up if that fails
+#define NET_MODE_AP_STA 2                 // Both
+#ifndef NET_MODE
+#define NET_MODE NET_MODE_AP
+#endif
+#ifndef STA_SSID
+#define STA_SSID ""
+#endif
+#ifndef STA_PASSWORD
+#define STA_PASSWORD ""
+#endif
+#define STA_CONNECT_TIMEOUT_MS 20000      // STA mode: fall back to AP+STA after this
+
+// mDNS name: charger-<UNIT_ID>.local (0 = last MAC bytes, e.g. charger-3f2a)
+#ifndef UNIT_ID
+#define UNIT_ID 0
+#endif
+#define MDNS_PREFIX "charger"
+
 // Web server port
 #define WEB_PORT 80
 
+// Concurrent WebSocket dashboards (oldest dropped beyond this). Set with
+// -D DEFAULT_MAX_WS_CLIENTS in platformio.ini, which AsyncWebSocket is
+// built with as well; the subscriber table follows it.
+#ifndef DEFAULT_MAX_WS_CLIENTS
+#define DEFAULT_MAX_WS_CLIENTS 8            // AsyncWebSocket's own default
+#endif
+#define WS_MAX_CLIENTS DEFAULT_MAX_WS_CLIENTS
+
+// Per-client subscriptions: {"ports":[0,2],"interval":5000}
+#define WS_ALL_PORTS ((1UL << NUM_PORTS) - 1)
+#define WS_MAX_INTERVAL_MS 60000          // Slowest rate a client can ask for
+#define WS_STALL_CLOSE_MS 30000           // Close a client whose queue stays full this long
+#define JSON_WS_COMMAND_SIZE 512
+
 // WebSocket update interval (ms)
 #define WS_UPDATE_INTERVAL 1000
 
+// Server-Sent Events (/api/stream): a port is sent again once a value moves
+// past its deadband or its state changes (adjustable with POST /api/stream)
+#define SSE_DEADBAND_V 0.005              // V
+#define SSE_DEADBAND_A 0.005              // A
+#define SSE_DEADBAND_MAH 1.0              // mAh
+
+// JSON document capacity (grows with the port count)
+#define JSON_STATUS_SIZE (1024 + NUM_PORTS * 256)
+#define JSON_RESUME_SIZE (256 + NUM_PORTS * 192)
+#define JSON_CALIBRATION_SIZE (256 + NUM_PORTS * 320)
+#define JSON_PERF_SIZE (4096 + WS_MAX_CLIENTS * 256)
+#define JSON_CAPTURE_SIZE 512
+#define JSON_OTA_SIZE 512
+#define JSON_CONFIG_SIZE (256 + NUM_PORTS * 192)   // POST /api/config body, and its result
+#define CONFIG_BODY_MAX 2048              // Larger /api/config bodies are refused (413)
+
+// Port commands from the web task and encoder, applied by loop() (power of two)
+#define COMMAND_QUEUE_SIZE 32
+#define JSON_REMOTE_UNIT_SIZE 256         // Gateway: per remote unit, plus...
+#define JSON_REMOTE_PORT_SIZE 192         // ...per remote port
+
+// ============================================
+// GATEWAY CONFIGURATION
+// ============================================
+
+// Multi-unit aggregation over ESP-NOW (override with -D GATEWAY_ROLE=2).
+// Units talk on their WiFi channel: AP_CHANNEL, or the router's in STA mode.
+#define GATEWAY_ROLE_STANDALONE 0         // No ESP-NOW
+#define GATEWAY_ROLE_NODE 1               // Reports its ports to the gateway
+#define GATEWAY_ROLE_GATEWAY 2            // Serves every unit's ports
+#ifndef GATEWAY_ROLE
+#define GATEWAY_ROLE GATEWAY_ROLE_STANDALONE
+#endif
+#define GATEWAY_REPORT_INTERVAL_MS 2000   // Node: one frame with all ports
+#define GATEWAY_MIN_GAP_MS 500            // Node: status-change frames no closer than this
+#define GATEWAY_MAX_UNITS 8               // Gateway: remote units tracked
+#define GATEWAY_STALE_MS 10000            // Gateway: unit reported offline after this
+
 // ============================================
 // UI CONFIGURATION
 // ============================================
@@ -84,12 +225,36 @@ const uint8_t INA226_ADDR[NUM_PORTS] = {0x40, 0x41, 0x42, 0x43};
 // OLED refresh rate (ms)
 #define UI_REFRESH_INTERVAL 200
 
+// Web/OLED status consistency check (ms)
+#define UI_SYNC_INTERVAL_MS 1000
+
 // Encoder debounce (ms)
 #define ENCODER_DEBOUNCE 50
 
+// Encoder quadrature decoding (PCNT hardware counter)
+#define ENCODER_PCNT_UNIT PCNT_UNIT_0
+#define ENCODER_PCNT_LIMIT 30000      // Counter wraps at +/- this value
+#define ENCODER_GLITCH_FILTER 1023    // APB cycles (~12.8us), max 1023
+#define ENCODER_COUNTS_PER_DETENT 4   // KY-040: one full quadrature cycle per click
+
+// Encoder acceleration (ms between detents -> step multiplier)
+#define ENCODER_ACCEL_FAST_MS 30
+#define ENCODER_ACCEL_FAST_STEP 10
+#define ENCODER_ACCEL_MEDIUM_MS 80
+#define ENCODER_ACCEL_MEDIUM_STEP 3
+
 // Menu timeout (ms) - return to main screen
 #define MENU_TIMEOUT 30000
 
+// Main screen: 2 x 3 port grid per page; rotate to page, or it cycles itself
+#define MAIN_PORTS_PER_PAGE 6
+#define MAIN_PAGES ((NUM_PORTS + MAIN_PORTS_PER_PAGE - 1) / MAIN_PORTS_PER_PAGE)
+#define MAIN_PAGE_CYCLE_MS 5000
+#define MENU_VISIBLE_ROWS 5             // List screens scroll beyond this
+
+// Hold button this long on main screen to open hidden perf page (ms)
+#define PERF_PAGE_HOLD_MS 2000
+
 // Buzzer tones (Hz) and durations (ms)
 #define BUZZER_FREQ_MENU 2000
 #define BUZZER_FREQ_SELECT 2500
@@ -98,15 +263,80 @@ const uint8_t INA226_ADDR[NUM_PORTS] = {0x40, 0x41, 0x42, 0x43};
 #define BUZZER_DURATION_SHORT 50
 #define BUZZER_DURATION_LONG 200
 #define BUZZER_DURATION_COMPLETE 500
+#define BUZZER_DURATION_PIP 80       // Port-number pip
+#define BUZZER_DURATION_GAP 100      // Silence between pips
+
+// Buzzer sequencer
+#define BUZZER_LEDC_CHANNEL 0
+#define BUZZER_MAX_NOTES (NUM_PORTS * 2 + 32)   // Enough for pips on every port + body
+
+// ============================================
+// POWER CONFIGURATION
+// ============================================
+
+// Idle mode once every port is in SAFETY (no test, no calibration)
+#define IDLE_DIM_MS 30000                 // No input for this long: OLED dimmed
+#define IDLE_SLEEP_MS 120000              // ...and this long: OLED off, sensors down
+#define IDLE_OLED_REFRESH_MS 1000         // Dimmed screen refresh period
+#define IDLE_LOOP_WAIT_MS 100             // Loop wait while asleep (encoder ISR cuts it short)
+#define IDLE_CPU_MHZ 80                   // Lowest clock that keeps WiFi running
+#define ACTIVE_CPU_MHZ 240
+#define IDLE_WIFI_TX_POWER WIFI_POWER_2dBm   // AP cannot modem-sleep; lower TX instead
+#define ACTIVE_WIFI_TX_POWER WIFI_POWER_19_5dBm
+#define INA226_WAKE_SETTLE_MS 2300        // One full 1024 x 2 x 1.1ms conversion after power-up
 
 // ============================================
 // STORAGE CONFIGURATION
 // ============================================
 
+// Persistent per-port configuration (NVS, versioned blob)
+#define CONFIG_NAMESPACE "config"
+#define CONFIG_SAVE_DEBOUNCE_MS 2000      // Write once settings stop changing
+#define CONFIG_MAX_PORT_SIZE 64           // Upper bound for PortConfig across schema versions
+#define CONFIG_TASK_PRIORITY 1            // NVS writer, below loop() and AsyncTCP
+#define CONFIG_TASK_CORE 0
+
+// Crash-safe test checkpoint (NVS, double-buffered)
+#define CHECKPOINT_NAMESPACE "ckpt"
+#define CHECKPOINT_INTERVAL_MS 60000      // Periodic write while a port is active
+#define RESUME_OFFER_TIMEOUT_MS 300000    // Drop unanswered resume offer after 5 min
+#define CHECKPOINT_TASK_PRIORITY 1        // Below loop() and AsyncTCP
+#define CHECKPOINT_TASK_CORE 0
+
+// Cell result database (LittleFS)
+#define RESULT_FILE "/results.bin"
+#define RESULT_TMP_FILE "/results.tmp"     // Rewrite target when a torn record is dropped
+#define RESULT_MAX_RECORDS 2048           // 32B each on flash, 4B each index in RAM
+#define RESULT_BIN_WIDTH_MAH 100          // OLED bins screen / grouping width
+#define RESULT_QUERY_LIMIT 500            // Max records per /api/results response
+
 // CSV log file path
 #define LOG_PATH "/logs"
 #define MAX_LOG_SIZE 1048576  // 1MB per file
 
+// ============================================
+// FIRMWARE UPDATE (OTA)
+// ============================================
+
+// HTTP download into the inactive app partition (POST /api/ota)
+// Shared key for POST /api/ota and /api/ota/cancel; empty disables both.
+// The SHA-256 only checks the image against the hash in the request; the
+// key is what stops anyone on the network from flashing their own.
+#ifndef OTA_KEY
+#define OTA_KEY ""
+#endif
+#define OTA_URL_MAX 160
+#define OTA_CHUNK_SIZE 4096               // Largest read per write (one flash sector)
+#define OTA_CHUNK_PAUSE_MS 5              // Yield between writes so loop() keeps its slot
+#define OTA_HTTP_TIMEOUT_MS 10000         // Connect / no-data timeout
+#define OTA_TASK_STACK 8192
+#define OTA_TASK_PRIORITY 1               // Below loop() and AsyncTCP
+#define OTA_TASK_CORE 0
+#define OTA_REBOOT_DELAY_MS 2000          // Lets the dashboard see "ready" before the reset
+#define OTA_CONFIRM_MS 60000              // Uptime (sensors and web up) before a new image is marked valid
+#define OTA_TRIAL_BOOTS 3                 // Boots of an unconfirmed image before reverting (no bootloader rollback)
+#define OTA_NAMESPACE "ota"               // NVS: image on trial and its boot count
+
 // ============================================
 // DEBUG CONFIGURATION
 // ============================================
@@ -115,6 +345,18 @@ const uint8_t INA226_ADDR[NUM_PORTS] = {0x40, 0x41, 0x42, 0x43};
 #define DEBUG_LOGGER 1
 #define DEBUG_WEBUI 1
 #define DEBUG_UI 1
+#define STATUS_PRINT_INTERVAL_MS 10000    // Serial status dump
+
+// Heap telemetry
+#ifndef HEAP_TRACKING
+#define HEAP_TRACKING 0               // 1 = count allocs per subsystem (needs --wrap link flags)
+#endif
+#define HEAP_TAG_SLOTS 4              // Tasks that can hold a heap tag at the same time
+#define HEAP_SAMPLE_INTERVAL_MS 10000 // Largest-free-block watermark sampling
+#define HEAP_LOW_BLOCK_WARN 16384     // Warn when largest free block drops below this
+
+// Runtime profiler histogram size (log-linear buckets, covers up to ~2s)
+#define PROFILE_BUCKETS 80
 
 #if DEBUG_SERIAL
   #define DEBUG_PRINT(x) Serial.print(x)
@@ -0,0 +1,82 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "Config.h"
+#include "BatteryTypes.h"
+
+// ============================================
+// CONFIG SCHEMA
+// ============================================
+
+// Bump CONFIG_SCHEMA_VERSION when PortConfig changes. Fields may only be
+// appended - older blobs are loaded over defaults using their stored size.
+#define CONFIG_SCHEMA_VERSION 1
+
+struct PortCalibration {
+    float voltageGain;          // Applied as: V = raw * gain + offset
+    float voltageOffset;
+    float currentGain;          // Applied as: I = raw * gain + offset
+    float currentOffset;
+};
+
+struct PortConfig {
+    uint8_t batteryType;
+    uint8_t mode;               // Restored with active = false (never auto-starts)
+    uint8_t useCustomCutoff;
+    uint8_t reserved;
+    float customCutoff;
+    PortCalibration calibration;
+};
+
+struct ConfigHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t portSize;          // sizeof(PortConfig) when written
+    uint16_t portCount;
+    uint16_t reserved;
+    uint32_t crc;               // CRC32 of the port array
+};
+
+// ============================================
+// CONFIG STORE CLASS
+// ============================================
+
+// Per-port settings persisted as one versioned NVS blob. Loaded once at
+// boot; changes to PortData are detected in update() and written after
+// CONFIG_SAVE_DEBOUNCE_MS without further changes. The flash write runs
+// on a writer task, like the checkpoint's, so loop() never waits on it.
+class ConfigStore {
+private:
+    PortData* portData;
+    Preferences prefs;
+    
+    PortConfig config[NUM_PORTS];
+    bool dirty;
+    unsigned long lastChange;
+    
+    // Snapshot handed to the writer task
+    TaskHandle_t writerTask;
+    portMUX_TYPE lock;
+    PortConfig outgoing[NUM_PORTS];
+    volatile bool saveFailed;       // Writer -> loop: mark dirty again
+    
+    void setDefaults(int port);
+    bool captureChanges();
+    void requestSave();
+    bool save(const PortConfig* ports);
+    static void writerLoop(void* arg);
+
+public:
+    ConfigStore(PortData* data);
+    
+    bool begin();
+    void apply();
+    void update();
+    
+    const PortCalibration& getCalibration(int port) const { return config[port].calibration; }
+    void setCalibration(int port, const PortCalibration& cal);
+};
+
+#endif // CONFIG_STORE_H
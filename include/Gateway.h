@@ -0,0 +1,101 @@
+#ifndef GATEWAY_H
+#define GATEWAY_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_now.h>
+#include <ArduinoJson.h>
+#include "Config.h"
+#include "BatteryTypes.h"
+
+// ============================================
+// TELEMETRY FRAME (ESP-NOW payload)
+// ============================================
+
+#define GATEWAY_MAX_REMOTE_PORTS 16     // Largest NUM_PORTS any unit can be built with
+
+struct __attribute__((packed)) TelemetryPort {
+    uint16_t millivolts;
+    int16_t milliamps;
+    uint16_t mAh;
+    uint16_t energy10mWh;       // Wh x 100
+    uint16_t dcirTenthMilliOhm; // 0 = not measured
+    uint8_t state;              // status | mode << 2 | batteryType << 4
+    uint8_t flags;              // bit0 = active
+};
+
+struct __attribute__((packed)) TelemetryFrame {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t portCount;
+    uint16_t sequence;
+    uint32_t uptimeSec;
+    TelemetryPort ports[GATEWAY_MAX_REMOTE_PORTS];  // Only portCount entries are sent
+};
+
+static_assert(sizeof(TelemetryFrame) <= ESP_NOW_MAX_DATA_LEN, "Telemetry frame exceeds ESP-NOW payload");
+
+// ============================================
+// REMOTE UNIT (gateway side)
+// ============================================
+
+struct RemoteUnit {
+    uint8_t mac[ESP_NOW_ETH_ALEN];
+    unsigned long lastSeen;     // millis() of the last accepted frame
+    uint32_t frames;
+    uint32_t lost;              // Sequence gaps
+    TelemetryFrame frame;
+};
+
+// ============================================
+// GATEWAY LINK CLASS
+// ============================================
+
+// Multi-unit aggregation over ESP-NOW on the WiFi channel. Nodes broadcast
+// one frame with every port per GATEWAY_REPORT_INTERVAL_MS (sooner on a
+// status change, never closer than GATEWAY_MIN_GAP_MS). The gateway keeps
+// the latest frame per unit; the receive callback only copies it under a
+// spinlock, all JSON work happens on request in the web handlers.
+class GatewayLink {
+private:
+    PortData* portData;
+    bool ready;
+    
+    // Node
+    uint16_t sequence;
+    unsigned long lastSend;
+    bool changePending;
+    PortStatus lastStatus[NUM_PORTS];
+    static volatile uint32_t sendOk;
+    static volatile uint32_t sendFailed;
+    
+    // Gateway
+    static portMUX_TYPE lock;
+    static RemoteUnit units[GATEWAY_MAX_UNITS];
+    static int unitCount;
+    static volatile uint32_t rejected;
+    
+    bool statusChanged();
+    void sendFrame(unsigned long now);
+    static void onSent(const uint8_t* mac, esp_now_send_status_t status);
+    static void onReceive(const uint8_t* mac, const uint8_t* data, int len);
+    
+public:
+    GatewayLink(PortData* data);
+    
+    bool begin();
+    void update();
+    
+    bool isGateway() const { return GATEWAY_ROLE == GATEWAY_ROLE_GATEWAY; }
+    int getUnitCount();
+    
+    // Gateway: remote units for /api/status ("units" array). Pass both the
+    // same getUnitCount() snapshot: a unit joining in between would not fit.
+    size_t getJsonCapacity(int count);
+    void addUnitsJSON(JsonArray units, int count);
+    
+    // Link counters for /api/perf
+    void addStatsJSON(JsonObject out);
+};
+
+#endif // GATEWAY_H
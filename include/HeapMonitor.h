@@ -0,0 +1,88 @@
+#ifndef HEAP_MONITOR_H
+#define HEAP_MONITOR_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// ============================================
+// ENUMERATIONS
+// ============================================
+
+enum HeapSubsystem {
+    HEAP_WEB_ROOT = 0,  // handleRoot (HTML page)
+    HEAP_WEB_STATUS,    // handleGetStatus / getStatusJSON from HTTP
+    HEAP_WEB_LOGS,      // handleGetLogs (CSV)
+    HEAP_WEB_API,       // Other HTTP API handlers
+    HEAP_WS_BROADCAST,  // WebSocket status push from loop()
+    HEAP_SUBSYSTEM_COUNT
+};
+
+// ============================================
+// STATISTICS STRUCTS
+// ============================================
+
+struct HeapSnapshot {
+    uint32_t freeHeap;          // Current free 8-bit heap
+    uint32_t largestBlock;      // Largest contiguous free block
+    uint32_t minFreeHeap;       // Lowest free heap since boot (IDF watermark)
+    uint32_t minLargestBlock;   // Lowest largest-block seen by update()
+    uint8_t fragmentation;      // 100 - largest/free, in percent
+    uint32_t failedAllocs;      // Allocations the heap could not satisfy
+};
+
+struct HeapSubsystemStats {
+    uint32_t calls;             // Scopes entered
+    uint32_t allocs;            // malloc/calloc/realloc inside scope
+    uint32_t allocBytes;        // Bytes requested inside scope
+};
+
+// ============================================
+// HEAP MONITOR CLASS
+// ============================================
+
+// Heap and fragmentation telemetry. Per-subsystem allocation counts need the
+// malloc wrappers enabled in platformio.ini (HEAP_TRACKING + --wrap flags).
+class HeapMonitor {
+private:
+    static HeapSubsystemStats subsystems[HEAP_SUBSYSTEM_COUNT];
+    static uint32_t minLargestBlock;
+    static volatile uint32_t failedAllocs;
+    static portMUX_TYPE lock;
+    
+    // One tag per task: allocations are counted against the calling
+    // task's own tag, so loop() and AsyncTCP scopes never mix
+    static volatile TaskHandle_t tagTasks[HEAP_TAG_SLOTS];
+    static int tagSubsystems[HEAP_TAG_SLOTS];
+    static volatile int activeTags;
+    
+    static void onAllocFailed(size_t size, uint32_t caps, const char* functionName);
+
+public:
+    static void begin();
+    static void update();
+    
+    static void getSnapshot(HeapSnapshot& out);
+    static void getSubsystemStats(HeapSubsystem subsystem, HeapSubsystemStats& out);
+    static const char* getName(HeapSubsystem subsystem);
+    
+    // Used by ScopedHeapTag and the malloc wrappers
+    static bool enter(HeapSubsystem subsystem);
+    static void leave();
+    static void noteAlloc(size_t size);
+};
+
+// ============================================
+// SCOPED TAG
+// ============================================
+
+// Attributes allocations made in the enclosing scope to a subsystem
+class ScopedHeapTag {
+private:
+    bool owner;
+
+public:
+    explicit ScopedHeapTag(HeapSubsystem s) : owner(HeapMonitor::enter(s)) {}
+    ~ScopedHeapTag() { if (owner) HeapMonitor::leave(); }
+};
+
+#endif // HEAP_MONITOR_H
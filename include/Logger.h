@@ -6,6 +6,71 @@
 #include <INA226_WE.h>
 #include "Config.h"
 #include "BatteryTypes.h"
+#include "Profiler.h"
+#include "Scheduler.h"
+#include "ConfigStore.h"
+
+class TelemetryCompressor;
+
+// ============================================
+// ENUMERATIONS
+// ============================================
+
+enum CalibrationStep {
+    CAL_NONE = 0,
+    CAL_ZERO,           // Current offset, load OFF (true current = 0)
+    CAL_CURRENT,        // Current gain, load ON at a known current
+    CAL_VOLTAGE         // Voltage gain at a known reference voltage
+};
+
+enum DcirPhase {
+    DCIR_IDLE = 0,
+    DCIR_REST,          // Load held off, waiting for open-circuit voltage
+    DCIR_LOADED,        // Load on, waiting for loaded voltage to settle
+    DCIR_DONE
+};
+
+// ============================================
+// CALIBRATION STATE
+// ============================================
+
+struct CalibrationState {
+    CalibrationStep step;
+    float reference;            // Amps or volts (CAL_CURRENT with load: ohms)
+    bool referenceIsLoad;       // CAL_CURRENT: reference is a load resistor
+    int samples;
+    double sumVoltage;
+    double sumCurrent;
+    char result[48];            // Last outcome, for the API
+};
+
+// ============================================
+// BINARY LOG FORMAT
+// ============================================
+
+// Fixed-size little-endian records, read by tools/parse_logs.py with a
+// numpy structured dtype (no text parsing). Power is V * I.
+#define LOG_BIN_MAGIC 0x4C474843    // "CHGL"
+#define LOG_BIN_VERSION 1
+
+struct __attribute__((packed)) LogFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t reserved[2];
+};
+
+struct __attribute__((packed)) LogRecord {
+    uint32_t timestamp;         // Seconds since test start
+    uint8_t port;
+    uint8_t mode;
+    uint8_t batteryType;
+    uint8_t status;
+    float voltage;
+    float current;
+    float mAh;
+    float Wh;
+};
 
 // ============================================
 // LOGGER CLASS
@@ -20,14 +85,60 @@ private:
     float voltageBuffer[NUM_PORTS][FILTER_SAMPLES];
     float currentBuffer[NUM_PORTS][FILTER_SAMPLES];
     int bufferIndex[NUM_PORTS];
+    bool filterPrimed[NUM_PORTS];   // Sampled since the port was started
+    
+    // esp_timer time of the last integrated reading (exact deltas)
+    int64_t lastSampleUs[NUM_PORTS];
+    
+    // Last corrected unfiltered reading (for load-step DCIR)
+    float lastRawVoltage[NUM_PORTS];
+    float lastRawCurrent[NUM_PORTS];
+    
+    // DCIR measurement at discharge start
+    DcirPhase dcirPhase[NUM_PORTS];
+    unsigned long dcirPhaseStart[NUM_PORTS];
+    float dcirOpenVoltage[NUM_PORTS];
+    
+    // Receives every filtered sample (decides what is logged)
+    TelemetryCompressor* compressor;
+    
+    // Calibration (coefficients persisted through ConfigStore)
+    ConfigStore* configStore;
+    PortCalibration calibration[NUM_PORTS];
+    CalibrationState calState[NUM_PORTS];
+    
+    // INA226 power-down while the board idles
+    bool sensorsAsleep;
+    unsigned long sensorWakeTime;
     
-    // Timing
-    unsigned long lastSampleTime;
+    // I2C mux channel last selected (-1 = none) and next batch to read.
+    // Wire and the cached channel belong to the task that ran begin()
+    // (loop); web handlers go through the CommandQueue instead, and
+    // selectPort() refuses any other caller.
+    int muxChannel;
+    TaskHandle_t busOwner;
+    int nextBatch;
+    
+    // Waveform capture port (-1 = none); skipped by the sweep until its
+    // averaged conversion is valid again after the burst
+    int burstPort;
+    bool burstActive;
+    unsigned long burstEndTime;
     
     // Helper functions
     float medianFilter(float* buffer, int size);
-    void updateAccumulators(int port, float voltage, float current, unsigned long deltaTime);
+    void updateAccumulators(int port, float voltage, float current, int64_t deltaUs);
     bool validateReading(int port, float voltage, float current);
+    void countSensorError(int port, const char* message);
+    void accumulateCalibration(int port, float voltage, float current);
+    void finishCalibration(int port);
+    void updateDcir(int port, unsigned long now);
+    bool selectPort(int port);
+    void applyConversion(int port, bool fast);
+    
+#ifdef HOST_BUILD
+    friend class BenchAccess;   // host benchmarks (bench/) call private hot paths
+#endif
 
 public:
     BatteryLogger(PortData* data);
@@ -38,9 +149,38 @@ public:
     bool isPortReady(int port);
     void calibratePort(int port);
     
+    // Load must stay off while DCIR open-circuit voltage is captured
+    bool isLoadHeld(int port) const { return dcirPhase[port] == DCIR_REST; }
+    
+    // False until the first reading after the port was started
+    bool hasSample(int port) const { return filterPrimed[port]; }
+    
+    // Power down idle INA226s; after power-up readings wait for a fresh conversion
+    void setSensorsAsleep(bool asleep);
+    
+    // Burst mode for waveform capture: one port at 140us / no averaging,
+    // read directly (corrected, unfiltered, not integrated)
+    bool setBurstMode(int port, bool on);
+    bool readBurst(int port, float& voltage, float& current);
+    
+    void setCompressor(TelemetryCompressor* c) { compressor = c; }
+    
+    // Per-port calibration against a reference (non-blocking, runs on sample path)
+    void setConfigStore(ConfigStore* store) { configStore = store; }
+    bool canCalibrate(int port, CalibrationStep step, float reference) const;
+    bool startCalibration(int port, CalibrationStep step, float reference, bool referenceIsLoad = false);
+    bool isCalibrating(int port) const { return calState[port].step != CAL_NONE; }
+    const char* getCalibrationResult(int port) const { return calState[port].result; }
+    const PortCalibration& getCalibration(int port) const { return calibration[port]; }
+    void setCalibration(int port, const PortCalibration& cal);
+    
     // CSV logging
     String getCSVHeader();
     String getCSVLine(int port);
+    
+    // Binary logging
+    void getLogHeader(LogFileHeader& header);
+    void getLogRecord(int port, LogRecord& record);
 };
 
 #endif // LOGGER_H
@@ -0,0 +1,95 @@
+#ifndef OTA_H
+#define OTA_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "Config.h"
+#include "BatteryTypes.h"
+#include <esp_ota_ops.h>
+
+// ============================================
+// ENUMERATIONS
+// ============================================
+
+enum OtaState {
+    OTA_IDLE = 0,
+    OTA_DOWNLOADING,        // Writing the inactive app partition
+    OTA_VERIFYING,          // Hash and image check before the switch
+    OTA_READY,              // Boot partition switched, reboot pending
+    OTA_FAILED
+};
+
+// ============================================
+// OTA UPDATER CLASS
+// ============================================
+
+// Firmware update from an HTTP URL into the inactive app partition. The
+// download runs on its own low-priority task, one flash sector per write
+// with a pause in between, so loop() keeps sampling. The boot partition
+// only switches once the SHA-256 of the received image matches. loop()
+// reboots when no port is ACTIVE (or at once if forced). The new image is
+// confirmed once setup() reports the sensors and web server up and it has
+// run for OTA_CONFIRM_MS; if they are not up by then it reverts at once.
+// A bootloader built with app rollback reverts an image that resets before
+// that. The stock one is not, so the boots of an image on trial are also
+// counted in NVS and begin() reverts after OTA_TRIAL_BOOTS of them.
+class OtaUpdater {
+private:
+    PortData* portData;
+    portMUX_TYPE lock;
+    
+    volatile OtaState state;
+    volatile bool cancelPending;
+    bool forced;
+    char url[OTA_URL_MAX];
+    uint8_t expectedHash[32];
+    volatile uint32_t received;
+    volatile uint32_t total;
+    char result[64];
+    unsigned long readySince;
+    
+    // Rollback: this boot runs a new image that is not yet confirmed
+    bool pendingVerify;
+    bool systemUp;
+    
+    static void downloadTask(void* param);
+    void download();
+    void finish(OtaState next, const char* message);
+    bool anyPortActive();
+    
+    // App-level trial record (NVS), used without bootloader rollback
+    bool recordTrial(const esp_partition_t* target);
+    void clearTrial();
+    void confirm();
+    void rollBack(const char* reason);
+    
+public:
+    OtaUpdater(PortData* data);
+    
+    // Reads the running image's state (pending verify after an update);
+    // early in setup() so a crash in later init still counts as a boot
+    void begin();
+    
+    // setup(): sensors answered and the web server started
+    void setSystemUp() { systemUp = true; }
+    
+    // loop(): confirms the running image, reboots into a ready one
+    void update();
+    
+    // Web task: url is http://..., sha256Hex 64 hex digits (checked by
+    // the caller). Returns why the update was refused, or nullptr.
+    const char* start(const char* imageUrl, const char* sha256Hex, bool force);
+    
+    // Stops a download, or points the bootloader back at this image.
+    // Returns why it cannot (mid-verify), or nullptr.
+    const char* cancel();
+    
+    // Download or reboot in progress (keeps the board out of idle sleep)
+    bool isBusy() const { return state == OTA_DOWNLOADING || state == OTA_VERIFYING || state == OTA_READY; }
+    OtaState getState() const { return state; }
+    const char* getResult() const { return result; }
+    
+    void addStatusJSON(JsonObject out);
+};
+
+#endif // OTA_H
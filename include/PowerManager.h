@@ -0,0 +1,76 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "Config.h"
+#include "BatteryTypes.h"
+
+class BatteryLogger;
+class PhysicalUI;
+class WebUI;
+class CheckpointStore;
+class OtaUpdater;
+
+// ============================================
+// POWER STATES
+// ============================================
+
+enum PowerState {
+    POWER_ACTIVE = 0,   // Test running or recent input - full speed
+    POWER_DIM,          // All ports idle, no input for IDLE_DIM_MS
+    POWER_SLEEP,        // ...and IDLE_SLEEP_MS with no WiFi station: OLED off, sensors down
+    POWER_STATE_COUNT
+};
+
+// ============================================
+// POWER MANAGER CLASS
+// ============================================
+
+// Steps the board down while every port is in SAFETY and nobody is using
+// it. Any encoder edge, button press, WiFi station or started port
+// returns to POWER_ACTIVE within one loop pass.
+class PowerManager {
+private:
+    PortData* portData;
+    BatteryLogger* logger;
+    PhysicalUI* ui;
+    WebUI* web;
+    CheckpointStore* checkpoint;
+    OtaUpdater* ota;
+    
+    PowerState state;
+    unsigned long stateSince;
+    unsigned long lastActivity;     // Input, running port or sleep-ISR edge
+    uint32_t timeInState[POWER_STATE_COUNT];   // ms, completed periods only
+    uint32_t wakeups;
+    
+    static TaskHandle_t loopTask;
+    static void IRAM_ATTR onInputEdge();
+    
+    bool isBusy();
+    void enterState(PowerState next, unsigned long now);
+    void applyCpuPolicy(bool idle);
+    
+public:
+    PowerManager(PortData* data);
+    
+    void setLogger(BatteryLogger* l) { logger = l; }
+    void setPhysicalUI(PhysicalUI* u) { ui = u; }
+    void setWebUI(WebUI* w) { web = w; }
+    void setCheckpointStore(CheckpointStore* store) { checkpoint = store; }
+    void setOta(OtaUpdater* updater) { ota = updater; }
+    
+    void begin();
+    void update();
+    
+    // End-of-loop wait: short delay when active, ISR-interruptible when asleep
+    void idleWait();
+    
+    PowerState getState() const { return state; }
+    static const char* getStateName(PowerState s);
+    uint32_t getTimeInState(PowerState s);
+    uint32_t getWakeups() const { return wakeups; }
+};
+
+#endif // POWER_MANAGER_H
@@ -0,0 +1,84 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// ============================================
+// ENUMERATIONS
+// ============================================
+
+enum ProfileSlot {
+    PROF_LOOP = 0,      // Whole loop() iteration (excluding delay)
+    PROF_LOGGER,        // logger->update()
+    PROF_MOSFET,        // updateMOSFETs()
+    PROF_PHYSICAL_UI,   // physicalUI->update()
+    PROF_WEB_UI,        // webUI->update()
+    PROF_I2C_INA226,    // INA226 bus/current read
+    PROF_I2C_OLED,      // SSD1306 framebuffer flush
+    PROF_JSON,          // Status JSON generation
+    PROF_COUNT
+};
+
+// ============================================
+// STATISTICS STRUCT
+// ============================================
+
+// Log-linear histogram: 4 sub-buckets per power of two (in microseconds),
+// which keeps percentile error below 25% with a fixed, small footprint.
+struct ProfileStats {
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+    uint32_t histogram[PROFILE_BUCKETS];
+};
+
+// ============================================
+// PROFILER CLASS
+// ============================================
+
+class Profiler {
+private:
+    static ProfileStats stats[PROF_COUNT];
+    static uint32_t cyclesPerUs;
+    static portMUX_TYPE lock;
+
+public:
+    static void begin();
+    static void record(ProfileSlot slot, uint32_t cycles);
+    static void reset();
+    static void setCpuFrequency(uint32_t mhz);  // After a clock change (idle DFS)
+    
+    // Consistent copy of one slot (safe to call from any task)
+    static void getSnapshot(ProfileSlot slot, ProfileStats& out);
+    
+    static const char* getName(ProfileSlot slot);
+    static const char* getShortName(ProfileSlot slot);   // <= 6 chars, for OLED
+    static uint32_t cyclesToUs(uint64_t cycles);
+    static double cyclesToSeconds(uint64_t cycles);
+    static uint32_t getAverageUs(const ProfileStats& s);
+    static uint32_t getPercentileUs(const ProfileStats& s, float percentile);
+    
+    // Histogram bucket helpers
+    static int bucketForUs(uint32_t us);
+    static uint32_t bucketUpperUs(int bucket);
+    static uint32_t countAtOrBelowUs(const ProfileStats& s, uint32_t us);
+};
+
+// ============================================
+// SCOPED TIMER
+// ============================================
+
+// Measures the enclosing scope with the CPU cycle counter
+class ScopedTimer {
+private:
+    ProfileSlot slot;
+    uint32_t start;
+
+public:
+    explicit ScopedTimer(ProfileSlot s) : slot(s), start(ESP.getCycleCount()) {}
+    ~ScopedTimer() { Profiler::record(slot, ESP.getCycleCount() - start); }
+};
+
+#endif // PROFILER_H
@@ -0,0 +1,75 @@
+#ifndef RESULT_STORE_H
+#define RESULT_STORE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <LittleFS.h>
+#include "Config.h"
+#include "BatteryTypes.h"
+
+// ============================================
+// RESULT RECORD (32 bytes, append-only file)
+// ============================================
+
+struct CellResult {
+    uint32_t id;                // Monotonic, assigned on append
+    char label[12];             // From PortData::cellLabel (may be empty)
+    float capacityMah;
+    float energyWh;
+    uint32_t durationSec;
+    uint16_t dcirTenthMilliOhm; // 0 = not measured
+    uint8_t batteryType;
+    uint8_t port;
+};
+
+// ============================================
+// CAPACITY INDEX ENTRY
+// ============================================
+
+struct CapacityIndexEntry {
+    uint16_t capacityMah;
+    uint16_t record;            // Position in the result file
+};
+
+// ============================================
+// RESULT STORE CLASS
+// ============================================
+
+// Finished discharge results in a flash file plus an in-RAM index sorted
+// by capacity, so range queries are two binary searches and N reads.
+class ResultStore {
+private:
+    PortData* portData;
+    bool ready;
+    SemaphoreHandle_t mutex;    // Loop appends while web handlers query
+    
+    CapacityIndexEntry* index;
+    uint16_t count;
+    uint32_t nextId;
+    
+    int lowerBound(uint16_t capacity) const;
+    void insertIndex(uint16_t capacity, uint16_t record);
+    void dropPartialRecord();
+
+public:
+    ResultStore(PortData* data);
+    
+    bool begin();
+    bool recordCompletion(int port);
+    bool readRecord(uint16_t record, CellResult& out);
+    bool clear();
+    
+    uint16_t getCount() const { return count; }
+    
+    // Capacity queries (inclusive range)
+    uint16_t countInRange(uint16_t minMah, uint16_t maxMah);
+    
+    // Calls visitor(record, ctx) for matches in ascending capacity
+    uint16_t query(uint16_t minMah, uint16_t maxMah, uint16_t limit,
+                   void (*visitor)(const CellResult&, void*), void* ctx);
+    
+    // Non-empty capacity bins (RESULT_BIN_WIDTH_MAH wide), skipping 'offset' bins
+    int getBins(int offset, uint16_t* binStart, uint16_t* binCount, int maxBins);
+};
+
+#endif // RESULT_STORE_H
@@ -0,0 +1,65 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "Config.h"
+
+// ============================================
+// ENUMERATIONS
+// ============================================
+
+enum ScheduleSlot {
+    SCHED_SAMPLE = 0,   // INA226 read + integration (logger->update)
+    SCHED_WS_PUSH,      // WebSocket status broadcast
+    SCHED_OLED,         // Periodic OLED refresh
+    SCHED_UI_SYNC,      // syncUIStates()
+    SCHED_HEAP,         // Largest-free-block watermark
+    SCHED_STATUS_PRINT, // Serial status dump
+    SCHED_GATEWAY,      // ESP-NOW telemetry frame (node role)
+    SCHED_COUNT
+};
+
+// ============================================
+// STATISTICS STRUCT
+// ============================================
+
+struct ScheduleStats {
+    uint32_t periodUs;
+    uint32_t runs;          // Deadlines served
+    uint32_t skipped;       // Whole periods missed (loop blocked too long)
+    uint32_t maxLateUs;     // Worst lateness of a served deadline
+};
+
+// ============================================
+// SCHEDULER CLASS
+// ============================================
+
+// Fixed-rate deadlines on the esp_timer microsecond clock. Each deadline
+// advances by whole periods from the previous deadline, never from "now",
+// so late polls don't accumulate drift: 2 Hz stays 2 Hz over hours.
+// Polled from loop() only (no locking).
+class Scheduler {
+private:
+    static int64_t deadlines[SCHED_COUNT];
+    static ScheduleStats stats[SCHED_COUNT];
+
+public:
+    static void begin();
+    
+    // Monotonic microseconds since boot (64-bit, never wraps)
+    static int64_t nowUs() { return esp_timer_get_time(); }
+    
+    // True once per period; consumes the deadline
+    static bool due(ScheduleSlot slot) { return due(slot, nowUs()); }
+    static bool due(ScheduleSlot slot, int64_t now);
+    
+    // New period takes effect from the next deadline
+    static void setPeriod(ScheduleSlot slot, uint32_t periodUs);
+    static int64_t getDeadline(ScheduleSlot slot) { return deadlines[slot]; }
+    
+    static void getStats(ScheduleSlot slot, ScheduleStats& out);
+    static const char* getName(ScheduleSlot slot);
+};
+
+#endif // SCHEDULER_H
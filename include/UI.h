@@ -5,8 +5,15 @@
 #include <Wire.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
+#include <driver/pcnt.h>
 #include "Config.h"
 #include "BatteryTypes.h"
+#include "Buzzer.h"
+#include "Profiler.h"
+#include "Scheduler.h"
+#include "Checkpoint.h"
+#include "ResultStore.h"
+#include "CommandQueue.h"
 
 // ============================================
 // ENUMERATIONS
@@ -18,15 +25,10 @@ enum MenuState {
     MENU_MODE_SELECT,   // Select mode for port
     MENU_BATTERY_SELECT,// Select battery type
     MENU_CUTOFF_ADJUST, // Adjust cutoff voltage
-    MENU_CONFIRM        // Confirm action
-};
-
-enum BuzzerPattern {
-    BEEP_NONE = 0,
-    BEEP_MENU,          // Short beep for menu navigation
-    BEEP_SELECT,        // Medium beep for selection
-    BEEP_COMPLETE,      // Long beep for task complete
-    BEEP_ERROR          // Error beep
+    MENU_CONFIRM,       // Confirm action
+    MENU_PERF,          // Hidden: loop/task timing (hold button on main)
+    MENU_RESUME,        // Resume tests interrupted by a reset
+    MENU_BINS           // Finished cells grouped by capacity
 };
 
 // ============================================
@@ -37,34 +39,44 @@ class PhysicalUI {
 private:
     Adafruit_SSD1306* display;
     PortData* portData;
+    CheckpointStore* checkpoint;
+    ResultStore* results;
+    CommandQueue* commands;
     
     // Menu state
     MenuState currentMenu;
     int selectedPort;
     int menuIndex;
+    int minMenuIndex;
     int maxMenuIndex;
     unsigned long lastMenuActivity;
+    unsigned long lastPageFlip;     // Main screen auto-paging (menuIndex = page)
+    PortSettings wizard;            // Port setup choices, queued together on START
     
-    // Encoder state
-    volatile int encoderPos;
+    // Encoder state (PCNT hardware counter, polled from update())
+    int encoderPos;
     int lastEncoderPos;
-    volatile bool buttonPressed;
-    unsigned long lastButtonPress;
+    int16_t lastPcntCount;
+    int encoderRemainder;
+    unsigned long lastDetentTime;
+    int encoderStepMultiplier;
+    
+    // Button state (polled with debounce)
+    bool buttonPressed;
+    bool buttonLongPressed;
+    bool buttonStableState;
+    bool buttonLastReading;
+    bool longPressFired;
+    unsigned long lastButtonChange;
+    unsigned long buttonDownTime;
     
     // Display state
-    unsigned long lastRefresh;
     bool displayNeedsUpdate;
+    bool displayOn;             // SSD1306 panel off while the board sleeps
+    bool displayDimmed;
     
-    // Buzzer state
-    BuzzerPattern currentBeep;
-    unsigned long beepStartTime;
-    bool beepActive;
-    
-    // Static callbacks for ISR
-    static PhysicalUI* instance;
-    static void IRAM_ATTR handleEncoderA();
-    static void IRAM_ATTR handleEncoderB();
-    static void IRAM_ATTR handleButton();
+    // Buzzer sequencer (timer driven, no polling needed)
+    Buzzer buzzer;
     
     // Drawing functions
     void drawMainScreen();
@@ -73,21 +85,34 @@ private:
     void drawBatterySelect();
     void drawCutoffAdjust();
     void drawConfirm();
+    void drawPerfPage();
+    void drawResume();
+    void drawBins();
     
     // Helper functions
     void drawHeader(const char* title);
-    void drawPortStatus(int port, int y);
+    void drawPortStatus(int port, int x, int y);
     void drawProgressBar(int x, int y, int width, int height, float percentage);
     void drawBattery(int x, int y, float voltage, float maxVoltage);
     
+    // Input handling
+    bool initEncoder();
+    int readEncoderDetents();
+    void updateAcceleration(int detents, unsigned long now);
+    void pollButton(unsigned long now);
+    
     // Menu navigation
     void handleEncoderChange();
     void handleButtonPress();
+    void handleLongPress();
     void returnToMain();
     
     // Buzzer control
-    void playBeep(BuzzerPattern pattern);
-    void updateBuzzer();
+    void playBeep(BuzzerPattern pattern, int port = -1);
+    
+#ifdef HOST_BUILD
+    friend class BenchAccess;   // host benchmarks (bench/) call private hot paths
+#endif
     
 public:
     PhysicalUI(PortData* data);
@@ -99,6 +124,14 @@ public:
     void notifyComplete(int port);
     void notifyError(int port);
     void forceRedraw();
+    void offerResume(CheckpointStore* store);
+    void setResultStore(ResultStore* store) { results = store; }
+    void setCommandQueue(CommandQueue* queue) { commands = queue; }
+    
+    // Idle power mode (PowerManager)
+    unsigned long getLastInputTime() const { return lastMenuActivity; }
+    void setDisplayOn(bool on);
+    void setDimmed(bool dim);
     
     // Encoder position access
     int getEncoderPosition() { return encoderPos; }
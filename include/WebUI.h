@@ -3,11 +3,56 @@
 
 #include <Arduino.h>
 #include <WiFi.h>
+#include <ESPmDNS.h>
 #include <ESPAsyncWebServer.h>
 #include <AsyncTCP.h>
 #include <ArduinoJson.h>
 #include "Config.h"
 #include "BatteryTypes.h"
+#include "Profiler.h"
+#include "HeapMonitor.h"
+#include "Scheduler.h"
+#include "Checkpoint.h"
+#include "Logger.h"
+#include "ResultStore.h"
+#include "PowerManager.h"
+#include "Gateway.h"
+#include "Capture.h"
+#include "Compressor.h"
+#include "CommandQueue.h"
+#include "Ota.h"
+
+// ============================================
+// WEBSOCKET SUBSCRIBER
+// ============================================
+
+struct WsSubscriber {
+    uint32_t id;                // Client id, 0 = free slot
+    uint32_t portMask;          // Bit n = port n in the pushed frame
+    uint32_t intervalMs;        // Push period (WS_UPDATE_INTERVAL..WS_MAX_INTERVAL_MS)
+    unsigned long lastSent;
+    unsigned long fullSince;    // Queue full since (valid while queueFull)
+    bool queueFull;
+    uint32_t sent;
+    uint32_t coalesced;         // Pushes skipped while the queue was full
+};
+
+// ============================================
+// SSE STREAM STATE
+// ============================================
+
+// Values a port was last streamed with; the deadbands are measured from here
+struct SsePortState {
+    float voltage;
+    float current;
+    float mAh;
+    float cutoff;
+    float dcir;
+    OperationMode mode;
+    BatteryType batteryType;
+    PortStatus status;
+    bool active;
+};
 
 // ============================================
 // WEB UI CLASS
@@ -17,9 +62,22 @@ class WebUI {
 private:
     AsyncWebServer* server;
     AsyncWebSocket* ws;
+    AsyncEventSource* events;
     PortData* portData;
+    CheckpointStore* checkpoint;
+    BatteryLogger* logger;
+    ResultStore* results;
+    PowerManager* power;
+    GatewayLink* gateway;
+    WaveformCapture* capture;
+    TelemetryCompressor* compressor;
+    OtaUpdater* ota;
     
-    unsigned long lastUpdate;
+    // Network (NET_MODE)
+    char hostname[32];
+    bool staConnected;
+    bool apFallback;
+    unsigned long staSince;         // Last time the station was connected (or boot)
     
     // Request handlers
     void handleRoot(AsyncWebServerRequest *request);
@@ -29,22 +87,90 @@ private:
     void handleSetCutoff(AsyncWebServerRequest *request);
     void handleReset(AsyncWebServerRequest *request);
     void handleGetLogs(AsyncWebServerRequest *request);
+    void handleGetPerf(AsyncWebServerRequest *request);
+    void handleResetPerf(AsyncWebServerRequest *request);
+    void handleMetrics(AsyncWebServerRequest *request);
+    void handleGetResume(AsyncWebServerRequest *request);
+    void handleResume(AsyncWebServerRequest *request);
+    void handleGetCalibration(AsyncWebServerRequest *request);
+    void handleCalibrate(AsyncWebServerRequest *request);
+    void handleGetCapture(AsyncWebServerRequest *request);
+    void handleArmCapture(AsyncWebServerRequest *request);
+    void handleCancelCapture(AsyncWebServerRequest *request);
+    void handleSetStream(AsyncWebServerRequest *request);
+    void handleSetCompression(AsyncWebServerRequest *request);
+    void handleConfigBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total);
+    void handleSetConfig(AsyncWebServerRequest *request);
+    void handleGetOta(AsyncWebServerRequest *request);
+    bool checkOtaKey(AsyncWebServerRequest *request);
+    void handleStartOta(AsyncWebServerRequest *request);
+    void handleCancelOta(AsyncWebServerRequest *request);
+    void handleGetResults(AsyncWebServerRequest *request);
+    void handleClearResults(AsyncWebServerRequest *request);
+    void handleSetCell(AsyncWebServerRequest *request);
     
     // WebSocket handlers
     void onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, 
                    AwsEventType type, void *arg, uint8_t *data, size_t len);
+    void handleWsMessage(AsyncWebSocketClient *client, const uint8_t *data, size_t len);
+    WsSubscriber* findSubscriber(uint32_t id);
+    
+    // Per-client push state, one slot per open socket. Connect, disconnect
+    // and subscribe write it on the AsyncTCP task, pushes on loop(): both
+    // hold subscriberLock, and only for plain copies (never around a send).
+    WsSubscriber subscribers[WS_MAX_CLIENTS];
+    portMUX_TYPE subscriberLock;
+    bool readSubscriber(int slot, WsSubscriber& out);
+    
+    // Port changes are queued for loop(), never written from the web task
+    CommandQueue* commands;
+    void queueSettings(AsyncWebServerRequest *request, const PortSettings& settings);
+    const char* parsePortSettings(JsonObjectConst entry, PortSettings& out);
+    
+    // SSE: one change set for all clients
+    SsePortState sseSent[NUM_PORTS];
+    float sseDeadbandV;
+    float sseDeadbandA;
+    float sseDeadbandMah;
+    uint32_t sseEventId;
+    uint32_t getStreamChanges();
+    
+    // Network helpers
+    void startAccessPoint();
+    void updateStation();
     
     // Helper functions
-    String getStatusJSON();
+    String getStatusJSON(uint32_t portMask = WS_ALL_PORTS);
     String getPortJSON(int port);
+    String getPerfJSON();
     void broadcastStatus();
     
+#ifdef HOST_BUILD
+    friend class BenchAccess;   // host benchmarks (bench/) call private hot paths
+#endif
+    
 public:
     WebUI(PortData* data);
     
     bool begin();
     void update();
     
+    void setCheckpointStore(CheckpointStore* store) { checkpoint = store; }
+    void setLogger(BatteryLogger* log) { logger = log; }
+    void setResultStore(ResultStore* store) { results = store; }
+    void setPowerManager(PowerManager* pm) { power = pm; }
+    void setGateway(GatewayLink* link) { gateway = link; }
+    void setCapture(WaveformCapture* wc) { capture = wc; }
+    void setCompressor(TelemetryCompressor* tc) { compressor = tc; }
+    void setCommandQueue(CommandQueue* queue) { commands = queue; }
+    void setOta(OtaUpdater* updater) { ota = updater; }
+    
+    // Open dashboard sockets and streams keep the board out of idle sleep
+    bool hasClients() { return ws->count() > 0 || events->count() > 0; }
+    
+    // mDNS / DHCP name without ".local"
+    const char* getHostname() const { return hostname; }
+    
     void notifyClients(const String& message);
 };
 
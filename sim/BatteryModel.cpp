@@ -0,0 +1,95 @@
+#include "BatteryModel.h"
+
+// ============================================
+// OCV CURVES
+// ============================================
+
+// Normalised OCV at SoC 0, 5, 10, 20 ... 100 %: -1 = cutoff voltage,
+// 0 = nominal voltage, +1 = max voltage (see BATTERY_CONFIGS)
+#define OCV_POINTS 12
+
+static const float OCV_SOC[OCV_POINTS] = {
+    0.00f, 0.05f, 0.10f, 0.20f, 0.30f, 0.40f, 0.50f, 0.60f, 0.70f, 0.80f, 0.90f, 1.00f
+};
+
+// NMC/LCO: steady slope, knee below 10 %
+static const float OCV_SHAPE_LIION[OCV_POINTS] = {
+    -1.000f, -0.571f, -0.357f, -0.171f, -0.071f, 0.020f, 0.140f, 0.280f, 0.440f, 0.600f, 0.760f, 1.000f
+};
+
+// LFP: long flat plateau, sharp knees at both ends
+static const float OCV_SHAPE_LIFEPO4[OCV_POINTS] = {
+    -1.000f, -0.357f, -0.143f, 0.000f, 0.089f, 0.133f, 0.156f, 0.178f, 0.200f, 0.244f, 0.311f, 1.000f
+};
+
+static const float* ocvShape(BatteryType type) {
+    return type == LIFEPO4 ? OCV_SHAPE_LIFEPO4 : OCV_SHAPE_LIION;
+}
+
+// ============================================
+// BATTERY MODEL
+// ============================================
+
+BatteryModel::BatteryModel() : soc(1.0f), v1(0), drawnAh(0), drawnWh(0),
+                               cachedDt(-1.0f), cachedDecay(0) {
+    configure(defaultParams(LIION, 2.5f));
+}
+
+CellParams BatteryModel::defaultParams(BatteryType type, float capacityAh) {
+    switch (type) {
+        case LIFEPO4: return {type, capacityAh, 0.030f, 0.015f, 3000.0f};
+        case LIPO:    return {type, capacityAh, 0.020f, 0.010f, 2500.0f};
+        default:      return {type, capacityAh, 0.045f, 0.020f, 2000.0f};
+    }
+}
+
+void BatteryModel::configure(const CellParams& cell, float initialSoc) {
+    params = cell;
+    soc = constrain(initialSoc, 0.0f, 1.0f);
+    v1 = 0;
+    drawnAh = 0;
+    drawnWh = 0;
+    cachedDt = -1.0f;
+}
+
+float BatteryModel::openCircuitVoltage() const {
+    const BatteryConfig& cfg = BATTERY_CONFIGS[params.type];
+    const float* shape = ocvShape(params.type);
+    
+    // Piecewise linear in SoC, clamped at the ends
+    float s = constrain(soc, 0.0f, 1.0f);
+    int i = 1;
+    while (i < OCV_POINTS - 1 && OCV_SOC[i] < s) i++;
+    float t = (s - OCV_SOC[i - 1]) / (OCV_SOC[i] - OCV_SOC[i - 1]);
+    float g = shape[i - 1] + t * (shape[i] - shape[i - 1]);
+    
+    float span = g < 0 ? cfg.nominalVoltage - cfg.cutoffVoltage : cfg.maxVoltage - cfg.nominalVoltage;
+    return cfg.nominalVoltage + g * span;
+}
+
+float BatteryModel::terminalVoltage(float current) const {
+    return openCircuitVoltage() - current * params.r0 - v1;
+}
+
+float BatteryModel::loadCurrent(float loadOhms) const {
+    // Vterm = I * Rload  ->  I = (OCV - V1) / (R0 + Rload)
+    float emf = openCircuitVoltage() - v1;
+    return emf > 0 ? emf / (params.r0 + loadOhms) : 0.0f;
+}
+
+void BatteryModel::step(float current, float dtSeconds) {
+    if (dtSeconds <= 0) return;
+    
+    float vTerm = terminalVoltage(current);
+    double ah = current * dtSeconds / 3600.0;
+    drawnAh += ah;
+    drawnWh += ah * vTerm;
+    soc -= ah / params.capacityAh;
+    
+    // Zero-order hold solution of the RC branch
+    if (dtSeconds != cachedDt) {
+        cachedDt = dtSeconds;
+        cachedDecay = expf(-dtSeconds / (params.r1 * params.c1));
+    }
+    v1 = v1 * cachedDecay + current * params.r1 * (1.0f - cachedDecay);
+}
@@ -0,0 +1,61 @@
+#ifndef BATTERY_MODEL_H
+#define BATTERY_MODEL_H
+
+#include "BatteryTypes.h"
+
+// ============================================
+// CELL PARAMETERS
+// ============================================
+
+// First-order Thevenin equivalent circuit:
+//   Vterm = OCV(SoC) - I*R0 - V1,   dV1/dt = I/C1 - V1/(R1*C1)
+// Current is positive when discharging.
+struct CellParams {
+    BatteryType type;
+    float capacityAh;
+    float r0;           // Ohm, ohmic resistance
+    float r1;           // Ohm, polarisation resistance
+    float c1;           // F, polarisation capacitance
+};
+
+// ============================================
+// BATTERY MODEL
+// ============================================
+
+class BatteryModel {
+private:
+    CellParams params;
+    float soc;              // 0..1
+    float v1;               // Polarisation (RC) voltage
+    double drawnAh;         // Charge actually delivered
+    double drawnWh;
+    
+    // exp(-dt/tau) for the last step length (steps are usually fixed)
+    float cachedDt;
+    float cachedDecay;
+
+public:
+    BatteryModel();
+    
+    // Typical 18650 / pouch values; OCV curve spans the BATTERY_CONFIGS
+    // cutoff..max window with the nominal voltage at mid charge
+    static CellParams defaultParams(BatteryType type, float capacityAh);
+    
+    void configure(const CellParams& cell, float initialSoc = 1.0f);
+    
+    float openCircuitVoltage() const;
+    float terminalVoltage(float current) const;
+    
+    // Current through a resistive load across the terminals
+    float loadCurrent(float loadOhms) const;
+    
+    // Advance by dt seconds at constant current (exact for the RC branch)
+    void step(float current, float dtSeconds);
+    
+    const CellParams& getParams() const { return params; }
+    float getSoc() const { return soc; }
+    double getDrawnAh() const { return drawnAh; }
+    double getDrawnWh() const { return drawnWh; }
+};
+
+#endif // BATTERY_MODEL_H
@@ -0,0 +1,184 @@
+#include "SimBoard.h"
+
+#define BUS_LSB_V 0.00125f
+#define SHUNT_RANGE_V 0.08192f
+
+SimBoard::SimBoard(const SimOptions& opts)
+    : options(opts), rngState(opts.seed ? opts.seed : 1), shiftRegister(0) {
+    for (int i = 0; i < NUM_PORTS; i++) {
+        SimPort& p = ports[i];
+        p.hasCell = false;
+        p.sensorPresent = true;
+        p.loadOhms = 0;
+        p.loadOn = false;
+        p.cutoffVoltage = 0;
+        p.voltage = p.current = 0;
+        p.windowV = p.windowI = 0;
+        p.windowMs = 0;
+        p.readV = p.readI = 0;
+        p.cutoffCrossMs = p.loadOffMs = 0;
+        p.loadOffVoltage = 0;
+        p.loadSwitches = 0;
+    }
+}
+
+SimBoard::~SimBoard() {
+    detach();
+}
+
+void SimBoard::attach() {
+    HostHarness::setIna226Source(this);
+    HostHarness::setPinWriteHook(onPinWrite, this);
+}
+
+void SimBoard::detach() {
+    if (HostHarness::getIna226Source() == this) {
+        HostHarness::setIna226Source(nullptr);
+        HostHarness::setPinWriteHook(nullptr, nullptr);
+    }
+}
+
+// ============================================
+// CELLS
+// ============================================
+
+void SimBoard::insertCell(int port, const CellParams& cell, float loadOhms, float soc) {
+    SimPort& p = ports[port];
+    p.cell.configure(cell, soc);
+    p.hasCell = true;
+    p.loadOhms = loadOhms;
+    p.cutoffVoltage = BATTERY_CONFIGS[cell.type].cutoffVoltage;
+    p.cutoffCrossMs = p.loadOffMs = 0;
+    p.loadSwitches = 0;
+    
+    // Conversion already completed before the firmware first looks
+    p.voltage = p.cell.terminalVoltage(0);
+    p.current = 0;
+    p.windowV = p.windowI = 0;
+    p.windowMs = 0;
+    p.readV = p.voltage;
+    p.readI = 0;
+}
+
+void SimBoard::removeCell(int port) {
+    ports[port].hasCell = false;
+    ports[port].voltage = ports[port].current = 0;
+    ports[port].readV = ports[port].readI = 0;
+}
+
+void SimBoard::setSensorPresent(int port, bool present) {
+    ports[port].sensorPresent = present;
+    HostHarness::setI2cPresent(HostHarness::ina226Device(port), present);
+}
+
+void SimBoard::setLoad(int port, bool on) {
+    SimPort& p = ports[port];
+    if (p.loadOn && !on) {
+        p.loadOffMs = HostHarness::nowMicros() / 1000;
+        p.loadOffVoltage = p.voltage;
+    }
+    if (p.loadOn != on) p.loadSwitches++;
+    p.loadOn = on;
+}
+
+void SimBoard::onPinWrite(uint8_t pin, uint8_t level, void* ctx) {
+    SimBoard* board = (SimBoard*)ctx;
+#if MOSFET_SHIFT_REGISTER
+    // Rising clock shifts DATA in; rising latch drives the gates
+    if (level != HIGH) return;
+    if (pin == SR_CLOCK_PIN) {
+        board->shiftRegister = (board->shiftRegister << 1) | (HostHarness::pinLevel(SR_DATA_PIN) ? 1 : 0);
+    } else if (pin == SR_LATCH_PIN) {
+        for (int i = 0; i < NUM_PORTS; i++) {
+            board->setLoad(i, (board->shiftRegister >> i) & 1);
+        }
+    }
+#else
+    for (int i = 0; i < NUM_PORTS; i++) {
+        if (MOSFET_PINS[i] == pin) board->setLoad(i, level == HIGH);
+    }
+#endif
+}
+
+// ============================================
+// TIME STEP
+// ============================================
+
+void SimBoard::step(uint32_t ms) {
+    float dt = ms / 1000.0f;
+    float windowLength = options.averages * options.conversionMs * 2.0f;
+    uint64_t nowMs = HostHarness::nowMicros() / 1000;
+    
+    for (int i = 0; i < NUM_PORTS; i++) {
+        SimPort& p = ports[i];
+        if (!p.hasCell) continue;
+        
+        // Load state is held for the whole step (MOSFETs only change between steps)
+        p.current = p.loadOn ? p.cell.loadCurrent(p.loadOhms) : 0.0f;
+        p.voltage = p.cell.terminalVoltage(p.current);
+        if (p.loadOn && p.voltage < p.cutoffVoltage && p.cutoffCrossMs == 0) {
+            p.cutoffCrossMs = nowMs;
+        }
+        p.cell.step(p.current, dt);
+        
+        // INA226 averages continuously; result updates once per window
+        p.windowV += (double)p.voltage * ms;
+        p.windowI += (double)p.current * ms;
+        p.windowMs += ms;
+        if (p.windowMs >= windowLength) latch(p);
+    }
+    
+    HostHarness::advanceMillis(ms);
+}
+
+void SimBoard::latch(SimPort& p) {
+    float v = p.windowV / p.windowMs;
+    float i = p.windowI / p.windowMs;
+    p.windowV = p.windowI = 0;
+    p.windowMs = 0;
+    
+    // Averaging divides conversion noise by sqrt(N)
+    float scale = 1.0f / sqrtf((float)options.averages);
+    v += gaussian() * options.busNoiseV * scale;
+    i += gaussian() * options.currentNoiseA * scale;
+    
+    // Shunt ADC saturates at +/-81.92 mV
+    float maxCurrent = SHUNT_RANGE_V / SHUNT_RESISTOR;
+    i = constrain(i, -maxCurrent, maxCurrent);
+    
+    // Register quantisation (current LSB as INA226_WE sets it up)
+    float currentLsb = MAX_CURRENT / 32768.0f;
+    p.readV = roundf(v / BUS_LSB_V) * BUS_LSB_V;
+    p.readI = roundf(i / currentLsb) * currentLsb;
+}
+
+// Box-Muller over xorshift32: same sequence on every platform
+float SimBoard::gaussian() {
+    float u[2];
+    for (int k = 0; k < 2; k++) {
+        rngState ^= rngState << 13;
+        rngState ^= rngState >> 17;
+        rngState ^= rngState << 5;
+        u[k] = (rngState >> 8) * (1.0f / 16777216.0f);
+    }
+    if (u[0] < 1e-7f) u[0] = 1e-7f;
+    return sqrtf(-2.0f * logf(u[0])) * cosf(2.0f * (float)PI * u[1]);
+}
+
+// ============================================
+// INA226 SOURCE
+// ============================================
+
+bool SimBoard::read(I2cDevice device, float& busVoltage, float& currentA) {
+    busVoltage = currentA = 0;
+    for (int i = 0; i < NUM_PORTS; i++) {
+        if (HostHarness::ina226Device(i) != device) continue;
+        if (!ports[i].sensorPresent) return false;
+        if (ports[i].hasCell) {
+            busVoltage = ports[i].readV;
+            currentA = ports[i].readI;
+        }
+        return true;
+    }
+    return HostHarness::isI2cPresent(device);
+}
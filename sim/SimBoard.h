@@ -0,0 +1,96 @@
+#ifndef SIM_BOARD_H
+#define SIM_BOARD_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "HostHarness.h"
+#include "BatteryModel.h"
+
+// ============================================
+// SIMULATOR OPTIONS
+// ============================================
+
+// Defaults mirror BatteryLogger::initPort (1024 averages, 1.1 ms per
+// channel) and the INA226 datasheet (1.25 mV bus LSB, 81.92 mV shunt range)
+struct SimOptions {
+    uint32_t seed;
+    float busNoiseV;            // RMS per single conversion
+    float currentNoiseA;        // RMS per single conversion
+    int averages;
+    float conversionMs;         // Per channel (shunt and bus)
+    
+    SimOptions() : seed(1), busNoiseV(0.0025f), currentNoiseA(0.002f),
+                   averages(1024), conversionMs(1.1f) {}
+};
+
+// ============================================
+// PORT STATE
+// ============================================
+
+struct SimPort {
+    BatteryModel cell;
+    bool hasCell;
+    bool sensorPresent;
+    float loadOhms;
+    bool loadOn;                // MOSFET gate (GPIO level or 74HC595 output)
+    float cutoffVoltage;        // For the crossing timestamp below
+    
+    // Instantaneous truth
+    float voltage;
+    float current;
+    
+    // INA226 conversion window and last completed result
+    double windowV;
+    double windowI;
+    float windowMs;
+    float readV;
+    float readI;
+    
+    // Events (virtual ms, 0 = not yet)
+    uint64_t cutoffCrossMs;     // Loaded voltage first below cutoff
+    uint64_t loadOffMs;         // Last on->off MOSFET transition
+    float loadOffVoltage;       // Loaded terminal voltage just before it
+    uint32_t loadSwitches;
+};
+
+// ============================================
+// SIMULATED BOARD
+// ============================================
+
+// Cells, shunts/INA226s and discharge MOSFETs around the firmware running
+// on the host. Install with attach(); then alternate step() with the
+// firmware's own update calls. Fully deterministic for a given seed.
+class SimBoard : public Ina226Source {
+private:
+    SimOptions options;
+    SimPort ports[NUM_PORTS];
+    uint32_t rngState;
+    uint32_t shiftRegister;     // 74HC595 chain, bit n = port n once latched
+    
+    float gaussian();
+    void latch(SimPort& p);
+    void setLoad(int port, bool on);
+    static void onPinWrite(uint8_t pin, uint8_t level, void* ctx);
+
+public:
+    SimBoard(const SimOptions& opts = SimOptions());
+    ~SimBoard();
+    
+    // Take over INA226 readings and MOSFET pin writes
+    void attach();
+    void detach();
+    
+    void insertCell(int port, const CellParams& cell, float loadOhms, float soc = 1.0f);
+    void removeCell(int port);
+    void setSensorPresent(int port, bool present);
+    
+    // Advance cells and the virtual clock (esp_timers fire as usual)
+    void step(uint32_t ms);
+    
+    const SimPort& getPort(int port) const { return ports[port]; }
+    
+    // Ina226Source
+    bool read(I2cDevice device, float& busVoltage, float& currentA) override;
+};
+
+#endif // SIM_BOARD_H
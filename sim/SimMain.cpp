@@ -0,0 +1,176 @@
+#include <chrono>
+#include "SimBoard.h"
+#include "BatteryTypes.h"
+#include "Logger.h"
+#include "Scheduler.h"
+
+// ============================================
+// FIRMWARE GLOBALS (main.cpp)
+// ============================================
+
+extern PortData portData[NUM_PORTS];
+extern BatteryLogger* logger;
+
+void setup();
+void updateMOSFETs();
+
+// ============================================
+// REGRESSION LIMITS
+// ============================================
+
+#define SIM_CAPACITY_TOLERANCE 0.01     // Logged mAh vs charge actually drawn
+#define SIM_CUTOFF_UNDERSHOOT_V 0.10    // Loaded voltage below cutoff at switch-off
+#define SIM_CUTOFF_EARLY_LSB 2          // Quantisation/noise may stop this far above
+#define SIM_DCIR_TOLERANCE 0.15         // Relative, plus 2 bus LSBs of step
+#define SIM_BUS_LSB_V 0.00125
+
+struct Scenario {
+    const char* label;
+    BatteryType type;
+    float capacityAh;
+    float r0Scale;          // Aged cells: higher ohmic resistance
+    float loadOhms;
+};
+
+// One cell per port (repeated on larger builds), loads kept under the
+// 0.82 A shunt range (0.1 Ohm)
+#define SCENARIO_COUNT 4
+static const Scenario SCENARIOS[SCENARIO_COUNT] = {
+    {"Li-ion 2.5Ah / 15R", LIION, 2.5f, 1.0f, 15.0f},       // ~0.25 A, ~10 h
+    {"LiFePO4 1.5Ah / 6.8R", LIFEPO4, 1.5f, 1.0f, 6.8f},
+    {"LiPo 2.0Ah / 8.2R", LIPO, 2.0f, 1.0f, 8.2f},
+    {"Aged Li-ion 3xR0 / 6.8R", LIION, 2.0f, 3.0f, 6.8f},
+};
+
+// ============================================
+// RUN
+// ============================================
+
+static void usage() {
+    printf("usage: charger_sim [--seed N] [--hours H] [--tick MS] [--verbose]\n");
+}
+
+int main(int argc, char** argv) {
+    SimOptions options;
+    float hours = 12.0f;
+    uint32_t tickMs = 100;
+    bool verbose = false;
+    
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            options.seed = strtoul(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--hours") && i + 1 < argc) {
+            hours = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--tick") && i + 1 < argc) {
+            tickMs = strtoul(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--verbose")) {
+            verbose = true;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (tickMs == 0 || tickMs > SAMPLE_INTERVAL_MS) {
+        printf("--tick must be 1..%d ms\n", SAMPLE_INTERVAL_MS);
+        return 2;
+    }
+    
+    HostHarness::reset();
+    HostHarness::setSerialEcho(verbose);
+    SimBoard board(options);
+    board.attach();
+    for (int i = 0; i < NUM_PORTS; i++) {
+        const Scenario& s = SCENARIOS[i % SCENARIO_COUNT];
+        CellParams cell = BatteryModel::defaultParams(s.type, s.capacityAh);
+        cell.r0 *= s.r0Scale;
+        board.insertCell(i, cell, s.loadOhms);
+    }
+    setup();
+    int64_t scheduleStartUs = Scheduler::getDeadline(SCHED_SAMPLE) - SAMPLE_INTERVAL_MS * 1000LL;
+    
+    // Start every port the way the OLED confirm step does
+    for (int i = 0; i < NUM_PORTS; i++) {
+        portData[i].mode = DISCHARGING;
+        portData[i].batteryType = SCENARIOS[i % SCENARIO_COUNT].type;
+        portData[i].useCustomCutoff = false;
+        portData[i].active = true;
+        portData[i].reset();
+        portData[i].startTime = millis();
+    }
+    uint64_t startMs = HostHarness::nowMicros() / 1000;
+    uint64_t endMs = startMs + (uint64_t)(hours * 3600000.0f);
+    
+    auto wallStart = std::chrono::steady_clock::now();
+    while (HostHarness::nowMicros() / 1000 < endMs) {
+        board.step(tickMs);
+        logger->update();
+        updateMOSFETs();
+        
+        bool running = false;
+        for (int i = 0; i < NUM_PORTS; i++) running |= portData[i].active;
+        if (!running) break;
+    }
+    double wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    double simHours = (HostHarness::nowMicros() / 1000 - startMs) / 3600000.0;
+    
+    // ============================================
+    // REPORT
+    // ============================================
+    
+    printf("\nSimulated %.2f h in %.3f s (%.0fx real time), seed %u, tick %u ms\n\n",
+           simHours, wallSec, simHours * 3600.0 / wallSec, options.seed, tickMs);
+    printf("%-24s %8s %9s %9s %7s %8s %7s %9s %9s  %s\n", "Port", "Status", "Logged",
+           "Drawn", "Error", "Vstop", "Lag", "DCIR", "Expected", "Result");
+    
+    int failures = 0;
+    for (int i = 0; i < NUM_PORTS; i++) {
+        const SimPort& sp = board.getPort(i);
+        const PortData& pd = portData[i];
+        const CellParams& cell = sp.cell.getParams();
+        
+        double drawnMah = sp.cell.getDrawnAh() * 1000.0;
+        double capError = drawnMah > 0 ? (pd.mAh - drawnMah) / drawnMah : 1.0;
+        float cutoff = pd.getCutoffVoltage();
+        // Switch-off delay after the true loaded voltage crossed cutoff
+        double lagSec = sp.cutoffCrossMs && sp.loadOffMs >= sp.cutoffCrossMs ?
+                        (sp.loadOffMs - sp.cutoffCrossMs) / 1000.0 : 0.0;
+        
+        // Load step after DCIR_SETTLE_MS sees R0 plus part of the RC branch
+        float tau = cell.r1 * cell.c1;
+        float expectedDcir = (cell.r0 + cell.r1 * (1.0f - expf(-DCIR_SETTLE_MS / 1000.0f / tau))) * 1000.0f;
+        float stepCurrent = cutoff / (sp.loadOhms + cell.r0);
+        float dcirLimit = expectedDcir * SIM_DCIR_TOLERANCE + 2.0f * SIM_BUS_LSB_V / stepCurrent * 1000.0f;
+        
+        const char* failure = nullptr;
+        if (pd.status != COMPLETE) {
+            failure = "not complete";
+        } else if (fabs(capError) > SIM_CAPACITY_TOLERANCE) {
+            failure = "capacity";
+        } else if (sp.loadOffVoltage > cutoff + SIM_CUTOFF_EARLY_LSB * SIM_BUS_LSB_V ||
+                   sp.loadOffVoltage < cutoff - SIM_CUTOFF_UNDERSHOOT_V) {
+            failure = "cutoff";
+        } else if (fabs(pd.dcir - expectedDcir) > dcirLimit) {
+            failure = "dcir";
+        }
+        if (failure) failures++;
+        
+        printf("%-24s %8s %6.0fmAh %6.0fmAh %+6.2f%% %7.3fV %6.1fs %6.1fmOhm %6.1fmOhm  %s\n",
+               SCENARIOS[i % SCENARIO_COUNT].label, pd.getStatusName(), pd.mAh, drawnMah, capError * 100.0,
+               sp.loadOffVoltage, lagSec, pd.dcir, expectedDcir, failure ? failure : "ok");
+    }
+    
+    // Fixed-rate sampling: one deadline per period since boot, whatever the tick
+    ScheduleStats sample;
+    Scheduler::getStats(SCHED_SAMPLE, sample);
+    uint64_t expectedRuns = (HostHarness::nowMicros() - scheduleStartUs) / sample.periodUs;
+    uint64_t served = (uint64_t)sample.runs + sample.skipped;
+    bool drift = served + 1 < expectedRuns || served > expectedRuns + 1;
+    if (drift) failures++;
+    printf("\nSample deadlines: %u run, %u skipped, %llu expected, max late %u us  %s\n",
+           sample.runs, sample.skipped, (unsigned long long)expectedRuns, sample.maxLateUs,
+           drift ? "drift" : "ok");
+    
+    printf("\n%s\n", failures ? "FAIL" : "PASS");
+    board.detach();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,160 @@
+#include "Buzzer.h"
+
+// ============================================
+// PATTERN TABLE
+// ============================================
+
+// Pattern body, played after the optional port pips
+static const BuzzerNote NOTES_MENU[] = {
+    {BUZZER_FREQ_MENU, BUZZER_DURATION_SHORT}
+};
+
+static const BuzzerNote NOTES_SELECT[] = {
+    {BUZZER_FREQ_SELECT, BUZZER_DURATION_LONG}
+};
+
+static const BuzzerNote NOTES_COMPLETE[] = {
+    {0, BUZZER_DURATION_GAP * 2},
+    {BUZZER_FREQ_COMPLETE, BUZZER_DURATION_COMPLETE}
+};
+
+static const BuzzerNote NOTES_ERROR[] = {
+    {0, BUZZER_DURATION_GAP * 2},
+    {BUZZER_FREQ_ERROR, BUZZER_DURATION_LONG},
+    {0, BUZZER_DURATION_GAP},
+    {BUZZER_FREQ_ERROR, BUZZER_DURATION_LONG}
+};
+
+struct PatternDef {
+    const BuzzerNote* notes;
+    uint8_t count;
+    uint16_t pipFreq;    // Port is encoded as (port + 1) pips, 0 = no pips
+};
+
+// Indexed by BuzzerPattern
+static const PatternDef PATTERNS[] = {
+    {nullptr, 0, 0},  // BEEP_NONE
+    {NOTES_MENU, 1, 0},  // BEEP_MENU
+    {NOTES_SELECT, 1, 0},  // BEEP_SELECT
+    {NOTES_COMPLETE, 2, BUZZER_FREQ_COMPLETE},  // BEEP_COMPLETE
+    {NOTES_ERROR, 4, BUZZER_FREQ_ERROR}   // BEEP_ERROR
+};
+
+// ============================================
+// CONSTRUCTOR
+// ============================================
+
+Buzzer::Buzzer() {
+    timer = nullptr;
+    mutex = nullptr;
+    length = 0;
+    position = 0;
+    generation = 0;
+}
+
+// ============================================
+// INITIALIZATION
+// ============================================
+
+bool Buzzer::begin() {
+    ledcAttachPin(BUZZER_PIN, BUZZER_LEDC_CHANNEL);
+    ledcWriteTone(BUZZER_LEDC_CHANNEL, 0);
+    
+    mutex = xSemaphoreCreateMutex();
+    if (!mutex) {
+        DEBUG_PRINTLN("ERROR: Buzzer mutex create failed");
+        return false;
+    }
+    
+    esp_timer_create_args_t args = {};
+    args.callback = &Buzzer::onTimer;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "buzzer";
+    
+    if (esp_timer_create(&args, &timer) != ESP_OK) {
+        DEBUG_PRINTLN("ERROR: Buzzer timer create failed");
+        timer = nullptr;
+        return false;
+    }
+    return true;
+}
+
+// ============================================
+// PLAYBACK
+// ============================================
+
+void Buzzer::play(BuzzerPattern pattern, int port) {
+    if (!timer || pattern == BEEP_NONE) return;
+    
+    const PatternDef& def = PATTERNS[pattern];
+    uint8_t count = 0;
+    
+    // New pattern always preempts the current one
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    silence();
+    if (def.pipFreq != 0 && port >= 0) {
+        const BuzzerNote pip[] = {
+            {def.pipFreq, BUZZER_DURATION_PIP},
+            {0, BUZZER_DURATION_GAP}
+        };
+        for (int i = 0; i <= port; i++) {
+            count = append(count, pip, 2);
+        }
+    }
+    count = append(count, def.notes, def.count);
+    length = count;
+    startNote(0);
+    xSemaphoreGive(mutex);
+}
+
+void Buzzer::stop() {
+    if (!timer) return;
+    
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    silence();
+    xSemaphoreGive(mutex);
+}
+
+// Mutex held
+void Buzzer::silence() {
+    esp_timer_stop(timer);  // Returns error if not running - ignore
+    generation++;
+    length = 0;
+    position = 0;
+    ledcWriteTone(BUZZER_LEDC_CHANNEL, 0);
+}
+
+uint8_t Buzzer::append(uint8_t count, const BuzzerNote* notes, uint8_t noteCount) {
+    for (uint8_t i = 0; i < noteCount && count < BUZZER_MAX_NOTES; i++) {
+        sequence[count++] = notes[i];
+    }
+    return count;
+}
+
+// Mutex held
+void Buzzer::startNote(uint8_t index) {
+    position = index;
+    if (index >= length) {
+        ledcWriteTone(BUZZER_LEDC_CHANNEL, 0);
+        return;
+    }
+    
+    const BuzzerNote& note = sequence[index];
+    ledcWriteTone(BUZZER_LEDC_CHANNEL, note.freq);
+    esp_timer_start_once(timer, (uint64_t)note.durationMs * 1000ULL);
+}
+
+// fired: generation read when the callback started, before the mutex
+void Buzzer::advance(uint32_t fired) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (fired == generation && position < length) {
+        startNote(position + 1);
+    }
+    xSemaphoreGive(mutex);
+}
+
+void Buzzer::onTimer(void* arg) {
+    Buzzer* buzzer = static_cast<Buzzer*>(arg);
+    buzzer->advance(buzzer->generation);
+}
@@ -0,0 +1,399 @@
+#include "Capture.h"
+#include "Scheduler.h"
+#include <algorithm>
+#include <esp_heap_caps.h>
+
+#define MAX_READ_ERRORS 10      // Consecutive failed burst reads before giving up
+
+static const char* STATE_NAMES[] = {
+    "idle",
+    "armed",
+    "done",
+    "timeout",
+    "failed"
+};
+
+static const char* TRIGGER_NAMES[] = {
+    "load",
+    "dip"
+};
+
+// ============================================
+// CONSTRUCTOR
+// ============================================
+
+WaveformCapture::WaveformCapture(PortData* data) {
+    portData = data;
+    logger = nullptr;
+    loadSwitch = nullptr;
+    samples = nullptr;
+    capacity = 0;
+    inPsram = false;
+    
+    state = CAPTURE_IDLE;
+    cancelPending = false;
+    generation = 0;
+    port = 0;
+    trigger = CAPTURE_TRIGGER_LOAD;
+    preSamples = 0;
+    postSamples = 0;
+    intervalUs = CAPTURE_SAMPLE_US;
+    dipVolts = 0;
+    armedAt = 0;
+    started = false;
+    holdLoad = false;
+    triggered = false;
+    readErrors = 0;
+    
+    head = 0;
+    preFilled = 0;
+    nextSampleUs = 0;
+    baseline = 0;
+    triggerTime = 0;
+    postTaken = 0;
+    
+    sampleCount = 0;
+    triggerIndex = 0;
+    capturedAt = 0;
+    actualIntervalUs = 0;
+    minMillivolts = 0;
+    maxMillivolts = 0;
+    maxMilliamps = 0;
+    result[0] = '\0';
+}
+
+// ============================================
+// INITIALIZATION
+// ============================================
+
+// The ring is taken once at boot, before the heap fragments, and kept
+bool WaveformCapture::begin() {
+    if (psramFound()) {
+        samples = (CaptureSample*)heap_caps_malloc(CAPTURE_PSRAM_SAMPLES * sizeof(CaptureSample), MALLOC_CAP_SPIRAM);
+        if (samples) {
+            capacity = CAPTURE_PSRAM_SAMPLES;
+            inPsram = true;
+        }
+    }
+    if (!samples) {
+        samples = (CaptureSample*)heap_caps_malloc(CAPTURE_DRAM_SAMPLES * sizeof(CaptureSample), MALLOC_CAP_8BIT);
+        capacity = samples ? CAPTURE_DRAM_SAMPLES : 0;
+    }
+    
+    if (!samples) {
+        DEBUG_PRINTLN("ERROR: Capture buffer allocation failed");
+        return false;
+    }
+    DEBUG_PRINTF("Capture buffer: %u samples in %s\n", capacity, inPsram ? "PSRAM" : "DRAM");
+    return true;
+}
+
+// ============================================
+// ARM (loop) / CANCEL (web task)
+// ============================================
+
+const char* WaveformCapture::checkArm(int p, CaptureTrigger t) const {
+    if (!samples || !logger) return "No capture buffer";
+    if (state == CAPTURE_ARMED) return "Capture already armed";
+    if (p < 0 || p >= NUM_PORTS || !portData[p].active || portData[p].status == ERROR) {
+        return "Port not running";
+    }
+    if (logger->isCalibrating(p) || logger->isLoadHeld(p)) return "Port busy (calibration or DCIR)";
+    if (t == CAPTURE_TRIGGER_LOAD && (portData[p].mode != DISCHARGING || !loadSwitch)) {
+        return "Load step needs a discharging port";
+    }
+    return nullptr;
+}
+
+bool WaveformCapture::arm(int p, CaptureTrigger t, uint32_t preMs, uint32_t postMs, uint32_t dipMv) {
+    const char* refused = checkArm(p, t);
+    if (refused) {
+        // An armed capture keeps its own status
+        if (state != CAPTURE_ARMED) snprintf(result, sizeof(result), "%s", refused);
+        return false;
+    }
+    
+    // Full rate when the window fits the ring, otherwise spread it over the window
+    uint64_t windowUs = (uint64_t)(preMs + postMs) * 1000ULL;
+    intervalUs = max((uint32_t)CAPTURE_SAMPLE_US, (uint32_t)((windowUs + capacity - 1) / capacity));
+    preSamples = preMs * 1000ULL / intervalUs;
+    postSamples = max((uint32_t)1, (uint32_t)(postMs * 1000ULL / intervalUs));
+    
+    port = p;
+    trigger = t;
+    dipVolts = dipMv / 1000.0f;
+    head = 0;
+    preFilled = 0;
+    sampleCount = 0;
+    started = false;
+    triggered = false;
+    readErrors = 0;
+    postTaken = 0;
+    cancelPending = false;
+    holdLoad = t == CAPTURE_TRIGGER_LOAD;
+    armedAt = millis();
+    generation++;
+    snprintf(result, sizeof(result), "Armed");
+    state = CAPTURE_ARMED;
+    
+    DEBUG_PRINTF("Port %d: capture armed (%s, %u + %u samples every %u us)\n",
+                 port, TRIGGER_NAMES[trigger], preSamples, postSamples, intervalUs);
+    return true;
+}
+
+// Burst mode and the load hold belong to the loop task; it finishes the job
+void WaveformCapture::cancel() {
+    if (state == CAPTURE_ARMED) cancelPending = true;
+}
+
+// ============================================
+// SAMPLING (loop task)
+// ============================================
+
+void WaveformCapture::update() {
+    if (state != CAPTURE_ARMED) return;
+    PortData& p = portData[port];
+    
+    if (cancelPending) {
+        finish(CAPTURE_IDLE, "Cancelled");
+        return;
+    }
+    if (!p.active || p.status == ERROR) {
+        finish(CAPTURE_FAILED, "Port stopped");
+        return;
+    }
+    
+    // First pass only switches the sensor over; updateMOSFETs then drops
+    // the gate for a load step before any sample is taken
+    if (!started) {
+        if (!logger->setBurstMode(port, true)) {
+            finish(CAPTURE_FAILED, "Sensor unavailable");
+            return;
+        }
+        started = true;
+        nextSampleUs = Scheduler::nowUs() + intervalUs;
+        baseline = p.voltage;
+        return;
+    }
+    
+    int64_t sliceEnd = Scheduler::nowUs() + CAPTURE_SLICE_MS * 1000LL;
+    float volts = baseline;
+    
+    if (!triggered && trigger == CAPTURE_TRIGGER_LOAD) {
+        // Rest voltage with the load held off; the edge opens a later pass
+        if (preFilled < preSamples) {
+            while (preFilled < preSamples && Scheduler::nowUs() < sliceEnd) {
+                if (takeSample(samples[preFilled])) {
+                    preFilled++;
+                    readErrors = 0;
+                } else if (readFailed()) {
+                    return;
+                }
+            }
+            return;
+        }
+        
+        head = 0;
+        startPost((uint32_t)Scheduler::nowUs(), 0);
+        loadSwitch(port, true);
+    }
+    
+    // Dip: watch for one slice, then give the rest of the loop its turn
+    CaptureSample s;
+    while (!triggered && Scheduler::nowUs() < sliceEnd) {
+        if (!takeSample(s)) {
+            if (readFailed()) return;
+            continue;
+        }
+        readErrors = 0;
+        
+        volts = s.millivolts / 1000.0f;
+        if (volts <= baseline - dipVolts) {
+            samples[preSamples] = s;
+            startPost((uint32_t)s.timeUs, 1);
+            sliceEnd = Scheduler::nowUs() + CAPTURE_SLICE_MS * 1000LL;
+            break;
+        }
+        baseline += (volts - baseline) / CAPTURE_BASELINE_SAMPLES;
+        
+        if (preSamples > 0) {
+            samples[head] = s;
+            head = (head + 1) % preSamples;
+            if (preFilled < preSamples) preFilled++;
+        }
+    }
+    
+    if (triggered && samplePost(sliceEnd, volts)) return;
+    
+    // The normal sweep skips this port while armed, so watch the cutoff here
+    if (volts < p.getCutoffVoltage()) {
+        finish(CAPTURE_FAILED, "Cutoff reached");
+    } else if (!triggered && millis() - armedAt >= CAPTURE_ARM_TIMEOUT_MS) {
+        finish(CAPTURE_TIMEOUT, "No trigger");
+    }
+}
+
+bool WaveformCapture::readFailed() {
+    if (++readErrors < MAX_READ_ERRORS) return false;
+    finish(CAPTURE_FAILED, "I2C errors");
+    return true;
+}
+
+// Paced to intervalUs; a late read (slice gap, I2C retry) restarts the
+// grid instead of firing a catch-up burst. timeUs holds the low 32 bits
+// of esp_timer until linearize() makes it trigger-relative.
+bool WaveformCapture::takeSample(CaptureSample& s) {
+    int64_t wait = nextSampleUs - Scheduler::nowUs();
+    if (wait > 0) delayMicroseconds(wait);
+    
+    int64_t now = Scheduler::nowUs();
+    if (now - nextSampleUs > (int64_t)intervalUs) nextSampleUs = now;
+    nextSampleUs += intervalUs;
+    
+    float voltage, current;
+    if (!logger->readBurst(port, voltage, current)) return false;
+    
+    s.timeUs = (int32_t)(uint32_t)now;
+    s.millivolts = (uint16_t)constrain(voltage * 1000.0f, 0.0f, 65535.0f);
+    s.milliamps = (int16_t)constrain(current * 1000.0f, -32768.0f, 32767.0f);
+    return true;
+}
+
+// The load goes back under updateMOSFETs from here: it is on (load step)
+// and must drop at cutoff like any other discharging port
+void WaveformCapture::startPost(uint32_t time, uint32_t taken) {
+    triggered = true;
+    holdLoad = false;
+    triggerTime = time;
+    postTaken = taken;
+}
+
+// One slice of the post window; true once the capture has finished
+bool WaveformCapture::samplePost(int64_t sliceEnd, float& volts) {
+    while (postTaken < postSamples && Scheduler::nowUs() < sliceEnd) {
+        CaptureSample& s = samples[preSamples + postTaken];
+        if (takeSample(s)) {
+            volts = s.millivolts / 1000.0f;
+            postTaken++;
+            readErrors = 0;
+        } else if (readFailed()) {
+            return true;
+        }
+    }
+    if (postTaken < postSamples) return false;
+    
+    capturedAt = millis() / 1000;
+    linearize();
+    finish(CAPTURE_DONE, "OK");
+    return true;
+}
+
+// Pre ring into time order, post window moved up behind it, timestamps
+// made relative to the trigger
+void WaveformCapture::linearize() {
+    if (preFilled == preSamples) {
+        std::rotate(samples, samples + head, samples + preSamples);
+    } else {
+        memmove(samples + preFilled, samples + preSamples, postTaken * sizeof(CaptureSample));
+    }
+    
+    sampleCount = preFilled + postTaken;
+    triggerIndex = preFilled;
+    minMillivolts = 0xFFFF;
+    maxMillivolts = 0;
+    maxMilliamps = INT16_MIN;
+    
+    for (uint32_t i = 0; i < sampleCount; i++) {
+        CaptureSample& s = samples[i];
+        s.timeUs = (int32_t)((uint32_t)s.timeUs - triggerTime);
+        minMillivolts = min(minMillivolts, s.millivolts);
+        maxMillivolts = max(maxMillivolts, s.millivolts);
+        maxMilliamps = max(maxMilliamps, s.milliamps);
+    }
+    
+    actualIntervalUs = sampleCount > 1
+        ? (uint32_t)(samples[sampleCount - 1].timeUs - samples[0].timeUs) / (sampleCount - 1)
+        : 0;
+}
+
+void WaveformCapture::finish(CaptureState next, const char* message) {
+    if (started) logger->setBurstMode(port, false);
+    started = false;
+    holdLoad = false;
+    triggered = false;
+    cancelPending = false;
+    if (next != CAPTURE_DONE) sampleCount = 0;
+    snprintf(result, sizeof(result), "%s", message);
+    state = next;
+    
+    DEBUG_PRINTF("Port %d: capture %s (%s, %u samples)\n", port, STATE_NAMES[next], message, sampleCount);
+}
+
+// ============================================
+// DOWNLOAD
+// ============================================
+
+void WaveformCapture::getHeader(CaptureFileHeader& header) {
+    memset(&header, 0, sizeof(header));
+    header.magic = CAPTURE_BIN_MAGIC;
+    header.version = CAPTURE_BIN_VERSION;
+    header.sampleSize = sizeof(CaptureSample);
+    header.port = port;
+    header.trigger = trigger;
+    header.sampleCount = sampleCount;
+    header.triggerIndex = triggerIndex;
+    header.intervalUs = intervalUs;
+    header.capturedAt = capturedAt;
+}
+
+// Chunk filler for the streamed response: header, then samples straight
+// from the ring (no copy of the whole capture)
+size_t WaveformCapture::readBinary(uint8_t* out, size_t maxLen, size_t index) {
+    size_t total = getBinarySize();
+    if (index >= total) return 0;
+    size_t len = min(maxLen, total - index);
+    size_t done = 0;
+    
+    if (index < sizeof(CaptureFileHeader)) {
+        CaptureFileHeader header;
+        getHeader(header);
+        done = min(len, sizeof(header) - index);
+        memcpy(out, (const uint8_t*)&header + index, done);
+    }
+    if (done < len) {
+        size_t offset = index + done - sizeof(CaptureFileHeader);
+        memcpy(out + done, (const uint8_t*)samples + offset, len - done);
+    }
+    return len;
+}
+
+// ============================================
+// STATUS JSON
+// ============================================
+
+void WaveformCapture::addStatusJSON(JsonObject out) {
+    out["state"] = STATE_NAMES[state];
+    out["result"] = result;
+    out["capacity"] = capacity;
+    out["psram"] = inPsram;
+    if (state == CAPTURE_IDLE && generation == 0) return;
+    
+    out["port"] = port;
+    out["trigger"] = TRIGGER_NAMES[trigger];
+    out["intervalUs"] = intervalUs;
+    out["preSamples"] = preSamples;
+    out["postSamples"] = postSamples;
+    
+    if (state == CAPTURE_ARMED) {
+        out["armedMs"] = millis() - armedAt;
+    } else if (state == CAPTURE_DONE) {
+        out["samples"] = sampleCount;
+        out["triggerIndex"] = triggerIndex;
+        out["actualIntervalUs"] = actualIntervalUs;
+        out["capturedAt"] = capturedAt;
+        out["vMin"] = minMillivolts / 1000.0f;
+        out["vMax"] = maxMillivolts / 1000.0f;
+        out["iMax"] = maxMilliamps / 1000.0f;
+        out["bytes"] = getBinarySize();
+    }
+}
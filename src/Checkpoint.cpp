@@ -0,0 +1,209 @@
+#include "Checkpoint.h"
+#include <rom/crc.h>
+
+#define CHECKPOINT_MAGIC 0x43484B50  // "CHKP"
+#define CHECKPOINT_VERSION 1
+
+static const char* SLOT_KEYS[2] = {"slotA", "slotB"};
+
+// ============================================
+// CONSTRUCTOR
+// ============================================
+
+CheckpointStore::CheckpointStore(PortData* data) {
+    portData = data;
+    writerTask = nullptr;
+    lock = portMUX_INITIALIZER_UNLOCKED;
+    sequence = 0;
+    lastWrite = 0;
+    resumePending = false;
+    offerTime = 0;
+    
+    memset(&outgoing, 0, sizeof(outgoing));
+    memset(&saved, 0, sizeof(saved));
+    
+    for (int i = 0; i < NUM_PORTS; i++) {
+        lastMode[i] = SAFETY;
+        lastStatus[i] = IDLE;
+    }
+}
+
+// ============================================
+// INITIALIZATION
+// ============================================
+
+bool CheckpointStore::begin() {
+    if (!prefs.begin(CHECKPOINT_NAMESPACE, false)) {
+        DEBUG_PRINTLN("ERROR: Checkpoint NVS namespace open failed");
+        return false;
+    }
+    
+    // Pick the newest valid slot
+    CheckpointRecord a, b;
+    bool validA = readSlot(SLOT_KEYS[0], a);
+    bool validB = readSlot(SLOT_KEYS[1], b);
+    
+    if (validA || validB) {
+        saved = (validA && (!validB || a.sequence > b.sequence)) ? a : b;
+        sequence = saved.sequence;
+        
+        for (int i = 0; i < NUM_PORTS; i++) {
+            if (saved.ports[i].flags & 0x01) {
+                resumePending = true;
+            }
+        }
+        
+        if (resumePending) {
+            offerTime = millis();
+            DEBUG_PRINTF("Checkpoint #%u found with active tests - resume offered\n", saved.sequence);
+        }
+    }
+    
+    xTaskCreatePinnedToCore(writerLoop, "checkpoint", 4096, this,
+                            CHECKPOINT_TASK_PRIORITY, &writerTask, CHECKPOINT_TASK_CORE);
+    return writerTask != nullptr;
+}
+
+bool CheckpointStore::readSlot(const char* key, CheckpointRecord& out) {
+    if (prefs.getBytesLength(key) != sizeof(CheckpointRecord)) return false;
+    if (prefs.getBytes(key, &out, sizeof(CheckpointRecord)) != sizeof(CheckpointRecord)) return false;
+    
+    return out.magic == CHECKPOINT_MAGIC &&
+           out.version == CHECKPOINT_VERSION &&
+           out.portCount == NUM_PORTS &&
+           out.crc == computeCRC(out);
+}
+
+// ============================================
+// UPDATE (called from loop, never blocks)
+// ============================================
+
+void CheckpointStore::update() {
+    unsigned long now = millis();
+    bool changed = false;
+    bool anyActive = false;
+    
+    for (int i = 0; i < NUM_PORTS; i++) {
+        if (portData[i].mode != lastMode[i] || portData[i].status != lastStatus[i]) {
+            lastMode[i] = portData[i].mode;
+            lastStatus[i] = portData[i].status;
+            changed = true;
+        }
+        if (portData[i].active) anyActive = true;
+    }
+    
+    if (resumePending) {
+        // A manually started test or an ignored offer supersedes the old record
+        if (anyActive || now - offerTime >= RESUME_OFFER_TIMEOUT_MS) {
+            DEBUG_PRINTLN("Checkpoint resume offer dropped");
+            discard();
+        }
+        return;
+    }
+    
+    if (changed || (anyActive && now - lastWrite >= CHECKPOINT_INTERVAL_MS)) {
+        requestWrite();
+        lastWrite = now;
+    }
+}
+
+void CheckpointStore::requestWrite() {
+    if (!writerTask) return;
+    
+    unsigned long now = millis();
+    
+    // Snapshot under lock; CRC and flash write happen on the writer task
+    portENTER_CRITICAL(&lock);
+    outgoing.magic = CHECKPOINT_MAGIC;
+    outgoing.version = CHECKPOINT_VERSION;
+    outgoing.portCount = NUM_PORTS;
+    outgoing.sequence = ++sequence;
+    for (int i = 0; i < NUM_PORTS; i++) {
+        PortCheckpoint& cp = outgoing.ports[i];
+        cp.mAh = portData[i].mAh;
+        cp.Wh = portData[i].Wh;
+        cp.elapsedMs = portData[i].active ? now - portData[i].startTime : 0;
+        cp.customCutoff = portData[i].customCutoff;
+        cp.mode = portData[i].mode;
+        cp.batteryType = portData[i].batteryType;
+        cp.status = portData[i].status;
+        cp.flags = (portData[i].active ? 0x01 : 0) | (portData[i].useCustomCutoff ? 0x02 : 0);
+    }
+    portEXIT_CRITICAL(&lock);
+    
+    xTaskNotifyGive(writerTask);
+}
+
+// ============================================
+// WRITER TASK
+// ============================================
+
+void CheckpointStore::writerLoop(void* arg) {
+    CheckpointStore* self = static_cast<CheckpointStore*>(arg);
+    CheckpointRecord record;
+    
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        
+        // Several requests may have coalesced - write only the latest
+        portENTER_CRITICAL(&self->lock);
+        memcpy(&record, &self->outgoing, sizeof(record));
+        portEXIT_CRITICAL(&self->lock);
+        
+        self->writeRecord(record);
+    }
+}
+
+void CheckpointStore::writeRecord(CheckpointRecord& record) {
+    record.crc = computeCRC(record);
+    
+    // Alternate slots by sequence so the previous record survives a torn write
+    const char* key = SLOT_KEYS[record.sequence & 1];
+    if (prefs.putBytes(key, &record, sizeof(record)) != sizeof(record)) {
+        DEBUG_PRINTLN("WARNING: Checkpoint write failed");
+    }
+}
+
+uint32_t CheckpointStore::computeCRC(const CheckpointRecord& record) {
+    return crc32_le(0, (const uint8_t*)&record, offsetof(CheckpointRecord, crc));
+}
+
+// ============================================
+// RESUME / DISCARD
+// ============================================
+
+void CheckpointStore::resume() {
+    if (!resumePending) return;
+    
+    unsigned long now = millis();
+    for (int i = 0; i < NUM_PORTS; i++) {
+        const PortCheckpoint& cp = saved.ports[i];
+        if (!(cp.flags & 0x01)) continue;
+        
+        portData[i].mode = (OperationMode)cp.mode;
+        portData[i].batteryType = (BatteryType)cp.batteryType;
+        portData[i].customCutoff = cp.customCutoff;
+        portData[i].useCustomCutoff = (cp.flags & 0x02) != 0;
+        portData[i].mAh = cp.mAh;
+        portData[i].Wh = cp.Wh;
+        portData[i].startTime = now - cp.elapsedMs;
+        portData[i].lastUpdate = now;  // Don't integrate the outage
+        portData[i].dcirPending = false;
+        portData[i].status = ACTIVE;
+        portData[i].active = true;
+        
+        DEBUG_PRINTF("Port %d: Resumed %s at %.1f mAh\n", i,
+                     portData[i].getModeName(), cp.mAh);
+    }
+    
+    resumePending = false;
+    requestWrite();
+}
+
+void CheckpointStore::discard() {
+    if (!resumePending) return;
+    resumePending = false;
+    
+    // Overwrite with current (idle) state so the offer doesn't return on next boot
+    requestWrite();
+}
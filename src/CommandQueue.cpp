@@ -0,0 +1,200 @@
+#include "CommandQueue.h"
+
+#define QUEUE_MASK (COMMAND_QUEUE_SIZE - 1)
+
+// ============================================
+// CONSTRUCTOR
+// ============================================
+
+CommandQueue::CommandQueue(PortData* data) {
+    portData = data;
+    checkpoint = nullptr;
+    logger = nullptr;
+    capture = nullptr;
+    compressor = nullptr;
+    
+    for (uint32_t i = 0; i < COMMAND_QUEUE_SIZE; i++) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    head.store(0, std::memory_order_relaxed);
+    tail = 0;
+    
+    pushed.store(0, std::memory_order_relaxed);
+    rejected.store(0, std::memory_order_relaxed);
+    applied = 0;
+    maxDepth = 0;
+}
+
+// ============================================
+// PRODUCERS (any task)
+// ============================================
+
+// Bounded MPSC ring. A slot is free for position p while its sequence is
+// p, readable once it is p + 1, and free again for p + size after drain().
+// drain() frees slots in order, so the group's last slot being free means
+// the whole range is, and the CAS on head makes the range ours.
+bool CommandQueue::push(const PortCommand* commands, int count) {
+    if (count <= 0 || count > COMMAND_QUEUE_SIZE) return false;
+    
+    uint32_t pos = head.load(std::memory_order_relaxed);
+    for (;;) {
+        uint32_t last = pos + count - 1;
+        uint32_t seq = slots[last & QUEUE_MASK].sequence.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(seq - last);
+        
+        if (diff == 0) {
+            if (head.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = head.load(std::memory_order_relaxed);
+        }
+    }
+    
+    for (int k = 0; k < count; k++) {
+        Slot& slot = slots[(pos + k) & QUEUE_MASK];
+        slot.command = commands[k];
+        slot.command.groupSize = k == 0 ? count : 0;
+        slot.sequence.store(pos + k + 1, std::memory_order_release);
+    }
+    pushed.fetch_add(count, std::memory_order_relaxed);
+    return true;
+}
+
+bool CommandQueue::pushSettings(const PortSettings& settings) {
+    PortCommand command;
+    command.type = CMD_PORT_SETTINGS;
+    command.settings = settings;
+    return push(command);
+}
+
+// ============================================
+// CONSUMER (loop)
+// ============================================
+
+void CommandQueue::drain() {
+    uint32_t depth = head.load(std::memory_order_relaxed) - tail;
+    if (depth > maxDepth) maxDepth = depth;
+    
+    for (;;) {
+        Slot& first = slots[tail & QUEUE_MASK];
+        if (first.sequence.load(std::memory_order_acquire) != tail + 1) break;
+        
+        // Slots are written in order, so the last one ready means all are;
+        // a group still being written waits for the next pass
+        uint32_t count = first.command.groupSize;
+        Slot& last = slots[(tail + count - 1) & QUEUE_MASK];
+        if (last.sequence.load(std::memory_order_acquire) != tail + count) break;
+        
+        for (uint32_t k = 0; k < count; k++) {
+            Slot& slot = slots[(tail + k) & QUEUE_MASK];
+            apply(slot.command);
+            slot.sequence.store(tail + k + COMMAND_QUEUE_SIZE, std::memory_order_release);
+        }
+        tail += count;
+        applied += count;
+    }
+}
+
+void CommandQueue::apply(const PortCommand& command) {
+    switch (command.type) {
+        case CMD_PORT_SETTINGS:
+            applySettings(command.settings);
+            break;
+        case CMD_RESUME:
+            if (checkpoint) checkpoint->resume();
+            break;
+        case CMD_DISCARD_RESUME:
+            if (checkpoint) checkpoint->discard();
+            break;
+        case CMD_CALIBRATE_SET:
+        case CMD_CALIBRATE_START:
+            applyCalibration(command);
+            break;
+        case CMD_CAPTURE_ARM: {
+            // A refusal (port stopped meanwhile) shows in the capture result
+            const CaptureCommand& c = command.capture;
+            if (capture) capture->arm(c.port, c.trigger, c.preMs, c.postMs, c.dipMv);
+            break;
+        }
+        case CMD_CELL_LABEL:
+            if (command.label.port < NUM_PORTS) {
+                PortData& p = portData[command.label.port];
+                strlcpy(p.cellLabel, command.label.label, sizeof(p.cellLabel));
+            }
+            break;
+        case CMD_COMPRESSION:
+            // Between samples, so no door is half-way through an update
+            if (!compressor) break;
+            for (int s = 0; s < SIGNAL_COUNT; s++) {
+                if (command.compression.fields & (1 << s)) {
+                    compressor->setTolerance((CompressSignal)s, command.compression.tolerance[s]);
+                }
+            }
+            break;
+    }
+}
+
+// Reset first, then type and cutoff, then the mode, so a port never
+// starts on its old cutoff
+void CommandQueue::applySettings(const PortSettings& settings) {
+    if (settings.port >= NUM_PORTS) return;
+    PortData& p = portData[settings.port];
+    
+    if (settings.fields & PORT_SET_RESET) {
+        p.reset();
+    }
+    if (settings.fields & PORT_SET_BATTERY) {
+        p.batteryType = settings.batteryType;
+    }
+    if (settings.fields & PORT_SET_CUTOFF) {
+        p.customCutoff = settings.cutoff;
+        p.useCustomCutoff = true;
+    }
+    if (settings.fields & PORT_SET_MODE) {
+        p.mode = settings.mode;
+        if (settings.mode == SAFETY) {
+            p.active = false;
+        } else {
+            p.active = true;
+            if (p.startTime == 0) {
+                p.startTime = millis();
+            }
+        }
+    }
+    if (settings.fields & PORT_SET_START) {
+        p.reset();
+        p.active = true;
+    }
+}
+
+void CommandQueue::applyCalibration(const PortCommand& command) {
+    const CalibrationCommand& c = command.calibration;
+    if (!logger || c.port >= NUM_PORTS) return;
+    
+    if (command.type == CMD_CALIBRATE_START) {
+        logger->startCalibration(c.port, c.step, c.reference, c.referenceIsLoad);
+        return;
+    }
+    
+    PortCalibration cal = logger->getCalibration(c.port);
+    if (c.fields & CAL_SET_VOLTAGE_GAIN) cal.voltageGain = c.values.voltageGain;
+    if (c.fields & CAL_SET_VOLTAGE_OFFSET) cal.voltageOffset = c.values.voltageOffset;
+    if (c.fields & CAL_SET_CURRENT_GAIN) cal.currentGain = c.values.currentGain;
+    if (c.fields & CAL_SET_CURRENT_OFFSET) cal.currentOffset = c.values.currentOffset;
+    logger->setCalibration(c.port, cal);
+}
+
+// ============================================
+// STATS JSON
+// ============================================
+
+void CommandQueue::addStatsJSON(JsonObject out) {
+    out["size"] = COMMAND_QUEUE_SIZE;
+    out["pending"] = head.load(std::memory_order_relaxed) - tail;
+    out["pushed"] = pushed.load(std::memory_order_relaxed);
+    out["applied"] = applied;
+    out["rejected"] = rejected.load(std::memory_order_relaxed);
+    out["maxDepth"] = maxDepth;
+}
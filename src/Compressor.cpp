@@ -0,0 +1,253 @@
+#include "Compressor.h"
+#include <float.h>
+#include <esp_heap_caps.h>
+
+static const char* SIGNAL_KEYS[] = {
+    "voltage",
+    "current",
+    "power"
+};
+
+static float signalValue(const LogRecord& record, int s) {
+    switch (s) {
+        case SIGNAL_VOLTAGE: return record.voltage;
+        case SIGNAL_CURRENT: return record.current;
+        default: return record.voltage * record.current;
+    }
+}
+
+// ============================================
+// CONSTRUCTOR
+// ============================================
+
+TelemetryCompressor::TelemetryCompressor(PortData* data) {
+    portData = data;
+    memset(ports, 0, sizeof(ports));
+    tolerance[SIGNAL_VOLTAGE] = COMPRESS_TOL_V;
+    tolerance[SIGNAL_CURRENT] = COMPRESS_TOL_A;
+    tolerance[SIGNAL_POWER] = COMPRESS_TOL_W;
+    
+    history = nullptr;
+    capacity = 0;
+    inPsram = false;
+    written = 0;
+    lock = portMUX_INITIALIZER_UNLOCKED;
+    
+    samplesIn = 0;
+    pointsKept = 0;
+}
+
+// ============================================
+// INITIALIZATION
+// ============================================
+
+// History ring taken once at boot, like the capture buffer. Without it
+// the log download is empty.
+bool TelemetryCompressor::begin() {
+    for (int i = 0; i < NUM_PORTS; i++) {
+        PortCompression& c = ports[i];
+        c.mode = portData[i].mode;
+        c.batteryType = portData[i].batteryType;
+        c.status = portData[i].status;
+        c.active = portData[i].active;
+        c.cutoff = portData[i].getCutoffVoltage();
+        c.dcir = portData[i].dcir;
+    }
+    
+    if (psramFound()) {
+        history = (LogRecord*)heap_caps_malloc(COMPRESS_PSRAM_RECORDS * sizeof(LogRecord), MALLOC_CAP_SPIRAM);
+        if (history) {
+            capacity = COMPRESS_PSRAM_RECORDS;
+            inPsram = true;
+        }
+    }
+    if (!history) {
+        history = (LogRecord*)heap_caps_malloc(COMPRESS_DRAM_RECORDS * sizeof(LogRecord), MALLOC_CAP_8BIT);
+        capacity = history ? COMPRESS_DRAM_RECORDS : 0;
+    }
+    
+    if (!history) {
+        DEBUG_PRINTLN("ERROR: Log history allocation failed");
+        return false;
+    }
+    DEBUG_PRINTF("Log history: %u records in %s\n", capacity, inPsram ? "PSRAM" : "DRAM");
+    return true;
+}
+
+// ============================================
+// SWINGING DOOR
+// ============================================
+
+void TelemetryCompressor::addSample(int port, const LogRecord& record) {
+    if (port < 0 || port >= NUM_PORTS) return;
+    
+    PortCompression& c = ports[port];
+    unsigned long now = millis();
+    samplesIn++;
+    
+    if (c.open) {
+        bool gapDue = now - c.anchorMs >= COMPRESS_MAX_GAP_MS;
+        if (!gapDue && narrowDoors(c, now, record)) {
+            // Still on the line: hold the sample until a door closes
+            c.pending = record;
+            c.pendingMs = now;
+            c.pendingValid = true;
+            return;
+        }
+        if (c.pendingValid) {
+            // The previous sample ends this segment and anchors the next
+            keep(port, c.pending);
+            openDoors(c, c.pendingMs, c.pending);
+            narrowDoors(c, now, record);    // One sample after an anchor always fits
+            c.pending = record;
+            c.pendingMs = now;
+            return;
+        }
+    }
+    
+    // First sample of a run (or a gap right after the anchor)
+    keep(port, record);
+    openDoors(c, now, record);
+    c.pendingValid = false;
+}
+
+void TelemetryCompressor::openDoors(PortCompression& c, unsigned long timeMs, const LogRecord& record) {
+    c.open = true;
+    c.anchorMs = timeMs;
+    for (int s = 0; s < SIGNAL_COUNT; s++) {
+        c.doors[s].anchor = signalValue(record, s);
+        c.doors[s].upper = FLT_MAX;
+        c.doors[s].lower = -FLT_MAX;
+    }
+}
+
+// Narrows every door to the new sample; false (doors unchanged) when any
+// signal could no longer be drawn as one line from the anchor
+bool TelemetryCompressor::narrowDoors(PortCompression& c, unsigned long timeMs, const LogRecord& record) {
+    float dt = max(1UL, timeMs - c.anchorMs);
+    float upper[SIGNAL_COUNT];
+    float lower[SIGNAL_COUNT];
+    
+    for (int s = 0; s < SIGNAL_COUNT; s++) {
+        const SwingingDoor& door = c.doors[s];
+        float delta = signalValue(record, s) - door.anchor;
+        upper[s] = min(door.upper, (delta + tolerance[s]) / dt);
+        lower[s] = max(door.lower, (delta - tolerance[s]) / dt);
+        if (lower[s] > upper[s]) return false;
+    }
+    
+    for (int s = 0; s < SIGNAL_COUNT; s++) {
+        c.doors[s].upper = upper[s];
+        c.doors[s].lower = lower[s];
+    }
+    return true;
+}
+
+void TelemetryCompressor::keep(int port, const LogRecord& record) {
+    if (history) {
+        portENTER_CRITICAL(&lock);
+        history[written % capacity] = record;
+        written++;
+        portEXIT_CRITICAL(&lock);
+    }
+    pointsKept++;
+}
+
+// Keeps the held sample so the segment ends exactly where it was left
+void TelemetryCompressor::flush(int port) {
+    PortCompression& c = ports[port];
+    if (c.pendingValid) keep(port, c.pending);
+    c.open = false;
+    c.pendingValid = false;
+}
+
+// ============================================
+// SETTINGS CHANGES (loop)
+// ============================================
+
+void TelemetryCompressor::update() {
+    for (int i = 0; i < NUM_PORTS; i++) {
+        const PortData& p = portData[i];
+        PortCompression& c = ports[i];
+        float cutoff = p.getCutoffVoltage();
+        
+        if (p.mode == c.mode && p.batteryType == c.batteryType && p.status == c.status &&
+            p.active == c.active && cutoff == c.cutoff && p.dcir == c.dcir) {
+            continue;
+        }
+        
+        // A new mode or a stop starts a fresh segment on the next sample
+        flush(i);
+        c.mode = p.mode;
+        c.batteryType = p.batteryType;
+        c.status = p.status;
+        c.active = p.active;
+        c.cutoff = cutoff;
+        c.dcir = p.dcir;
+    }
+}
+
+// ============================================
+// HISTORY DOWNLOAD (web task)
+// ============================================
+
+void TelemetryCompressor::getHistoryRange(uint32_t& first, uint32_t& count) {
+    portENTER_CRITICAL(&lock);
+    count = min((uint32_t)written, capacity);
+    first = written - count;
+    portEXIT_CRITICAL(&lock);
+}
+
+size_t TelemetryCompressor::readHistory(uint8_t* out, size_t maxLen, size_t index, uint32_t first, uint32_t count) {
+    size_t total = sizeof(LogFileHeader) + count * sizeof(LogRecord);
+    if (index >= total) return 0;
+    size_t len = min(maxLen, total - index);
+    size_t done = 0;
+    
+    if (index < sizeof(LogFileHeader)) {
+        LogFileHeader header;
+        memset(&header, 0, sizeof(header));
+        header.magic = LOG_BIN_MAGIC;
+        header.version = LOG_BIN_VERSION;
+        header.recordSize = sizeof(LogRecord);
+        done = min(len, sizeof(header) - index);
+        memcpy(out, (const uint8_t*)&header + index, done);
+    }
+    if (done == len) return len;
+    
+    size_t offset = index + done - sizeof(LogFileHeader);
+    uint32_t next = first + offset / sizeof(LogRecord);
+    bool overtaken;
+    
+    portENTER_CRITICAL(&lock);
+    overtaken = written - next > capacity;
+    while (!overtaken && done < len) {
+        size_t within = offset % sizeof(LogRecord);
+        size_t n = min(sizeof(LogRecord) - within, len - done);
+        const uint8_t* src = (const uint8_t*)&history[(first + offset / sizeof(LogRecord)) % capacity];
+        memcpy(out + done, src + within, n);
+        done += n;
+        offset += n;
+    }
+    portEXIT_CRITICAL(&lock);
+    
+    // The ring wrapped past this download: end it rather than mix in newer points
+    return overtaken ? 0 : len;
+}
+
+// ============================================
+// STATS JSON
+// ============================================
+
+void TelemetryCompressor::addStatsJSON(JsonObject out) {
+    JsonObject tol = out.createNestedObject("tolerance");
+    for (int s = 0; s < SIGNAL_COUNT; s++) {
+        tol[SIGNAL_KEYS[s]] = tolerance[s];
+    }
+    out["samples"] = samplesIn;
+    out["kept"] = pointsKept;
+    out["ratio"] = pointsKept ? (float)samplesIn / pointsKept : 0;
+    out["history"] = min((uint32_t)written, capacity);
+    out["capacity"] = capacity;
+    out["psram"] = inPsram;
+}
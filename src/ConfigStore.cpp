@@ -0,0 +1,206 @@
+#include "ConfigStore.h"
+#include <rom/crc.h>
+
+#define CONFIG_MAGIC 0x43464731  // "CFG1"
+
+static const char* CONFIG_KEY = "ports";
+
+// ============================================
+// CONSTRUCTOR
+// ============================================
+
+ConfigStore::ConfigStore(PortData* data) {
+    portData = data;
+    dirty = false;
+    lastChange = 0;
+    writerTask = nullptr;
+    lock = portMUX_INITIALIZER_UNLOCKED;
+    saveFailed = false;
+    
+    for (int i = 0; i < NUM_PORTS; i++) {
+        setDefaults(i);
+    }
+}
+
+void ConfigStore::setDefaults(int port) {
+    PortConfig& c = config[port];
+    memset(&c, 0, sizeof(PortConfig));
+    c.batteryType = LIION;
+    c.mode = SAFETY;
+    c.useCustomCutoff = 0;
+    c.customCutoff = LIION_CUTOFF;
+    c.calibration.voltageGain = 1.0f;
+    c.calibration.voltageOffset = 0.0f;
+    c.calibration.currentGain = 1.0f;
+    c.calibration.currentOffset = 0.0f;
+}
+
+// ============================================
+// LOAD
+// ============================================
+
+bool ConfigStore::begin() {
+    if (!prefs.begin(CONFIG_NAMESPACE, false)) {
+        DEBUG_PRINTLN("ERROR: Config NVS namespace open failed");
+        return false;
+    }
+    
+    // Without the writer, update() saves synchronously
+    xTaskCreatePinnedToCore(writerLoop, "config", 4096, this,
+                            CONFIG_TASK_PRIORITY, &writerTask, CONFIG_TASK_CORE);
+    
+    // Single read of header + payload (the blob is a few hundred bytes)
+    uint8_t blob[sizeof(ConfigHeader) + CONFIG_MAX_PORT_SIZE * NUM_PORTS];
+    size_t len = prefs.getBytesLength(CONFIG_KEY);
+    if (len < sizeof(ConfigHeader) || len > sizeof(blob)) {
+        DEBUG_PRINTLN("Config: no stored settings, using defaults");
+        return true;
+    }
+    prefs.getBytes(CONFIG_KEY, blob, len);
+    
+    ConfigHeader header;
+    memcpy(&header, blob, sizeof(header));
+    const uint8_t* payload = blob + sizeof(ConfigHeader);
+    size_t payloadLen = (size_t)header.portSize * header.portCount;
+    
+    if (header.magic != CONFIG_MAGIC ||
+        header.version > CONFIG_SCHEMA_VERSION ||
+        header.portSize > CONFIG_MAX_PORT_SIZE ||
+        sizeof(ConfigHeader) + payloadLen != len ||
+        crc32_le(0, payload, payloadLen) != header.crc) {
+        DEBUG_PRINTLN("WARNING: Stored config invalid, using defaults");
+        return true;
+    }
+    
+    // Older schemas are shorter: copy what exists over the defaults
+    size_t copySize = header.portSize < sizeof(PortConfig) ? header.portSize : sizeof(PortConfig);
+    for (int i = 0; i < NUM_PORTS && i < header.portCount; i++) {
+        memcpy(&config[i], payload + i * header.portSize, copySize);
+    }
+    
+    DEBUG_PRINTF("Config: loaded schema v%u (%u ports)\n", header.version, header.portCount);
+    return true;
+}
+
+void ConfigStore::apply() {
+    for (int i = 0; i < NUM_PORTS; i++) {
+        const PortConfig& c = config[i];
+        if (c.batteryType <= LIPO) {
+            portData[i].batteryType = (BatteryType)c.batteryType;
+        }
+        if (c.mode <= DISCHARGING) {
+            portData[i].mode = (OperationMode)c.mode;
+        }
+        portData[i].customCutoff = c.customCutoff;
+        portData[i].useCustomCutoff = c.useCustomCutoff != 0;
+        portData[i].active = false;
+    }
+}
+
+// ============================================
+// DEBOUNCED SAVE
+// ============================================
+
+void ConfigStore::update() {
+    unsigned long now = millis();
+    
+    if (captureChanges()) {
+        dirty = true;
+        lastChange = now;
+    }
+    
+    if (saveFailed) {
+        saveFailed = false;
+        dirty = true;
+        lastChange = now;  // Retry after another debounce period
+    }
+    
+    if (dirty && now - lastChange >= CONFIG_SAVE_DEBOUNCE_MS) {
+        dirty = false;
+        requestSave();
+    }
+}
+
+bool ConfigStore::captureChanges() {
+    bool changed = false;
+    
+    for (int i = 0; i < NUM_PORTS; i++) {
+        PortConfig& c = config[i];
+        uint8_t type = portData[i].batteryType;
+        uint8_t mode = portData[i].mode;
+        uint8_t useCustom = portData[i].useCustomCutoff ? 1 : 0;
+        
+        if (c.batteryType != type || c.mode != mode ||
+            c.useCustomCutoff != useCustom || c.customCutoff != portData[i].customCutoff) {
+            c.batteryType = type;
+            c.mode = mode;
+            c.useCustomCutoff = useCustom;
+            c.customCutoff = portData[i].customCutoff;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+void ConfigStore::requestSave() {
+    if (!writerTask) {
+        if (!save(config)) saveFailed = true;
+        return;
+    }
+    
+    portENTER_CRITICAL(&lock);
+    memcpy(outgoing, config, sizeof(outgoing));
+    portEXIT_CRITICAL(&lock);
+    
+    xTaskNotifyGive(writerTask);
+}
+
+void ConfigStore::writerLoop(void* arg) {
+    ConfigStore* self = static_cast<ConfigStore*>(arg);
+    PortConfig ports[NUM_PORTS];
+    
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        
+        // Several requests may have coalesced - write only the latest
+        portENTER_CRITICAL(&self->lock);
+        memcpy(ports, self->outgoing, sizeof(ports));
+        portEXIT_CRITICAL(&self->lock);
+        
+        if (!self->save(ports)) self->saveFailed = true;
+    }
+}
+
+bool ConfigStore::save(const PortConfig* ports) {
+    uint8_t blob[sizeof(ConfigHeader) + sizeof(config)];
+    
+    ConfigHeader header;
+    header.magic = CONFIG_MAGIC;
+    header.version = CONFIG_SCHEMA_VERSION;
+    header.portSize = sizeof(PortConfig);
+    header.portCount = NUM_PORTS;
+    header.reserved = 0;
+    header.crc = crc32_le(0, (const uint8_t*)ports, sizeof(config));
+    
+    memcpy(blob, &header, sizeof(header));
+    memcpy(blob + sizeof(header), ports, sizeof(config));
+    
+    if (prefs.putBytes(CONFIG_KEY, blob, sizeof(blob)) != sizeof(blob)) {
+        DEBUG_PRINTLN("WARNING: Config save failed");
+        return false;
+    }
+    
+    DEBUG_PRINTLN("Config saved");
+    return true;
+}
+
+// ============================================
+// CALIBRATION
+// ============================================
+
+void ConfigStore::setCalibration(int port, const PortCalibration& cal) {
+    if (port < 0 || port >= NUM_PORTS) return;
+    config[port].calibration = cal;
+    dirty = true;
+    lastChange = millis();
+}
@@ -0,0 +1,264 @@
+#include "Gateway.h"
+#include "Scheduler.h"
+
+#define TELEMETRY_MAGIC 0x5443   // "CT"
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_HEADER_SIZE offsetof(TelemetryFrame, ports)
+
+static const uint8_t BROADCAST_MAC[ESP_NOW_ETH_ALEN] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+static const char* ROLE_NAMES[] = {
+    "standalone",
+    "node",
+    "gateway"
+};
+
+volatile uint32_t GatewayLink::sendOk = 0;
+volatile uint32_t GatewayLink::sendFailed = 0;
+portMUX_TYPE GatewayLink::lock = portMUX_INITIALIZER_UNLOCKED;
+RemoteUnit GatewayLink::units[GATEWAY_MAX_UNITS];
+int GatewayLink::unitCount = 0;
+volatile uint32_t GatewayLink::rejected = 0;
+
+// ============================================
+// CONSTRUCTOR
+// ============================================
+
+GatewayLink::GatewayLink(PortData* data) {
+    portData = data;
+    ready = false;
+    sequence = 0;
+    lastSend = 0;
+    changePending = false;
+    
+    for (int i = 0; i < NUM_PORTS; i++) {
+        lastStatus[i] = IDLE;
+    }
+}
+
+// ============================================
+// INITIALIZATION
+// ============================================
+
+// Call after WiFi is up: ESP-NOW rides on the current interface and
+// channel, so every unit must end up on the same one (AP_CHANNEL, or the
+// shop router's channel when the units join it as stations)
+bool GatewayLink::begin() {
+    if (GATEWAY_ROLE == GATEWAY_ROLE_STANDALONE) return true;
+    
+    if (esp_now_init() != ESP_OK) {
+        DEBUG_PRINTLN("ERROR: ESP-NOW init failed");
+        return false;
+    }
+    
+    if (GATEWAY_ROLE == GATEWAY_ROLE_NODE) {
+        // Broadcast: no pairing, any gateway on the channel listens.
+        // Channel 0 = whatever the radio is on (the router's in STA mode).
+        esp_now_peer_info_t peer = {};
+        memcpy(peer.peer_addr, BROADCAST_MAC, ESP_NOW_ETH_ALEN);
+        peer.channel = 0;
+        peer.ifidx = NET_MODE == NET_MODE_STA ? WIFI_IF_STA : WIFI_IF_AP;
+        peer.encrypt = false;
+        if (esp_now_add_peer(&peer) != ESP_OK) {
+            DEBUG_PRINTLN("ERROR: ESP-NOW broadcast peer failed");
+            return false;
+        }
+        esp_now_register_send_cb(onSent);
+    } else {
+        esp_now_register_recv_cb(onReceive);
+    }
+    
+    ready = true;
+    DEBUG_PRINTF("Gateway link: %s\n", ROLE_NAMES[GATEWAY_ROLE]);
+    return true;
+}
+
+// ============================================
+// NODE: BATCHED TELEMETRY
+// ============================================
+
+bool GatewayLink::statusChanged() {
+    bool changed = false;
+    for (int i = 0; i < NUM_PORTS; i++) {
+        if (portData[i].status != lastStatus[i]) {
+            lastStatus[i] = portData[i].status;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+void GatewayLink::update() {
+    if (!ready || GATEWAY_ROLE != GATEWAY_ROLE_NODE) return;
+    
+    unsigned long now = millis();
+    bool periodic = Scheduler::due(SCHED_GATEWAY);
+    if (statusChanged()) changePending = true;
+    
+    // One frame covers every port; changes ride the next frame the gap allows
+    if (periodic || (changePending && now - lastSend >= GATEWAY_MIN_GAP_MS)) {
+        sendFrame(now);
+        changePending = false;
+    }
+}
+
+void GatewayLink::sendFrame(unsigned long now) {
+    TelemetryFrame frame;
+    frame.magic = TELEMETRY_MAGIC;
+    frame.version = TELEMETRY_VERSION;
+    frame.portCount = NUM_PORTS;
+    frame.sequence = ++sequence;
+    frame.uptimeSec = now / 1000;
+    
+    for (int i = 0; i < NUM_PORTS; i++) {
+        const PortData& p = portData[i];
+        TelemetryPort& t = frame.ports[i];
+        t.millivolts = (uint16_t)constrain(p.voltage * 1000.0f, 0.0f, 65535.0f);
+        t.milliamps = (int16_t)constrain(p.current * 1000.0f, -32768.0f, 32767.0f);
+        t.mAh = (uint16_t)constrain(p.mAh, 0.0f, 65535.0f);
+        t.energy10mWh = (uint16_t)constrain(p.Wh * 100.0f, 0.0f, 65535.0f);
+        t.dcirTenthMilliOhm = (uint16_t)constrain(p.dcir * 10.0f, 0.0f, 65535.0f);
+        t.state = p.status | (p.mode << 2) | (p.batteryType << 4);
+        t.flags = p.active ? 0x01 : 0x00;
+    }
+    
+    // Queued to the WiFi task; the result arrives in onSent()
+    size_t len = TELEMETRY_HEADER_SIZE + NUM_PORTS * sizeof(TelemetryPort);
+    if (esp_now_send(BROADCAST_MAC, (const uint8_t*)&frame, len) != ESP_OK) {
+        sendFailed++;
+    }
+    lastSend = now;
+}
+
+void GatewayLink::onSent(const uint8_t* mac, esp_now_send_status_t status) {
+    if (status == ESP_NOW_SEND_SUCCESS) {
+        sendOk++;
+    } else {
+        sendFailed++;
+    }
+}
+
+// ============================================
+// GATEWAY: RECEIVE (WiFi task)
+// ============================================
+
+void GatewayLink::onReceive(const uint8_t* mac, const uint8_t* data, int len) {
+    TelemetryFrame frame;
+    if (len < (int)TELEMETRY_HEADER_SIZE || len > (int)sizeof(frame)) {
+        rejected++;
+        return;
+    }
+    memcpy(&frame, data, len);
+    
+    if (frame.magic != TELEMETRY_MAGIC || frame.version != TELEMETRY_VERSION ||
+        frame.portCount < 1 || frame.portCount > GATEWAY_MAX_REMOTE_PORTS ||
+        len != (int)(TELEMETRY_HEADER_SIZE + frame.portCount * sizeof(TelemetryPort))) {
+        rejected++;
+        return;
+    }
+    
+    portENTER_CRITICAL(&lock);
+    int u = 0;
+    while (u < unitCount && memcmp(units[u].mac, mac, ESP_NOW_ETH_ALEN) != 0) u++;
+    
+    if (u == unitCount) {
+        if (unitCount == GATEWAY_MAX_UNITS) {
+            rejected++;
+            portEXIT_CRITICAL(&lock);
+            return;
+        }
+        memcpy(units[u].mac, mac, ESP_NOW_ETH_ALEN);
+        units[u].frames = 0;
+        units[u].lost = 0;
+        unitCount++;
+    }
+    
+    RemoteUnit& unit = units[u];
+    if (unit.frames > 0) {
+        // A rebooted node restarts at 1: treat backwards jumps as a resync
+        uint16_t gap = frame.sequence - unit.frame.sequence - 1;
+        if (gap < 0x8000) unit.lost += gap;
+    }
+    memcpy(&unit.frame, &frame, len);
+    unit.lastSeen = millis();
+    unit.frames++;
+    portEXIT_CRITICAL(&lock);
+}
+
+// ============================================
+// GATEWAY: JSON
+// ============================================
+
+int GatewayLink::getUnitCount() {
+    portENTER_CRITICAL(&lock);
+    int count = unitCount;
+    portEXIT_CRITICAL(&lock);
+    return count;
+}
+
+size_t GatewayLink::getJsonCapacity(int count) {
+    size_t capacity = 0;
+    for (int u = 0; u < count; u++) {
+        portENTER_CRITICAL(&lock);
+        int ports = units[u].frame.portCount;
+        portEXIT_CRITICAL(&lock);
+        capacity += JSON_REMOTE_UNIT_SIZE + ports * JSON_REMOTE_PORT_SIZE;
+    }
+    return capacity;
+}
+
+void GatewayLink::addUnitsJSON(JsonArray out, int count) {
+    unsigned long now = millis();
+    
+    for (int u = 0; u < count; u++) {
+        // Copy out so the WiFi task is never held up by JSON work
+        RemoteUnit unit;
+        portENTER_CRITICAL(&lock);
+        unit = units[u];
+        portEXIT_CRITICAL(&lock);
+        
+        char id[18];
+        snprintf(id, sizeof(id), "%02X:%02X:%02X:%02X:%02X:%02X",
+                 unit.mac[0], unit.mac[1], unit.mac[2], unit.mac[3], unit.mac[4], unit.mac[5]);
+        
+        JsonObject obj = out.createNestedObject();
+        obj["id"] = String(id);
+        obj["online"] = now - unit.lastSeen < GATEWAY_STALE_MS;
+        obj["ageMs"] = now - unit.lastSeen;
+        obj["uptime"] = unit.frame.uptimeSec;
+        obj["frames"] = unit.frames;
+        obj["lost"] = unit.lost;
+        
+        JsonArray ports = obj.createNestedArray("ports");
+        for (int i = 0; i < unit.frame.portCount; i++) {
+            const TelemetryPort& t = unit.frame.ports[i];
+            float voltage = t.millivolts / 1000.0f;
+            float current = t.milliamps / 1000.0f;
+            
+            JsonObject port = ports.createNestedObject();
+            port["voltage"] = voltage;
+            port["current"] = current;
+            port["power"] = voltage * current;
+            port["mAh"] = t.mAh;
+            port["Wh"] = t.energy10mWh / 100.0f;
+            port["mode"] = (t.state >> 2) & 0x03;
+            port["batteryType"] = (t.state >> 4) & 0x0F;
+            port["status"] = t.state & 0x03;
+            port["active"] = (t.flags & 0x01) != 0;
+            port["dcir"] = t.dcirTenthMilliOhm / 10.0f;
+        }
+    }
+}
+
+void GatewayLink::addStatsJSON(JsonObject out) {
+    out["role"] = ROLE_NAMES[GATEWAY_ROLE];
+    out["ready"] = ready;
+    if (GATEWAY_ROLE == GATEWAY_ROLE_NODE) {
+        out["sent"] = sequence;
+        out["sendOk"] = sendOk;
+        out["sendFailed"] = sendFailed;
+    } else if (GATEWAY_ROLE == GATEWAY_ROLE_GATEWAY) {
+        out["units"] = getUnitCount();
+        out["rejected"] = rejected;
+    }
+}
@@ -0,0 +1,157 @@
+#include "HeapMonitor.h"
+#include "Scheduler.h"
+#include <esp_heap_caps.h>
+
+HeapSubsystemStats HeapMonitor::subsystems[HEAP_SUBSYSTEM_COUNT];
+uint32_t HeapMonitor::minLargestBlock = UINT32_MAX;
+volatile uint32_t HeapMonitor::failedAllocs = 0;
+portMUX_TYPE HeapMonitor::lock = portMUX_INITIALIZER_UNLOCKED;
+volatile TaskHandle_t HeapMonitor::tagTasks[HEAP_TAG_SLOTS];
+int HeapMonitor::tagSubsystems[HEAP_TAG_SLOTS];
+volatile int HeapMonitor::activeTags = 0;
+
+static const char* SUBSYSTEM_NAMES[HEAP_SUBSYSTEM_COUNT] = {
+    "web_root",
+    "web_status",
+    "web_logs",
+    "web_api",
+    "ws_broadcast"
+};
+
+// ============================================
+// INITIALIZATION
+// ============================================
+
+void HeapMonitor::begin() {
+    memset(subsystems, 0, sizeof(subsystems));
+    minLargestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    heap_caps_register_failed_alloc_callback(onAllocFailed);
+}
+
+// ============================================
+// SAMPLING
+// ============================================
+
+void HeapMonitor::update() {
+    if (!Scheduler::due(SCHED_HEAP)) return;
+    
+    uint32_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    if (largest < minLargestBlock) {
+        minLargestBlock = largest;
+        
+        if (largest < HEAP_LOW_BLOCK_WARN) {
+            DEBUG_PRINTF("WARNING: Largest free block down to %u bytes\n", largest);
+        }
+    }
+}
+
+void HeapMonitor::getSnapshot(HeapSnapshot& out) {
+    out.freeHeap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    out.largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    out.minFreeHeap = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    out.minLargestBlock = out.largestBlock < minLargestBlock ? out.largestBlock : minLargestBlock;
+    out.fragmentation = out.freeHeap ? 100 - (uint8_t)((uint64_t)out.largestBlock * 100 / out.freeHeap) : 0;
+    out.failedAllocs = failedAllocs;
+}
+
+void HeapMonitor::getSubsystemStats(HeapSubsystem subsystem, HeapSubsystemStats& out) {
+    if (subsystem < 0 || subsystem >= HEAP_SUBSYSTEM_COUNT) return;
+    portENTER_CRITICAL(&lock);
+    out = subsystems[subsystem];
+    portEXIT_CRITICAL(&lock);
+}
+
+const char* HeapMonitor::getName(HeapSubsystem subsystem) {
+    if (subsystem < 0 || subsystem >= HEAP_SUBSYSTEM_COUNT) return "unknown";
+    return SUBSYSTEM_NAMES[subsystem];
+}
+
+void HeapMonitor::onAllocFailed(size_t size, uint32_t caps, const char* functionName) {
+    failedAllocs++;
+}
+
+// ============================================
+// ALLOCATION TRACKING
+// ============================================
+
+bool HeapMonitor::enter(HeapSubsystem subsystem) {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    int free = -1;
+    
+    portENTER_CRITICAL(&lock);
+    subsystems[subsystem].calls++;
+    for (int i = 0; i < HEAP_TAG_SLOTS; i++) {
+        // A nested scope keeps the outer tag
+        if (tagTasks[i] == task) {
+            portEXIT_CRITICAL(&lock);
+            return false;
+        }
+        if (tagTasks[i] == nullptr && free < 0) free = i;
+    }
+    if (free >= 0) {
+        tagTasks[free] = task;
+        tagSubsystems[free] = subsystem;
+        activeTags++;
+    }
+    portEXIT_CRITICAL(&lock);
+    
+    return free >= 0;
+}
+
+void HeapMonitor::leave() {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    
+    portENTER_CRITICAL(&lock);
+    for (int i = 0; i < HEAP_TAG_SLOTS; i++) {
+        if (tagTasks[i] == task) {
+            tagTasks[i] = nullptr;
+            activeTags--;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+void HeapMonitor::noteAlloc(size_t size) {
+    // Cheap unlocked check first - this runs on every allocation
+    if (activeTags == 0) return;
+    
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    portENTER_CRITICAL(&lock);
+    for (int i = 0; i < HEAP_TAG_SLOTS; i++) {
+        if (tagTasks[i] == task) {
+            subsystems[tagSubsystems[i]].allocs++;
+            subsystems[tagSubsystems[i]].allocBytes += size;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+// ============================================
+// MALLOC WRAPPERS
+// ============================================
+
+#if HEAP_TRACKING
+// Linked in with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc
+extern "C" {
+    void* __real_malloc(size_t size);
+    void* __real_calloc(size_t n, size_t size);
+    void* __real_realloc(void* ptr, size_t size);
+    
+    void* __wrap_malloc(size_t size) {
+        HeapMonitor::noteAlloc(size);
+        return __real_malloc(size);
+    }
+    
+    void* __wrap_calloc(size_t n, size_t size) {
+        HeapMonitor::noteAlloc(n * size);
+        return __real_calloc(n, size);
+    }
+    
+    void* __wrap_realloc(void* ptr, size_t size) {
+        HeapMonitor::noteAlloc(size);
+        return __real_realloc(ptr, size);
+    }
+}
+#endif
@@ -1,4 +1,5 @@
 #include "Logger.h"
+#include "Compressor.h"
 
 // ============================================
 // CONSTRUCTOR
@@ -6,11 +7,34 @@
 
 BatteryLogger::BatteryLogger(PortData* data) {
     portData = data;
-    lastSampleTime = 0;
+    compressor = nullptr;
+    configStore = nullptr;
+    sensorsAsleep = false;
+    sensorWakeTime = 0;
+    muxChannel = -1;
+    busOwner = nullptr;
+    nextBatch = INA226_BATCHES;
+    burstPort = -1;
+    burstActive = false;
+    burstEndTime = 0;
     
     // Initialize buffers
     for (int i = 0; i < NUM_PORTS; i++) {
+        calibration[i].voltageGain = 1.0f;
+        calibration[i].voltageOffset = 0.0f;
+        calibration[i].currentGain = 1.0f;
+        calibration[i].currentOffset = 0.0f;
+        memset(&calState[i], 0, sizeof(CalibrationState));
+        
+        lastRawVoltage[i] = 0;
+        lastRawCurrent[i] = 0;
+        dcirPhase[i] = DCIR_IDLE;
+        dcirPhaseStart[i] = 0;
+        dcirOpenVoltage[i] = 0;
+        
         bufferIndex[i] = 0;
+        filterPrimed[i] = false;
+        lastSampleUs[i] = 0;
         for (int j = 0; j < FILTER_SAMPLES; j++) {
             voltageBuffer[i][j] = 0;
             currentBuffer[i][j] = 0;
@@ -23,6 +47,7 @@ BatteryLogger::BatteryLogger(PortData* data) {
 // ============================================
 
 bool BatteryLogger::begin() {
+    busOwner = xTaskGetCurrentTaskHandle();
     Wire.begin(I2C_SDA, I2C_SCL);
     Wire.setClock(I2C_FREQ);
     DEBUG_PRINTLN("Initializing INA226 sensors...");
@@ -39,48 +64,101 @@ bool BatteryLogger::begin() {
 bool BatteryLogger::initPort(int port) {
     if (port < 0 || port >= NUM_PORTS) return false;
     
-    // Check if INA226 exists at address
-    Wire.beginTransmission(INA226_ADDR[port]);
+    // Check if INA226 exists at address (on its mux channel)
+    uint8_t address = ina226Address(port);
+    if (!selectPort(port)) {
+        DEBUG_PRINTF("Port %d: I2C mux not found at 0x%02X\n", port, I2C_MUX_ADDR);
+        portData[port].status = ERROR;
+        snprintf(portData[port].errorMsg, 64, "I2C mux not found");
+        return false;
+    }
+    Wire.beginTransmission(address);
     if (Wire.endTransmission() != 0) {
-        DEBUG_PRINTF("Port %d: INA226 not found at 0x%02X\n", port, INA226_ADDR[port]);
+        DEBUG_PRINTF("Port %d: INA226 not found at 0x%02X\n", port, address);
         portData[port].status = ERROR;
         snprintf(portData[port].errorMsg, 64, "Sensor not found");
         return false;
     }
     
     // Initialize INA226_WE with address
-    ina226[port] = INA226_WE(INA226_ADDR[port]);
+    ina226[port] = INA226_WE(address);
     ina226[port].init();
     
-    // Configure INA226_WE - Use proper enum names with INA226_ prefix
-    ina226[port].setAverage(INA226_AVERAGE_1024);
-    ina226[port].setConversionTime(INA226_CONV_TIME_1100, INA226_CONV_TIME_1100);
+    applyConversion(port, false);
     
     // Set resistor and current range (0.1 ohm, 3.2A max)
     ina226[port].setResistorRange(SHUNT_RESISTOR, MAX_CURRENT);
     
-    DEBUG_PRINTF("Port %d: INA226 initialized (0x%02X)\n", port, INA226_ADDR[port]);
+    // Per-port shunt correction goes into the INA226 calibration register
+    if (configStore) {
+        calibration[port] = configStore->getCalibration(port);
+    }
+    ina226[port].setCorrectionFactor(calibration[port].currentGain);
+    
+    DEBUG_PRINTF("Port %d: INA226 initialized (0x%02X)\n", port, address);
     return true;
 }
 
+// Routes the bus to the port's TCA9548A channel; no traffic if already there
+bool BatteryLogger::selectPort(int port) {
+    if (xTaskGetCurrentTaskHandle() != busOwner) {
+        DEBUG_PRINTF("ERROR: Port %d: I2C access outside the loop task\n", port);
+        return false;
+    }
+    
+    int channel = ina226Channel(port);
+    if (channel < 0 || channel == muxChannel) return true;
+    
+    Wire.beginTransmission(I2C_MUX_ADDR);
+    Wire.write((uint8_t)(1 << channel));
+    bool ok = Wire.endTransmission() == 0;
+    muxChannel = ok ? channel : -1;
+    return ok;
+}
+
+// Normal: 1024 x 1.1ms averaging (quiet 2Hz readings). Fast: 140us, no
+// averaging - a fresh shunt + bus pair every 280us for waveform capture.
+void BatteryLogger::applyConversion(int port, bool fast) {
+    if (fast) {
+        ina226[port].setAverage(INA226_AVERAGE_1);
+        ina226[port].setConversionTime(INA226_CONV_TIME_140, INA226_CONV_TIME_140);
+    } else {
+        ina226[port].setAverage(INA226_AVERAGE_1024);
+        ina226[port].setConversionTime(INA226_CONV_TIME_1100, INA226_CONV_TIME_1100);
+    }
+}
+
 // ============================================
 // UPDATE FUNCTIONS
 // ============================================
 
 void BatteryLogger::update() {
-    unsigned long currentTime = millis();
-    if (currentTime - lastSampleTime < SAMPLE_INTERVAL_MS) {
-        return;
+    // Each sample period starts a sweep; one batch (mux channel) per call
+    // keeps the loop pass short as ports are added
+    if (nextBatch >= INA226_BATCHES) {
+        if (!Scheduler::due(SCHED_SAMPLE)) return;
+        nextBatch = 0;
     }
+    int first = nextBatch++ * INA226_PER_CHANNEL;
+    int last = min(first + INA226_PER_CHANNEL, NUM_PORTS);
+    unsigned long currentTime = millis();
     
-    unsigned long deltaTime = currentTime - lastSampleTime;
-    lastSampleTime = currentTime;
-    
-    // Update all active ports
-    for (int i = 0; i < NUM_PORTS; i++) {
-        if (portData[i].active) {
-            updatePort(i);
+    // Update active ports in the batch (and any port being calibrated)
+    for (int i = first; i < last; i++) {
+        if (portData[i].active || calState[i].step != CAL_NONE) {
+            if (sensorsAsleep) setSensorsAsleep(false);
+            
+            // Result registers hold pre-power-down data until one full conversion
+            bool settled = millis() - sensorWakeTime >= INA226_WAKE_SETTLE_MS;
+            
+            // ...and burst data until one full averaged conversion after a capture
+            if (i == burstPort) {
+                settled = settled && !burstActive && millis() - burstEndTime >= INA226_WAKE_SETTLE_MS;
+            }
+            if (settled) updatePort(i);
         }
+        if (!portData[i].active) filterPrimed[i] = false;
+        updateDcir(i, currentTime);
     }
 }
 
@@ -89,20 +167,60 @@ void BatteryLogger::updatePort(int port) {
     if (!isPortReady(port)) return;
     
     // Read raw values from INA226_WE
-    float rawVoltage = ina226[port].getBusVoltage_V();
-    float rawCurrent = ina226[port].getCurrent_mA() / 1000.0; // Convert to A
+    float rawVoltage;
+    float rawCurrent;
+    {
+        ScopedTimer timer(PROF_I2C_INA226);
+        // Every channel answers at the same addresses: without the select
+        // the read would come from whichever channel is still open
+        if (!selectPort(port)) {
+            portData[port].i2cErrorCount++;
+            countSensorError(port, "I2C mux error");
+            return;
+        }
+        rawVoltage = ina226[port].getBusVoltage_V();
+        rawCurrent = ina226[port].getCurrent_mA() / 1000.0; // Convert to A
+    }
+    int64_t sampleUs = Scheduler::nowUs();
+    
+    if (ina226[port].getI2cErrorCode() != 0) {
+        portData[port].i2cErrorCount++;
+        countSensorError(port, "I2C error");
+        return;
+    }
+    
+    // Calibration sees readings with only the register gain applied
+    if (calState[port].step != CAL_NONE) {
+        accumulateCalibration(port, rawVoltage, rawCurrent);
+    }
+    if (!portData[port].active) return;  // Calibration-only read
+    
+    // Remaining correction (voltage gain/offset, current offset)
+    rawVoltage = rawVoltage * calibration[port].voltageGain + calibration[port].voltageOffset;
+    rawCurrent = rawCurrent + calibration[port].currentOffset;
     
     // Validate readings
     if (!validateReading(port, rawVoltage, rawCurrent)) {
-        portData[port].errorCount++;
-        if (portData[port].errorCount > 10) {
-            portData[port].status = ERROR;
-            snprintf(portData[port].errorMsg, 64, "Invalid readings");
-        }
+        portData[port].invalidCount++;
+        countSensorError(port, "Invalid readings");
         return;
     }
     
     portData[port].errorCount = 0;
+    portData[port].sampleCount++;
+    lastRawVoltage[port] = rawVoltage;
+    lastRawCurrent[port] = rawCurrent;
+    
+    // First reading of a run: flush the previous run (or the zeros) out of
+    // the filter and start integrating from now
+    if (!filterPrimed[port]) {
+        for (int j = 0; j < FILTER_SAMPLES; j++) {
+            voltageBuffer[port][j] = rawVoltage;
+            currentBuffer[port][j] = rawCurrent;
+        }
+        lastSampleUs[port] = sampleUs;
+        filterPrimed[port] = true;
+    }
     
     // Add to filter buffer
     int idx = bufferIndex[port];
@@ -120,10 +238,16 @@ void BatteryLogger::updatePort(int port) {
     portData[port].power = filteredVoltage * filteredCurrent;
     
     // Update accumulators (mAh and Wh)
-    unsigned long deltaTime = millis() - portData[port].lastUpdate;
-    updateAccumulators(port, filteredVoltage, filteredCurrent, deltaTime);
+    updateAccumulators(port, filteredVoltage, filteredCurrent, sampleUs - lastSampleUs[port]);
+    lastSampleUs[port] = sampleUs;
     portData[port].lastUpdate = millis();
     
+    if (compressor) {
+        LogRecord record;
+        getLogRecord(port, record);
+        compressor->addSample(port, record);
+    }
+    
     #if DEBUG_LOGGER
     if (millis() % 5000 < 100) { // Print every 5 seconds
         DEBUG_PRINTF("Port %d: %.3fV %.3fA %.1fmAh %.2fWh\n",
@@ -137,6 +261,19 @@ void BatteryLogger::updatePort(int port) {
 // HELPER FUNCTIONS
 // ============================================
 
+// A dead or unplugged sensor stops the run: with active cleared the port
+// stays in ERROR instead of being set back to ACTIVE by updateMOSFETs()
+void BatteryLogger::countSensorError(int port, const char* message) {
+    PortData& p = portData[port];
+    if (!p.active) return;     // Calibration-only read
+    if (++p.errorCount <= SENSOR_ERROR_LIMIT) return;
+    
+    p.status = ERROR;
+    p.active = false;
+    snprintf(p.errorMsg, 64, "%s", message);
+    DEBUG_PRINTF("Port %d: %s, stopped\n", port, message);
+}
+
 float BatteryLogger::medianFilter(float* buffer, int size) {
     float sorted[FILTER_SAMPLES];
     memcpy(sorted, buffer, size * sizeof(float));
@@ -156,11 +293,11 @@ float BatteryLogger::medianFilter(float* buffer, int size) {
     return sorted[size / 2];
 }
 
-void BatteryLogger::updateAccumulators(int port, float voltage, float current, unsigned long deltaTime) {
-    if (deltaTime == 0) return;
+void BatteryLogger::updateAccumulators(int port, float voltage, float current, int64_t deltaUs) {
+    if (deltaUs <= 0) return;
     
-    // Convert deltaTime to hours
-    float deltaHours = deltaTime / 3600000.0;
+    // Convert deltaUs to hours
+    double deltaHours = deltaUs / 3600000000.0;
     
     // Update mAh (current in A, so multiply by 1000)
     portData[port].mAh += (current * 1000.0) * deltaHours;
@@ -183,6 +320,27 @@ bool BatteryLogger::validateReading(int port, float voltage, float current) {
     return true;
 }
 
+void BatteryLogger::setSensorsAsleep(bool asleep) {
+    if (asleep == sensorsAsleep) return;
+    
+    for (int i = 0; i < NUM_PORTS; i++) {
+        if (!isPortReady(i)) continue;
+        if (!selectPort(i)) {
+            portData[i].i2cErrorCount++;
+            countSensorError(i, "I2C mux error");
+            continue;
+        }
+        if (asleep) {
+            ina226[i].powerDown();
+        } else {
+            ina226[i].powerUp();
+        }
+    }
+    sensorsAsleep = asleep;
+    if (!asleep) sensorWakeTime = millis();
+    DEBUG_PRINTF("INA226 sensors %s\n", asleep ? "powered down" : "powered up");
+}
+
 bool BatteryLogger::isPortReady(int port) {
     if (port < 0 || port >= NUM_PORTS) return false;
     return portData[port].status != ERROR;
@@ -190,8 +348,216 @@ bool BatteryLogger::isPortReady(int port) {
 
 void BatteryLogger::calibratePort(int port) {
     if (port < 0 || port >= NUM_PORTS) return;
+    if (!selectPort(port)) {
+        portData[port].i2cErrorCount++;
+        countSensorError(port, "I2C mux error");
+        return;
+    }
     ina226[port].setResistorRange(SHUNT_RESISTOR, MAX_CURRENT);
-    DEBUG_PRINTF("Port %d: Calibrated\n", port);
+    ina226[port].setCorrectionFactor(calibration[port].currentGain);
+    DEBUG_PRINTF("Port %d: Calibrated (gain %.4f)\n", port, calibration[port].currentGain);
+}
+
+// ============================================
+// BURST MODE (WAVEFORM CAPTURE)
+// ============================================
+
+bool BatteryLogger::setBurstMode(int port, bool on) {
+    if (!isPortReady(port)) return false;
+    if (on && burstActive && port != burstPort) return false;
+    if (on && sensorsAsleep) setSensorsAsleep(false);
+    
+    if (!selectPort(port)) return false;
+    applyConversion(port, on);
+    burstPort = port;
+    burstActive = on;
+    if (!on) burstEndTime = millis();
+    DEBUG_PRINTF("Port %d: burst mode %s\n", port, on ? "on" : "off");
+    return true;
+}
+
+bool BatteryLogger::readBurst(int port, float& voltage, float& current) {
+    if (!burstActive || port != burstPort) return false;
+    
+    if (!selectPort(port)) return false;
+    float rawVoltage = ina226[port].getBusVoltage_V();
+    float rawCurrent = ina226[port].getCurrent_mA() / 1000.0;
+    if (ina226[port].getI2cErrorCode() != 0) {
+        portData[port].i2cErrorCount++;
+        return false;
+    }
+    
+    voltage = rawVoltage * calibration[port].voltageGain + calibration[port].voltageOffset;
+    current = rawCurrent + calibration[port].currentOffset;
+    return true;
+}
+
+// ============================================
+// DCIR (LOAD STEP)
+// ============================================
+
+// DCIR = (V_open - V_loaded) / I_loaded, measured once at the start of a
+// fresh discharge. Includes contact and wiring resistance of the holder.
+void BatteryLogger::updateDcir(int port, unsigned long now) {
+    PortData& p = portData[port];
+    bool discharging = p.active && p.mode == DISCHARGING;
+    
+    if (!discharging) {
+        dcirPhase[port] = DCIR_IDLE;
+        return;
+    }
+    
+    switch (dcirPhase[port]) {
+        case DCIR_IDLE:
+            if (p.dcirPending) {
+                p.dcirPending = false;
+                dcirPhase[port] = DCIR_REST;
+                dcirPhaseStart[port] = now;
+            } else {
+                dcirPhase[port] = DCIR_DONE;
+            }
+            break;
+            
+        case DCIR_REST:
+            if (now - dcirPhaseStart[port] >= DCIR_REST_MS) {
+                dcirOpenVoltage[port] = lastRawVoltage[port];
+                dcirPhase[port] = DCIR_LOADED;
+                dcirPhaseStart[port] = now;
+            }
+            break;
+            
+        case DCIR_LOADED:
+            if (now - dcirPhaseStart[port] >= DCIR_SETTLE_MS) {
+                float current = lastRawCurrent[port];
+                if (current > DCIR_MIN_CURRENT) {
+                    p.dcir = (dcirOpenVoltage[port] - lastRawVoltage[port]) / current * 1000.0;
+                    DEBUG_PRINTF("Port %d: DCIR %.1f mOhm\n", port, p.dcir);
+                }
+                dcirPhase[port] = DCIR_DONE;
+            }
+            break;
+            
+        case DCIR_DONE:
+            break;
+    }
+}
+
+// ============================================
+// REFERENCE CALIBRATION
+// ============================================
+
+bool BatteryLogger::canCalibrate(int port, CalibrationStep step, float reference) const {
+    if (port < 0 || port >= NUM_PORTS || step == CAL_NONE) return false;
+    if (calState[port].step != CAL_NONE) return false;
+    
+    // Zero needs the load off; current gain needs current flowing
+    if (step == CAL_ZERO && portData[port].active) return false;
+    if (step == CAL_CURRENT && !(portData[port].active && portData[port].mode == DISCHARGING)) return false;
+    return step == CAL_ZERO || reference > 0;
+}
+
+bool BatteryLogger::startCalibration(int port, CalibrationStep step, float reference, bool referenceIsLoad) {
+    if (!canCalibrate(port, step, reference)) {
+        // Queued from the web: the port may have changed since the request
+        if (port >= 0 && port < NUM_PORTS && calState[port].step == CAL_NONE) {
+            snprintf(calState[port].result, sizeof(calState[port].result), "Port not in required state");
+        }
+        return false;
+    }
+    
+    CalibrationState& cs = calState[port];
+    cs.reference = reference;
+    cs.referenceIsLoad = referenceIsLoad;
+    cs.samples = 0;
+    cs.sumVoltage = 0;
+    cs.sumCurrent = 0;
+    snprintf(cs.result, sizeof(cs.result), "Running");
+    cs.step = step;
+    
+    DEBUG_PRINTF("Port %d: Calibration step %d started (ref %.4f)\n", port, step, reference);
+    return true;
+}
+
+void BatteryLogger::accumulateCalibration(int port, float voltage, float current) {
+    CalibrationState& cs = calState[port];
+    cs.sumVoltage += voltage;
+    cs.sumCurrent += current;
+    cs.samples++;
+    
+    if (cs.samples >= CALIBRATION_SAMPLES) {
+        finishCalibration(port);
+    }
+}
+
+void BatteryLogger::finishCalibration(int port) {
+    CalibrationState& cs = calState[port];
+    PortCalibration cal = calibration[port];
+    float meanV = cs.sumVoltage / cs.samples;
+    float meanI = cs.sumCurrent / cs.samples;
+    bool ok = false;
+    
+    switch (cs.step) {
+        case CAL_ZERO:
+            // True current is 0, so the register reading is pure offset
+            if (fabs(meanI) <= CALIBRATION_MAX_OFFSET_A) {
+                cal.currentOffset = -meanI;
+                ok = true;
+            }
+            break;
+            
+        case CAL_CURRENT: {
+            float trueI = cs.referenceIsLoad
+                ? (meanV * cal.voltageGain + cal.voltageOffset) / cs.reference
+                : cs.reference;
+            float measured = meanI;
+            if (fabs(measured) > 0.01f) {
+                // Scale the register gain so reading + offset hits the reference
+                float gain = cal.currentGain * (trueI - cal.currentOffset) / measured;
+                if (fabs(gain - 1.0f) <= CALIBRATION_MAX_GAIN_ERROR) {
+                    cal.currentGain = gain;
+                    ok = true;
+                }
+            }
+            break;
+        }
+        
+        case CAL_VOLTAGE:
+            if (meanV > 0.1f) {
+                float gain = (cs.reference - cal.voltageOffset) / meanV;
+                if (fabs(gain - 1.0f) <= CALIBRATION_MAX_GAIN_ERROR) {
+                    cal.voltageGain = gain;
+                    ok = true;
+                }
+            }
+            break;
+            
+        default:
+            break;
+    }
+    
+    if (ok) {
+        setCalibration(port, cal);
+        snprintf(cs.result, sizeof(cs.result), "OK");
+    } else {
+        snprintf(cs.result, sizeof(cs.result), "Out of range (V=%.3f I=%.4f)", meanV, meanI);
+    }
+    
+    DEBUG_PRINTF("Port %d: Calibration step %d %s\n", port, cs.step, cs.result);
+    cs.step = CAL_NONE;
+}
+
+void BatteryLogger::setCalibration(int port, const PortCalibration& cal) {
+    if (port < 0 || port >= NUM_PORTS) return;
+    
+    bool gainChanged = cal.currentGain != calibration[port].currentGain;
+    calibration[port] = cal;
+    if (gainChanged && selectPort(port)) {
+        ina226[port].setCorrectionFactor(cal.currentGain);
+    }
+    
+    if (configStore) {
+        configStore->setCalibration(port, cal);
+    }
 }
 
 // ============================================
@@ -202,6 +568,26 @@ String BatteryLogger::getCSVHeader() {
     return "Timestamp,Port,Voltage(V),Current(A),Power(W),mAh,Wh,Mode,Battery,Status\n";
 }
 
+void BatteryLogger::getLogHeader(LogFileHeader& header) {
+    memset(&header, 0, sizeof(header));
+    header.magic = LOG_BIN_MAGIC;
+    header.version = LOG_BIN_VERSION;
+    header.recordSize = sizeof(LogRecord);
+}
+
+void BatteryLogger::getLogRecord(int port, LogRecord& record) {
+    const PortData& p = portData[port];
+    record.timestamp = (millis() - p.startTime) / 1000;
+    record.port = port;
+    record.mode = p.mode;
+    record.batteryType = p.batteryType;
+    record.status = p.status;
+    record.voltage = p.voltage;
+    record.current = p.current;
+    record.mAh = p.mAh;
+    record.Wh = p.Wh;
+}
+
 String BatteryLogger::getCSVLine(int port) {
     if (port < 0 || port >= NUM_PORTS) return "";
     
@@ -0,0 +1,384 @@
+#include "Ota.h"
+#include <Preferences.h>
+#include <HTTPClient.h>
+#include <Update.h>
+#include <mbedtls/sha256.h>
+
+// Bootloader rollback needs the bootloader option; without it the boot
+// count in NVS stands in
+#if defined(CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE) || defined(CONFIG_APP_ROLLBACK_ENABLE)
+#define OTA_ROLLBACK 1
+#else
+#define OTA_ROLLBACK 0
+#endif
+
+static const char* STATE_NAMES[] = {
+    "idle",
+    "downloading",
+    "verifying",
+    "ready",
+    "failed"
+};
+
+// Arduino core hook: leave a freshly updated image pending so update()
+// confirms it after it has run, instead of the core marking it at boot
+extern "C" bool verifyRollbackLater() {
+    return true;
+}
+
+static uint8_t hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return c - 'A' + 10;
+}
+
+// ============================================
+// CONSTRUCTOR
+// ============================================
+
+OtaUpdater::OtaUpdater(PortData* data) {
+    portData = data;
+    lock = portMUX_INITIALIZER_UNLOCKED;
+    state = OTA_IDLE;
+    cancelPending = false;
+    forced = false;
+    url[0] = '\0';
+    memset(expectedHash, 0, sizeof(expectedHash));
+    received = 0;
+    total = 0;
+    result[0] = '\0';
+    readySince = 0;
+    pendingVerify = false;
+    systemUp = false;
+}
+
+// ============================================
+// INITIALIZATION
+// ============================================
+
+void OtaUpdater::begin() {
+    const esp_partition_t* running = esp_ota_get_running_partition();
+    if (!running) return;
+    
+#if OTA_ROLLBACK
+    esp_ota_img_states_t imageState;
+    if (esp_ota_get_state_partition(running, &imageState) == ESP_OK &&
+        imageState == ESP_OTA_IMG_PENDING_VERIFY) {
+        pendingVerify = true;
+    }
+#else
+    Preferences prefs;
+    if (!prefs.begin(OTA_NAMESPACE, false)) return;
+    uint32_t trial = prefs.getUInt("trial", 0);
+    uint32_t boots = prefs.getUInt("boots", 0) + 1;
+    if (trial != 0 && trial == running->address) {
+        prefs.putUInt("boots", boots);
+        pendingVerify = true;
+    } else if (trial != 0) {
+        // Cancelled, or flashed over USB: nothing on trial any more
+        prefs.clear();
+    }
+    prefs.end();
+    
+    if (pendingVerify && boots > OTA_TRIAL_BOOTS) {
+        rollBack("image never confirmed");
+        return;
+    }
+#endif
+    
+    if (pendingVerify) {
+        DEBUG_PRINTF("OTA: new image on %s, confirmed after %us up\n", running->label, OTA_CONFIRM_MS / 1000);
+    }
+}
+
+// ============================================
+// UPDATE (loop)
+// ============================================
+
+void OtaUpdater::update() {
+    unsigned long now = millis();
+    
+    // A crash, watchdog or brownout before this boots the previous image
+    // (bootloader), or counts toward OTA_TRIAL_BOOTS (NVS)
+    if (pendingVerify && now >= OTA_CONFIRM_MS) {
+        pendingVerify = false;
+        if (systemUp) {
+            confirm();
+        } else {
+            rollBack("sensors or web server not up");
+        }
+    }
+    
+    if (state != OTA_READY || now - readySince < OTA_REBOOT_DELAY_MS) return;
+    
+    // Unforced updates wait for running tests to finish
+    if (!forced && anyPortActive()) return;
+    
+    DEBUG_PRINTLN("OTA: rebooting into the new image");
+    ESP.restart();
+}
+
+void OtaUpdater::confirm() {
+#if OTA_ROLLBACK
+    if (esp_ota_mark_app_valid_cancel_rollback() != ESP_OK) {
+        DEBUG_PRINTLN("ERROR: OTA image confirm failed");
+        return;
+    }
+#else
+    clearTrial();
+#endif
+    DEBUG_PRINTLN("OTA: running image confirmed");
+}
+
+// Two app slots: the one that is not running holds the previous image
+void OtaUpdater::rollBack(const char* reason) {
+    DEBUG_PRINTF("ERROR: OTA %s, booting the previous image\n", reason);
+#if OTA_ROLLBACK
+    esp_ota_mark_app_invalid_rollback_and_reboot();
+#else
+    clearTrial();
+    const esp_partition_t* previous = esp_ota_get_next_update_partition(nullptr);
+    if (previous && esp_ota_set_boot_partition(previous) == ESP_OK) {
+        ESP.restart();
+    }
+#endif
+}
+
+bool OtaUpdater::recordTrial(const esp_partition_t* target) {
+#if OTA_ROLLBACK
+    return true;
+#else
+    Preferences prefs;
+    if (!target || !prefs.begin(OTA_NAMESPACE, false)) return false;
+    bool ok = prefs.putUInt("boots", 0) == sizeof(uint32_t) &&
+              prefs.putUInt("trial", target->address) == sizeof(uint32_t);
+    prefs.end();
+    return ok;
+#endif
+}
+
+void OtaUpdater::clearTrial() {
+#if !OTA_ROLLBACK
+    Preferences prefs;
+    if (prefs.begin(OTA_NAMESPACE, false)) {
+        prefs.clear();
+        prefs.end();
+    }
+#endif
+}
+
+bool OtaUpdater::anyPortActive() {
+    for (int i = 0; i < NUM_PORTS; i++) {
+        if (portData[i].status == ACTIVE) return true;
+    }
+    return false;
+}
+
+// ============================================
+// START / CANCEL (web task)
+// ============================================
+
+const char* OtaUpdater::start(const char* imageUrl, const char* sha256Hex, bool force) {
+    if (pendingVerify) return "Running image not yet confirmed";
+    if (!force && anyPortActive()) return "Port active (force=1 to override)";
+    
+    portENTER_CRITICAL(&lock);
+    bool busy = isBusy();
+    if (!busy) state = OTA_DOWNLOADING;
+    portEXIT_CRITICAL(&lock);
+    if (busy) return "Update already in progress";
+    
+    snprintf(url, sizeof(url), "%s", imageUrl);
+    for (int i = 0; i < 32; i++) {
+        expectedHash[i] = hexDigit(sha256Hex[i * 2]) << 4 | hexDigit(sha256Hex[i * 2 + 1]);
+    }
+    forced = force;
+    cancelPending = false;
+    received = 0;
+    total = 0;
+    finish(OTA_DOWNLOADING, "Downloading");
+    
+    if (xTaskCreatePinnedToCore(downloadTask, "ota", OTA_TASK_STACK, this,
+                                OTA_TASK_PRIORITY, nullptr, OTA_TASK_CORE) != pdPASS) {
+        finish(OTA_FAILED, "Task start failed");
+        return "Task start failed";
+    }
+    return nullptr;
+}
+
+const char* OtaUpdater::cancel() {
+    portENTER_CRITICAL(&lock);
+    OtaState current = state;
+    if (current == OTA_DOWNLOADING) cancelPending = true;
+    portEXIT_CRITICAL(&lock);
+    
+    // Update.end() may be switching the boot partition right now
+    if (current == OTA_VERIFYING) return "Verifying, try again";
+    if (current != OTA_READY) return nullptr;
+    
+    // Switched but not yet rebooted: boot this image again
+    if (esp_ota_set_boot_partition(esp_ota_get_running_partition()) != ESP_OK) {
+        return "Boot partition not restored";
+    }
+    clearTrial();
+    finish(OTA_IDLE, "Cancelled");
+    return nullptr;
+}
+
+// ============================================
+// DOWNLOAD TASK
+// ============================================
+
+void OtaUpdater::downloadTask(void* param) {
+    ((OtaUpdater*)param)->download();
+    vTaskDelete(nullptr);
+}
+
+void OtaUpdater::download() {
+    DEBUG_PRINTF("OTA: downloading %s\n", url);
+    
+    HTTPClient http;
+    http.setTimeout(OTA_HTTP_TIMEOUT_MS);
+    if (!http.begin(url)) {
+        finish(OTA_FAILED, "Invalid URL");
+        return;
+    }
+    
+    int code = http.GET();
+    int size = http.getSize();
+    if (code != HTTP_CODE_OK || size <= 0) {
+        char message[32];
+        if (code != HTTP_CODE_OK) {
+            snprintf(message, sizeof(message), "HTTP error %d", code);
+        } else {
+            snprintf(message, sizeof(message), "No Content-Length");
+        }
+        http.end();
+        finish(OTA_FAILED, message);
+        return;
+    }
+    total = size;
+    
+    // Fails when the image is larger than the inactive partition
+    if (!Update.begin(size, U_FLASH)) {
+        http.end();
+        finish(OTA_FAILED, Update.errorString());
+        return;
+    }
+    
+    mbedtls_sha256_context sha;
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0);
+    
+    uint8_t* buffer = (uint8_t*)malloc(OTA_CHUNK_SIZE);
+    const char* error = buffer ? nullptr : "Out of memory";
+    WiFiClient* stream = http.getStreamPtr();
+    unsigned long lastData = millis();
+    
+    // Update erases and writes whole sectors as they fill; the pause after
+    // each write hands the CPU and flash back to loop()
+    while (!error && received < total) {
+        if (cancelPending) {
+            error = "Cancelled";
+            break;
+        }
+        
+        size_t available = stream->available();
+        if (available == 0) {
+            if (!http.connected()) {
+                error = "Connection closed";
+            } else if (millis() - lastData >= OTA_HTTP_TIMEOUT_MS) {
+                error = "Download timed out";
+            } else {
+                vTaskDelay(pdMS_TO_TICKS(OTA_CHUNK_PAUSE_MS));
+            }
+            continue;
+        }
+        
+        size_t want = min((size_t)(total - received), (size_t)OTA_CHUNK_SIZE);
+        size_t n = stream->readBytes(buffer, min(available, want));
+        mbedtls_sha256_update(&sha, buffer, n);
+        if (Update.write(buffer, n) != n) {
+            error = Update.errorString();
+            break;
+        }
+        received += n;
+        lastData = millis();
+        vTaskDelay(pdMS_TO_TICKS(OTA_CHUNK_PAUSE_MS));
+    }
+    free(buffer);
+    http.end();
+    
+    uint8_t hash[32];
+    mbedtls_sha256_finish(&sha, hash);
+    mbedtls_sha256_free(&sha);
+    
+    // The boot partition switches in Update.end(), after the image's own
+    // header and digest check; nothing switches on a hash mismatch. The
+    // trial record goes first, so a switched image is always counted.
+    if (!error) {
+        // A cancel that came in after the last chunk still counts
+        portENTER_CRITICAL(&lock);
+        state = OTA_VERIFYING;
+        bool cancelled = cancelPending;
+        portEXIT_CRITICAL(&lock);
+        
+        if (cancelled) {
+            error = "Cancelled";
+        } else if (memcmp(hash, expectedHash, sizeof(hash)) != 0) {
+            error = "SHA-256 mismatch";
+        } else if (!recordTrial(esp_ota_get_next_update_partition(nullptr))) {
+            error = "Trial record failed";
+        } else if (!Update.end()) {
+            clearTrial();
+            error = Update.errorString();
+        }
+    }
+    
+    if (error) {
+        Update.abort();
+        finish(OTA_FAILED, error);
+        return;
+    }
+    readySince = millis();
+    finish(OTA_READY, forced ? "Rebooting" : "Rebooting once no port is active");
+}
+
+void OtaUpdater::finish(OtaState next, const char* message) {
+    portENTER_CRITICAL(&lock);
+    snprintf(result, sizeof(result), "%s", message);
+    state = next;
+    portEXIT_CRITICAL(&lock);
+    
+    if (next != OTA_DOWNLOADING) {
+        DEBUG_PRINTF("OTA: %s (%s, %u of %u bytes)\n", STATE_NAMES[next], message, received, total);
+    }
+}
+
+// ============================================
+// STATUS JSON
+// ============================================
+
+void OtaUpdater::addStatusJSON(JsonObject out) {
+    char message[sizeof(result)];
+    portENTER_CRITICAL(&lock);
+    OtaState current = state;
+    memcpy(message, result, sizeof(message));
+    portEXIT_CRITICAL(&lock);
+    
+    const esp_partition_t* running = esp_ota_get_running_partition();
+    const esp_partition_t* next = esp_ota_get_next_update_partition(nullptr);
+    const esp_app_desc_t* app = esp_ota_get_app_description();
+    
+    out["state"] = STATE_NAMES[current];
+    out["result"] = message;
+    out["received"] = received;
+    out["total"] = total;
+    out["forced"] = forced;
+    out["version"] = app->version;
+    out["built"] = String(app->date) + " " + app->time;
+    out["running"] = running ? running->label : "";
+    out["target"] = next ? next->label : "";
+    out["pendingVerify"] = pendingVerify;
+    out["rollback"] = OTA_ROLLBACK ? "bootloader" : "bootCount";
+}
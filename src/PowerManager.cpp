@@ -0,0 +1,220 @@
+#include "PowerManager.h"
+#include "Logger.h"
+#include "UI.h"
+#include "WebUI.h"
+#include "Checkpoint.h"
+#include "Ota.h"
+#include "Profiler.h"
+#include "Scheduler.h"
+
+#if CONFIG_PM_ENABLE
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#include <hal/gpio_ll.h>
+#endif
+
+TaskHandle_t PowerManager::loopTask = nullptr;
+static volatile bool inputEdge = false;
+
+static const char* STATE_NAMES[POWER_STATE_COUNT] = {
+    "active",
+    "dim",
+    "sleep"
+};
+
+// ============================================
+// CONSTRUCTOR
+// ============================================
+
+PowerManager::PowerManager(PortData* data) {
+    portData = data;
+    logger = nullptr;
+    ui = nullptr;
+    web = nullptr;
+    checkpoint = nullptr;
+    ota = nullptr;
+    
+    state = POWER_ACTIVE;
+    stateSince = 0;
+    lastActivity = 0;
+    memset(timeInState, 0, sizeof(timeInState));
+    wakeups = 0;
+}
+
+// ============================================
+// INITIALIZATION
+// ============================================
+
+void PowerManager::begin() {
+    // setup() and loop() share the Arduino loop task
+    loopTask = xTaskGetCurrentTaskHandle();
+    stateSince = millis();
+    lastActivity = stateSince;
+    applyCpuPolicy(false);
+}
+
+// ============================================
+// STATE MACHINE
+// ============================================
+
+bool PowerManager::isBusy() {
+    for (int i = 0; i < NUM_PORTS; i++) {
+        if (portData[i].active) return true;
+        if (logger && logger->isCalibrating(i)) return true;
+    }
+    // A firmware download must not stall in light sleep
+    if (ota && ota->isBusy()) return true;
+    // Keep the resume question on screen until it is answered or expires
+    return checkpoint && checkpoint->hasPendingResume();
+}
+
+void PowerManager::update() {
+    unsigned long now = millis();
+    
+    // Encoder/button edge caught by the sleep ISR (may be less than a detent)
+    bool edge = inputEdge;
+    inputEdge = false;
+    
+    unsigned long lastInput = ui ? ui->getLastInputTime() : 0;
+    if ((long)(lastInput - lastActivity) > 0) lastActivity = lastInput;
+    if (edge || isBusy()) lastActivity = now;
+    
+    // Browsing the dashboard only keeps the board out of SLEEP
+    unsigned long idleMs = now - lastActivity;
+    bool clientPresent = WiFi.softAPgetStationNum() > 0 || (web && web->hasClients());
+    
+    PowerState target = POWER_ACTIVE;
+    if (idleMs >= IDLE_SLEEP_MS && !clientPresent) {
+        target = POWER_SLEEP;
+    } else if (idleMs >= IDLE_DIM_MS) {
+        target = POWER_DIM;
+    }
+    
+    if (target != state) enterState(target, now);
+}
+
+void PowerManager::enterState(PowerState next, unsigned long now) {
+    timeInState[state] += now - stateSince;
+    PowerState previous = state;
+    state = next;
+    stateSince = now;
+    
+    if (previous == POWER_SLEEP) {
+        detachInterrupt(digitalPinToInterrupt(ENCODER_CLK));
+        detachInterrupt(digitalPinToInterrupt(ENCODER_SW));
+#if CONFIG_PM_ENABLE
+        // Woken by the timeout rather than the encoder: the pins are still
+        // level-triggered, so restore their edge types too
+        gpio_wakeup_disable((gpio_num_t)ENCODER_CLK);
+        gpio_wakeup_disable((gpio_num_t)ENCODER_SW);
+        gpio_set_intr_type((gpio_num_t)ENCODER_CLK, GPIO_INTR_ANYEDGE);
+        gpio_set_intr_type((gpio_num_t)ENCODER_SW, GPIO_INTR_NEGEDGE);
+#endif
+        applyCpuPolicy(false);
+        WiFi.setTxPower(ACTIVE_WIFI_TX_POWER);
+        if (logger) logger->setSensorsAsleep(false);
+        if (ui) ui->setDisplayOn(true);
+        wakeups++;
+    }
+    
+    switch (next) {
+        case POWER_ACTIVE:
+            if (ui) ui->setDimmed(false);
+            Scheduler::setPeriod(SCHED_OLED, UI_REFRESH_INTERVAL * 1000UL);
+            break;
+    
+        case POWER_DIM:
+            if (ui) ui->setDimmed(true);
+            Scheduler::setPeriod(SCHED_OLED, IDLE_OLED_REFRESH_MS * 1000UL);
+            break;
+    
+        case POWER_SLEEP:
+            if (ui) ui->setDisplayOn(false);
+            if (logger) logger->setSensorsAsleep(true);
+            // Station and ESP-NOW links keep full power to reach the router / gateway
+            if (NET_MODE == NET_MODE_AP && GATEWAY_ROLE == GATEWAY_ROLE_STANDALONE) {
+                WiFi.setTxPower(IDLE_WIFI_TX_POWER);
+            }
+            applyCpuPolicy(true);
+    
+            // PCNT keeps counting at 80 MHz APB; the ISR only ends the loop wait
+            inputEdge = false;
+            attachInterrupt(digitalPinToInterrupt(ENCODER_CLK), onInputEdge, CHANGE);
+            attachInterrupt(digitalPinToInterrupt(ENCODER_SW), onInputEdge, FALLING);
+#if CONFIG_PM_ENABLE
+            // Light sleep (tickless idle builds) ends on the next encoder level change
+            gpio_wakeup_enable((gpio_num_t)ENCODER_CLK,
+                               digitalRead(ENCODER_CLK) ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+            gpio_wakeup_enable((gpio_num_t)ENCODER_SW, GPIO_INTR_LOW_LEVEL);
+            esp_sleep_enable_gpio_wakeup();
+#endif
+            break;
+    
+        default:
+            break;
+    }
+    
+    DEBUG_PRINTF("Power: %s -> %s\n", getStateName(previous), getStateName(next));
+}
+
+// DFS + automatic light sleep when the IDF power manager is built in,
+// otherwise a plain clock switch
+void PowerManager::applyCpuPolicy(bool idle) {
+#if CONFIG_PM_ENABLE
+    esp_pm_config_esp32_t pm = {};
+    pm.max_freq_mhz = idle ? IDLE_CPU_MHZ : ACTIVE_CPU_MHZ;
+    pm.min_freq_mhz = IDLE_CPU_MHZ;
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    pm.light_sleep_enable = idle;
+#endif
+    esp_pm_configure(&pm);
+#else
+    setCpuFrequencyMhz(idle ? IDLE_CPU_MHZ : ACTIVE_CPU_MHZ);
+#endif
+    Profiler::setCpuFrequency(getCpuFrequencyMhz());
+}
+
+// ============================================
+// LOOP WAIT
+// ============================================
+
+void IRAM_ATTR PowerManager::onInputEdge() {
+#if CONFIG_PM_ENABLE
+    // gpio_wakeup_enable() switched both pins to level triggering, which
+    // refires this ISR while the level holds; back to the attachInterrupt()
+    // edges until the next sleep (register write, IRAM-safe)
+    gpio_ll_set_intr_type(&GPIO, (gpio_num_t)ENCODER_CLK, GPIO_INTR_ANYEDGE);
+    gpio_ll_set_intr_type(&GPIO, (gpio_num_t)ENCODER_SW, GPIO_INTR_NEGEDGE);
+#endif
+    inputEdge = true;
+    BaseType_t woken = pdFALSE;
+    if (loopTask) vTaskNotifyGiveFromISR(loopTask, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void PowerManager::idleWait() {
+    if (state == POWER_SLEEP) {
+        // Idle task runs (and may light-sleep) until timeout or encoder edge
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(IDLE_LOOP_WAIT_MS));
+    } else {
+        // Small delay to prevent watchdog timeout
+        delay(10);
+    }
+}
+
+// ============================================
+// STATISTICS
+// ============================================
+
+const char* PowerManager::getStateName(PowerState s) {
+    if (s < 0 || s >= POWER_STATE_COUNT) return "?";
+    return STATE_NAMES[s];
+}
+
+uint32_t PowerManager::getTimeInState(PowerState s) {
+    if (s < 0 || s >= POWER_STATE_COUNT) return 0;
+    uint32_t total = timeInState[s];
+    if (s == state) total += millis() - stateSince;
+    return total;
+}
@@ -0,0 +1,154 @@
+#include "Profiler.h"
+
+ProfileStats Profiler::stats[PROF_COUNT];
+uint32_t Profiler::cyclesPerUs = 240;
+portMUX_TYPE Profiler::lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char* SLOT_NAMES[PROF_COUNT] = {
+    "loop",
+    "logger",
+    "mosfet",
+    "physical_ui",
+    "web_ui",
+    "i2c_ina226",
+    "i2c_oled",
+    "json"
+};
+
+static const char* SLOT_SHORT_NAMES[PROF_COUNT] = {
+    "loop",
+    "logger",
+    "mosfet",
+    "oledui",
+    "webui",
+    "ina226",
+    "oled",
+    "json"
+};
+
+// ============================================
+// INITIALIZATION
+// ============================================
+
+void Profiler::begin() {
+    cyclesPerUs = ESP.getCpuFreqMHz();
+    if (cyclesPerUs == 0) cyclesPerUs = 240;
+    reset();
+}
+
+// CCOUNT ticks at the CPU clock; samples already taken keep their old scale
+void Profiler::setCpuFrequency(uint32_t mhz) {
+    if (mhz) cyclesPerUs = mhz;
+}
+
+void Profiler::reset() {
+    portENTER_CRITICAL(&lock);
+    for (int i = 0; i < PROF_COUNT; i++) {
+        memset(&stats[i], 0, sizeof(ProfileStats));
+        stats[i].minCycles = UINT32_MAX;
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+// ============================================
+// RECORDING
+// ============================================
+
+void Profiler::record(ProfileSlot slot, uint32_t cycles) {
+    if (slot < 0 || slot >= PROF_COUNT) return;
+    
+    int bucket = bucketForUs(cycles / cyclesPerUs);
+    
+    portENTER_CRITICAL(&lock);
+    ProfileStats& s = stats[slot];
+    s.count++;
+    s.totalCycles += cycles;
+    if (cycles < s.minCycles) s.minCycles = cycles;
+    if (cycles > s.maxCycles) s.maxCycles = cycles;
+    s.histogram[bucket]++;
+    portEXIT_CRITICAL(&lock);
+}
+
+void Profiler::getSnapshot(ProfileSlot slot, ProfileStats& out) {
+    if (slot < 0 || slot >= PROF_COUNT) return;
+    portENTER_CRITICAL(&lock);
+    memcpy(&out, &stats[slot], sizeof(ProfileStats));
+    portEXIT_CRITICAL(&lock);
+}
+
+// ============================================
+// STATISTICS
+// ============================================
+
+const char* Profiler::getName(ProfileSlot slot) {
+    if (slot < 0 || slot >= PROF_COUNT) return "unknown";
+    return SLOT_NAMES[slot];
+}
+
+const char* Profiler::getShortName(ProfileSlot slot) {
+    if (slot < 0 || slot >= PROF_COUNT) return "?";
+    return SLOT_SHORT_NAMES[slot];
+}
+
+uint32_t Profiler::cyclesToUs(uint64_t cycles) {
+    return (uint32_t)(cycles / cyclesPerUs);
+}
+
+double Profiler::cyclesToSeconds(uint64_t cycles) {
+    return (double)cycles / cyclesPerUs / 1000000.0;
+}
+
+uint32_t Profiler::getAverageUs(const ProfileStats& s) {
+    if (s.count == 0) return 0;
+    return cyclesToUs(s.totalCycles / s.count);
+}
+
+uint32_t Profiler::getPercentileUs(const ProfileStats& s, float percentile) {
+    if (s.count == 0) return 0;
+    
+    uint32_t target = (uint32_t)(s.count * percentile / 100.0f + 0.5f);
+    if (target == 0) target = 1;
+    
+    uint32_t seen = 0;
+    for (int i = 0; i < PROFILE_BUCKETS; i++) {
+        seen += s.histogram[i];
+        if (seen >= target) {
+            // Never report more than the observed maximum
+            uint32_t upper = bucketUpperUs(i);
+            uint32_t maxUs = cyclesToUs(s.maxCycles);
+            return upper < maxUs ? upper : maxUs;
+        }
+    }
+    return cyclesToUs(s.maxCycles);
+}
+
+// ============================================
+// HISTOGRAM BUCKETS
+// ============================================
+
+int Profiler::bucketForUs(uint32_t us) {
+    if (us < 4) return us;
+    
+    int msb = 31 - __builtin_clz(us);
+    int sub = (us >> (msb - 2)) & 3;
+    int bucket = (msb - 1) * 4 + sub;
+    return bucket < PROFILE_BUCKETS ? bucket : PROFILE_BUCKETS - 1;
+}
+
+uint32_t Profiler::bucketUpperUs(int bucket) {
+    if (bucket < 4) return bucket + 1;
+    
+    int msb = bucket / 4 + 1;
+    int sub = bucket % 4;
+    return (uint32_t)(4 + sub + 1) << (msb - 2);
+}
+
+uint32_t Profiler::countAtOrBelowUs(const ProfileStats& s, uint32_t us) {
+    // Exact when 'us' is a bucket boundary (e.g. any power of two >= 4)
+    uint32_t total = 0;
+    for (int i = 0; i < PROFILE_BUCKETS; i++) {
+        if (bucketUpperUs(i) > us) break;
+        total += s.histogram[i];
+    }
+    return total;
+}
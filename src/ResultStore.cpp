@@ -0,0 +1,240 @@
+#include "ResultStore.h"
+
+// ============================================
+// CONSTRUCTOR
+// ============================================
+
+ResultStore::ResultStore(PortData* data) {
+    portData = data;
+    ready = false;
+    mutex = xSemaphoreCreateMutex();
+    index = nullptr;
+    count = 0;
+    nextId = 1;
+}
+
+// ============================================
+// INITIALIZATION
+// ============================================
+
+bool ResultStore::begin() {
+    if (!LittleFS.begin(true)) {
+        DEBUG_PRINTLN("ERROR: LittleFS mount failed");
+        return false;
+    }
+    
+    // Fixed allocation at boot - never resized, so it can't fragment the heap
+    index = (CapacityIndexEntry*)malloc(sizeof(CapacityIndexEntry) * RESULT_MAX_RECORDS);
+    if (!index) return false;
+    
+    dropPartialRecord();
+    
+    File file = LittleFS.open(RESULT_FILE, FILE_READ);
+    if (file) {
+        CellResult rec;
+        uint16_t record = 0;
+        while (record < RESULT_MAX_RECORDS &&
+               file.read((uint8_t*)&rec, sizeof(rec)) == sizeof(rec)) {
+            insertIndex((uint16_t)constrain(rec.capacityMah, 0.0f, 65535.0f), record++);
+            if (rec.id >= nextId) nextId = rec.id + 1;
+        }
+        file.close();
+    }
+    
+    ready = true;
+    DEBUG_PRINTF("Result store: %u cells indexed\n", count);
+    return true;
+}
+
+// ============================================
+// APPEND
+// ============================================
+
+bool ResultStore::recordCompletion(int port) {
+    if (!ready || port < 0 || port >= NUM_PORTS) return false;
+    if (count >= RESULT_MAX_RECORDS) {
+        DEBUG_PRINTLN("WARNING: Result store full");
+        return false;
+    }
+    
+    const PortData& p = portData[port];
+    CellResult rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.id = nextId;
+    strlcpy(rec.label, p.cellLabel, sizeof(rec.label));
+    rec.capacityMah = p.mAh;
+    rec.energyWh = p.Wh;
+    rec.durationSec = (millis() - p.startTime) / 1000;
+    rec.dcirTenthMilliOhm = (uint16_t)constrain(p.dcir * 10.0f, 0.0f, 65535.0f);
+    rec.batteryType = p.batteryType;
+    rec.port = port;
+    
+    // Held from the append to the index insert: a clear() in between would
+    // remove the file and leave the index pointing past its end
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    File file = LittleFS.open(RESULT_FILE, FILE_APPEND);
+    if (!file) {
+        xSemaphoreGive(mutex);
+        return false;
+    }
+    size_t written = file.write((const uint8_t*)&rec, sizeof(rec));
+    file.close();
+    if (written != sizeof(rec)) {
+        dropPartialRecord();
+        xSemaphoreGive(mutex);
+        return false;
+    }
+    insertIndex((uint16_t)constrain(rec.capacityMah, 0.0f, 65535.0f), count);
+    xSemaphoreGive(mutex);
+    nextId++;
+    
+    // Label belongs to the cell that just finished
+    portData[port].cellLabel[0] = '\0';
+    
+    DEBUG_PRINTF("Port %d: Result #%u stored (%.0f mAh)\n", port, rec.id, rec.capacityMah);
+    return true;
+}
+
+// A power loss or full flash mid-append leaves a partial record at the
+// end. Every later append would then be misaligned, so rewrite the file
+// without it; the rename replaces the old file atomically.
+void ResultStore::dropPartialRecord() {
+    File file = LittleFS.open(RESULT_FILE, FILE_READ);
+    if (!file) return;
+    size_t size = file.size();
+    size_t keep = size - size % sizeof(CellResult);
+    if (keep == size) {
+        file.close();
+        return;
+    }
+    
+    File out = LittleFS.open(RESULT_TMP_FILE, FILE_WRITE);
+    bool ok = out;
+    uint8_t buffer[sizeof(CellResult)];
+    for (size_t done = 0; ok && done < keep; done += sizeof(buffer)) {
+        ok = file.read(buffer, sizeof(buffer)) == sizeof(buffer) &&
+             out.write(buffer, sizeof(buffer)) == sizeof(buffer);
+    }
+    file.close();
+    if (out) out.close();
+    
+    if (ok && LittleFS.rename(RESULT_TMP_FILE, RESULT_FILE)) {
+        DEBUG_PRINTF("Result store: dropped %u-byte partial record\n", (unsigned)(size - keep));
+    } else {
+        LittleFS.remove(RESULT_TMP_FILE);
+        DEBUG_PRINTLN("WARNING: Result store partial record not removed");
+    }
+}
+
+bool ResultStore::readRecord(uint16_t record, CellResult& out) {
+    if (!ready || record >= count) return false;
+    
+    File file = LittleFS.open(RESULT_FILE, FILE_READ);
+    if (!file) return false;
+    bool ok = file.seek((uint32_t)record * sizeof(CellResult)) &&
+              file.read((uint8_t*)&out, sizeof(out)) == sizeof(out);
+    file.close();
+    return ok;
+}
+
+bool ResultStore::clear() {
+    if (!ready) return false;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    LittleFS.remove(RESULT_FILE);
+    count = 0;
+    xSemaphoreGive(mutex);
+    return true;
+}
+
+// ============================================
+// CAPACITY INDEX
+// ============================================
+
+int ResultStore::lowerBound(uint16_t capacity) const {
+    int lo = 0;
+    int hi = count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (index[mid].capacityMah < capacity) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+void ResultStore::insertIndex(uint16_t capacity, uint16_t record) {
+    // Insert after equal capacities so ties stay in append order
+    int pos = lowerBound(capacity);
+    while (pos < count && index[pos].capacityMah == capacity) pos++;
+    
+    memmove(&index[pos + 1], &index[pos], (count - pos) * sizeof(CapacityIndexEntry));
+    index[pos].capacityMah = capacity;
+    index[pos].record = record;
+    count++;
+}
+
+uint16_t ResultStore::countInRange(uint16_t minMah, uint16_t maxMah) {
+    if (!ready || minMah > maxMah) return 0;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    int first = lowerBound(minMah);
+    int last = maxMah == 0xFFFF ? count : lowerBound(maxMah + 1);
+    xSemaphoreGive(mutex);
+    return last - first;
+}
+
+uint16_t ResultStore::query(uint16_t minMah, uint16_t maxMah, uint16_t limit,
+                            void (*visitor)(const CellResult&, void*), void* ctx) {
+    if (!ready || minMah > maxMah) return 0;
+    
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    int first = lowerBound(minMah);
+    int last = maxMah == 0xFFFF ? count : lowerBound(maxMah + 1);
+    
+    File file = LittleFS.open(RESULT_FILE, FILE_READ);
+    if (!file) {
+        xSemaphoreGive(mutex);
+        return 0;
+    }
+    
+    uint16_t matched = 0;
+    CellResult rec;
+    for (int i = first; i < last && matched < limit; i++) {
+        if (!file.seek((uint32_t)index[i].record * sizeof(CellResult))) break;
+        if (file.read((uint8_t*)&rec, sizeof(rec)) != sizeof(rec)) break;
+        visitor(rec, ctx);
+        matched++;
+    }
+    file.close();
+    xSemaphoreGive(mutex);
+    return matched;
+}
+
+int ResultStore::getBins(int offset, uint16_t* binStart, uint16_t* binCount, int maxBins) {
+    if (!ready) return 0;
+    
+    int bins = 0;
+    int skipped = 0;
+    int i = 0;
+    
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    
+    // Index is sorted, so each bin is one contiguous run
+    while (i < count && bins < maxBins) {
+        uint16_t start = index[i].capacityMah / RESULT_BIN_WIDTH_MAH * RESULT_BIN_WIDTH_MAH;
+        uint32_t end = (uint32_t)start + RESULT_BIN_WIDTH_MAH;
+        int runEnd = end > 0xFFFF ? count : lowerBound(end);
+        
+        if (skipped >= offset) {
+            binStart[bins] = start;
+            binCount[bins] = runEnd - i;
+            bins++;
+        } else {
+            skipped++;
+        }
+        i = runEnd;
+    }
+    xSemaphoreGive(mutex);
+    return bins;
+}
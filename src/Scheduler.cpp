@@ -0,0 +1,78 @@
+#include "Scheduler.h"
+
+int64_t Scheduler::deadlines[SCHED_COUNT];
+ScheduleStats Scheduler::stats[SCHED_COUNT];
+
+static const uint32_t DEFAULT_PERIOD_MS[SCHED_COUNT] = {
+    SAMPLE_INTERVAL_MS,
+    WS_UPDATE_INTERVAL,
+    UI_REFRESH_INTERVAL,
+    UI_SYNC_INTERVAL_MS,
+    HEAP_SAMPLE_INTERVAL_MS,
+    STATUS_PRINT_INTERVAL_MS,
+    GATEWAY_REPORT_INTERVAL_MS
+};
+
+static const char* SLOT_NAMES[SCHED_COUNT] = {
+    "sample",
+    "ws_push",
+    "oled",
+    "ui_sync",
+    "heap",
+    "status_print",
+    "gateway"
+};
+
+// ============================================
+// INITIALIZATION
+// ============================================
+
+void Scheduler::begin() {
+    int64_t now = nowUs();
+    for (int i = 0; i < SCHED_COUNT; i++) {
+        memset(&stats[i], 0, sizeof(ScheduleStats));
+        stats[i].periodUs = DEFAULT_PERIOD_MS[i] * 1000UL;
+        deadlines[i] = now + stats[i].periodUs;
+    }
+}
+
+// ============================================
+// DEADLINES
+// ============================================
+
+bool Scheduler::due(ScheduleSlot slot, int64_t now) {
+    if (slot < 0 || slot >= SCHED_COUNT) return false;
+    if (now < deadlines[slot]) return false;
+    
+    ScheduleStats& s = stats[slot];
+    int64_t late = now - deadlines[slot];
+    
+    // Skip periods that passed entirely; keep the phase of the grid
+    uint32_t missed = (uint32_t)(late / s.periodUs);
+    deadlines[slot] += (int64_t)(missed + 1) * s.periodUs;
+    
+    s.runs++;
+    s.skipped += missed;
+    uint32_t lateUs = (uint32_t)(late - (int64_t)missed * s.periodUs);
+    if (lateUs > s.maxLateUs) s.maxLateUs = lateUs;
+    return true;
+}
+
+void Scheduler::setPeriod(ScheduleSlot slot, uint32_t periodUs) {
+    if (slot < 0 || slot >= SCHED_COUNT || periodUs == 0) return;
+    stats[slot].periodUs = periodUs;
+}
+
+// ============================================
+// STATISTICS
+// ============================================
+
+void Scheduler::getStats(ScheduleSlot slot, ScheduleStats& out) {
+    if (slot < 0 || slot >= SCHED_COUNT) return;
+    out = stats[slot];
+}
+
+const char* Scheduler::getName(ScheduleSlot slot) {
+    if (slot < 0 || slot >= SCHED_COUNT) return "unknown";
+    return SLOT_NAMES[slot];
+}
@@ -1,7 +1,10 @@
 #include "UI.h"
 
-// Static instance for ISR
-PhysicalUI* PhysicalUI::instance = nullptr;
+static const char* MODE_NAMES[] = {
+    "Safety",
+    "Charging",
+    "Discharging"
+};
 
 // ============================================
 // CONSTRUCTOR
@@ -9,27 +12,38 @@ PhysicalUI* PhysicalUI::instance = nullptr;
 
 PhysicalUI::PhysicalUI(PortData* data) {
     portData = data;
+    checkpoint = nullptr;
+    results = nullptr;
+    commands = nullptr;
     display = new Adafruit_SSD1306(OLED_WIDTH, OLED_HEIGHT, &Wire, OLED_RESET);
     
     currentMenu = MENU_MAIN;
     selectedPort = 0;
     menuIndex = 0;
-    maxMenuIndex = 0;
+    minMenuIndex = 0;
+    maxMenuIndex = MAIN_PAGES - 1;
     lastMenuActivity = 0;
+    lastPageFlip = 0;
+    memset(&wizard, 0, sizeof(wizard));
     
     encoderPos = 0;
     lastEncoderPos = 0;
+    lastPcntCount = 0;
+    encoderRemainder = 0;
+    lastDetentTime = 0;
+    encoderStepMultiplier = 1;
+    
     buttonPressed = false;
-    lastButtonPress = 0;
+    buttonLongPressed = false;
+    buttonStableState = HIGH;
+    buttonLastReading = HIGH;
+    longPressFired = false;
+    lastButtonChange = 0;
+    buttonDownTime = 0;
     
-    lastRefresh = 0;
     displayNeedsUpdate = true;
-    
-    currentBeep = BEEP_NONE;
-    beepStartTime = 0;
-    beepActive = false;
-    
-    instance = this;
+    displayOn = true;
+    displayDimmed = false;
 }
 
 // ============================================
@@ -51,18 +65,19 @@ bool PhysicalUI::begin() {
     display->println("Initializing...");
     display->display();
     
-    // Initialize Rotary Encoder
+    // Initialize Rotary Encoder (no GPIO interrupts - decoded by PCNT)
     pinMode(ENCODER_CLK, INPUT_PULLUP);
     pinMode(ENCODER_DT, INPUT_PULLUP);
     pinMode(ENCODER_SW, INPUT_PULLUP);
     
-    attachInterrupt(digitalPinToInterrupt(ENCODER_CLK), handleEncoderA, CHANGE);
-    attachInterrupt(digitalPinToInterrupt(ENCODER_DT), handleEncoderB, CHANGE);
-    attachInterrupt(digitalPinToInterrupt(ENCODER_SW), handleButton, FALLING);
+    if (!initEncoder()) {
+        DEBUG_PRINTLN("WARNING: PCNT encoder init failed");
+    }
     
     // Initialize Buzzer
-    pinMode(BUZZER_PIN, OUTPUT);
-    digitalWrite(BUZZER_PIN, LOW);
+    if (!buzzer.begin()) {
+        DEBUG_PRINTLN("WARNING: Buzzer sequencer init failed");
+    }
     
     // Play startup beep
     playBeep(BEEP_SELECT);
@@ -72,34 +87,109 @@ bool PhysicalUI::begin() {
 }
 
 // ============================================
-// ISR HANDLERS
+// ENCODER / BUTTON INPUT
 // ============================================
 
-void IRAM_ATTR PhysicalUI::handleEncoderA() {
-    if (instance) {
-        int clk = digitalRead(ENCODER_CLK);
-        int dt = digitalRead(ENCODER_DT);
-        
-        if (clk == dt) {
-            instance->encoderPos++;
-        } else {
-            instance->encoderPos--;
-        }
+bool PhysicalUI::initEncoder() {
+    // Full x4 quadrature decoding: each channel counts both edges of one
+    // signal and uses the level of the other signal as direction.
+    pcnt_config_t config = {};
+    config.unit = ENCODER_PCNT_UNIT;
+    config.counter_h_lim = ENCODER_PCNT_LIMIT;
+    config.counter_l_lim = -ENCODER_PCNT_LIMIT;
+    
+    // Channel 0: edges on CLK, direction from DT
+    config.channel = PCNT_CHANNEL_0;
+    config.pulse_gpio_num = ENCODER_CLK;
+    config.ctrl_gpio_num = ENCODER_DT;
+    config.pos_mode = PCNT_COUNT_INC;
+    config.neg_mode = PCNT_COUNT_DEC;
+    config.lctrl_mode = PCNT_MODE_REVERSE;
+    config.hctrl_mode = PCNT_MODE_KEEP;
+    if (pcnt_unit_config(&config) != ESP_OK) return false;
+    
+    // Channel 1: edges on DT, direction from CLK
+    config.channel = PCNT_CHANNEL_1;
+    config.pulse_gpio_num = ENCODER_DT;
+    config.ctrl_gpio_num = ENCODER_CLK;
+    config.pos_mode = PCNT_COUNT_INC;
+    config.neg_mode = PCNT_COUNT_DEC;
+    config.lctrl_mode = PCNT_MODE_KEEP;
+    config.hctrl_mode = PCNT_MODE_REVERSE;
+    if (pcnt_unit_config(&config) != ESP_OK) return false;
+    
+    // Hardware glitch filter replaces software debounce on the encoder
+    pcnt_set_filter_value(ENCODER_PCNT_UNIT, ENCODER_GLITCH_FILTER);
+    pcnt_filter_enable(ENCODER_PCNT_UNIT);
+    
+    pcnt_counter_pause(ENCODER_PCNT_UNIT);
+    pcnt_counter_clear(ENCODER_PCNT_UNIT);
+    pcnt_counter_resume(ENCODER_PCNT_UNIT);
+    
+    lastPcntCount = 0;
+    encoderRemainder = 0;
+    return true;
+}
+
+int PhysicalUI::readEncoderDetents() {
+    int16_t count = 0;
+    if (pcnt_get_counter_value(ENCODER_PCNT_UNIT, &count) != ESP_OK) {
+        return 0;
     }
+    
+    // Counter resets to 0 when it hits a limit - unwrap the jump
+    int delta = count - lastPcntCount;
+    if (delta > ENCODER_PCNT_LIMIT / 2) delta -= ENCODER_PCNT_LIMIT;
+    if (delta < -ENCODER_PCNT_LIMIT / 2) delta += ENCODER_PCNT_LIMIT;
+    lastPcntCount = count;
+    
+    // Only report whole detents, keep partial steps for next poll
+    encoderRemainder += delta;
+    int detents = encoderRemainder / ENCODER_COUNTS_PER_DETENT;
+    encoderRemainder -= detents * ENCODER_COUNTS_PER_DETENT;
+    return detents;
 }
 
-void IRAM_ATTR PhysicalUI::handleEncoderB() {
-    // Handled by handleEncoderA
+void PhysicalUI::updateAcceleration(int detents, unsigned long now) {
+    // Average time per detent since the previous movement
+    unsigned long gap = (now - lastDetentTime) / abs(detents);
+    lastDetentTime = now;
+    
+    if (gap < ENCODER_ACCEL_FAST_MS) {
+        encoderStepMultiplier = ENCODER_ACCEL_FAST_STEP;
+    } else if (gap < ENCODER_ACCEL_MEDIUM_MS) {
+        encoderStepMultiplier = ENCODER_ACCEL_MEDIUM_STEP;
+    } else {
+        encoderStepMultiplier = 1;
+    }
 }
 
-void IRAM_ATTR PhysicalUI::handleButton() {
-    if (instance) {
-        unsigned long now = millis();
-        if (now - instance->lastButtonPress > ENCODER_DEBOUNCE) {
-            instance->buttonPressed = true;
-            instance->lastButtonPress = now;
+void PhysicalUI::pollButton(unsigned long now) {
+    bool reading = digitalRead(ENCODER_SW);
+    
+    if (reading != buttonLastReading) {
+        buttonLastReading = reading;
+        lastButtonChange = now;
+    }
+    
+    // Accept new state once it has been stable for the debounce time
+    if (reading != buttonStableState && now - lastButtonChange >= ENCODER_DEBOUNCE) {
+        buttonStableState = reading;
+        if (buttonStableState == LOW) {
+            buttonDownTime = now;
+            longPressFired = false;
+        } else if (!longPressFired) {
+            // Short press fires on release so it can't collide with a hold
+            buttonPressed = true;
         }
     }
+    
+    // Long press fires while still held
+    if (buttonStableState == LOW && !longPressFired &&
+        now - buttonDownTime >= PERF_PAGE_HOLD_MS) {
+        longPressFired = true;
+        buttonLongPressed = true;
+    }
 }
 
 // ============================================
@@ -109,8 +199,22 @@ void IRAM_ATTR PhysicalUI::handleButton() {
 void PhysicalUI::update() {
     unsigned long currentTime = millis();
     
-    // Update buzzer
-    updateBuzzer();
+    // Poll inputs
+    int detents = readEncoderDetents();
+    if (detents != 0) {
+        updateAcceleration(detents, currentTime);
+        encoderPos += detents;
+    }
+    pollButton(currentTime);
+    
+    // First input after the panel was switched off only wakes it
+    if (!displayOn && (encoderPos != lastEncoderPos || buttonPressed || buttonLongPressed)) {
+        encoderPos = lastEncoderPos;
+        buttonPressed = false;
+        buttonLongPressed = false;
+        lastMenuActivity = currentTime;
+        setDisplayOn(true);
+    }
     
     // Check for encoder changes
     if (encoderPos != lastEncoderPos) {
@@ -128,6 +232,29 @@ void PhysicalUI::update() {
         displayNeedsUpdate = true;
     }
     
+    if (buttonLongPressed) {
+        buttonLongPressed = false;
+        handleLongPress();
+        lastMenuActivity = currentTime;
+        displayNeedsUpdate = true;
+    }
+    
+    // Resume offer withdrawn (answered via web or expired)
+    if (currentMenu == MENU_RESUME &&
+        (checkpoint == nullptr || !checkpoint->hasPendingResume())) {
+        returnToMain();
+        displayNeedsUpdate = true;
+    }
+    
+    // Main screen pages through the ports by itself while the knob is idle
+    if (currentMenu == MENU_MAIN && MAIN_PAGES > 1 &&
+        currentTime - lastMenuActivity >= MAIN_PAGE_CYCLE_MS &&
+        currentTime - lastPageFlip >= MAIN_PAGE_CYCLE_MS) {
+        menuIndex = (menuIndex + 1) % MAIN_PAGES;
+        lastPageFlip = currentTime;
+        displayNeedsUpdate = true;
+    }
+    
     // Menu timeout - return to main
     if (currentMenu != MENU_MAIN && 
         currentTime - lastMenuActivity > MENU_TIMEOUT) {
@@ -135,8 +262,9 @@ void PhysicalUI::update() {
         displayNeedsUpdate = true;
     }
     
-    // Refresh display
-    if (displayNeedsUpdate || currentTime - lastRefresh > UI_REFRESH_INTERVAL) {
+    // Refresh display (periodic deadline is consumed even on input redraws)
+    bool refreshDue = Scheduler::due(SCHED_OLED);
+    if (displayOn && (displayNeedsUpdate || refreshDue)) {
         switch (currentMenu) {
             case MENU_MAIN:
                 drawMainScreen();
@@ -156,10 +284,21 @@ void PhysicalUI::update() {
             case MENU_CONFIRM:
                 drawConfirm();
                 break;
+            case MENU_PERF:
+                drawPerfPage();
+                break;
+            case MENU_RESUME:
+                drawResume();
+                break;
+            case MENU_BINS:
+                drawBins();
+                break;
         }
         
-        display->display();
-        lastRefresh = currentTime;
+        {
+            ScopedTimer timer(PROF_I2C_OLED);
+            display->display();
+        }
         displayNeedsUpdate = false;
     }
 }
@@ -171,11 +310,18 @@ void PhysicalUI::update() {
 void PhysicalUI::handleEncoderChange() {
     int delta = encoderPos - lastEncoderPos;
     
-    menuIndex += delta;
-    
-    // Wrap around
-    if (menuIndex < 0) menuIndex = maxMenuIndex;
-    if (menuIndex > maxMenuIndex) menuIndex = 0;
+    if (currentMenu == MENU_CUTOFF_ADJUST) {
+        // Accelerated and clamped - a fast spin parks at the range limit
+        menuIndex += delta * encoderStepMultiplier;
+        if (menuIndex < minMenuIndex) menuIndex = minMenuIndex;
+        if (menuIndex > maxMenuIndex) menuIndex = maxMenuIndex;
+    } else {
+        menuIndex += delta;
+        
+        // Wrap around
+        if (menuIndex < minMenuIndex) menuIndex = maxMenuIndex;
+        if (menuIndex > maxMenuIndex) menuIndex = minMenuIndex;
+    }
     
     playBeep(BEEP_MENU);
     
@@ -189,62 +335,107 @@ void PhysicalUI::handleButtonPress() {
     
     switch (currentMenu) {
         case MENU_MAIN:
-            // Enter port selection
+            // Enter port selection (last entry is the cell bins screen)
             currentMenu = MENU_PORT_SELECT;
             menuIndex = 0;
-            maxMenuIndex = NUM_PORTS - 1;
+            maxMenuIndex = results ? NUM_PORTS : NUM_PORTS - 1;
             break;
             
         case MENU_PORT_SELECT:
+            if (menuIndex == NUM_PORTS) {
+                // Scroll offset over the non-empty bins, 5 rows visible
+                uint16_t start[64], count[64];
+                int bins = results->getBins(0, start, count, 64);
+                currentMenu = MENU_BINS;
+                menuIndex = 0;
+                maxMenuIndex = bins > 5 ? bins - 5 : 0;
+                break;
+            }
+            
             // Select port and go to mode selection
             selectedPort = menuIndex;
+            wizard.port = selectedPort;
+            wizard.fields = PORT_SET_MODE | PORT_SET_BATTERY | PORT_SET_CUTOFF | PORT_SET_START;
             currentMenu = MENU_MODE_SELECT;
             menuIndex = portData[selectedPort].mode;
             maxMenuIndex = 2; // SAFETY, CHARGING, DISCHARGING
             break;
             
         case MENU_MODE_SELECT:
-            // Set mode and go to battery selection
-            portData[selectedPort].mode = (OperationMode)menuIndex;
+            // Choose mode and go to battery selection
+            wizard.mode = (OperationMode)menuIndex;
             currentMenu = MENU_BATTERY_SELECT;
             menuIndex = portData[selectedPort].batteryType;
             maxMenuIndex = 2; // LIION, LIFEPO4, LIPO
             break;
             
         case MENU_BATTERY_SELECT:
-            // Set battery type and go to cutoff adjust
-            portData[selectedPort].batteryType = (BatteryType)menuIndex;
+            // Choose battery type and go to cutoff adjust
+            wizard.batteryType = (BatteryType)menuIndex;
             currentMenu = MENU_CUTOFF_ADJUST;
-            menuIndex = (int)(portData[selectedPort].customCutoff * 10); // 2.5V = 25
-            maxMenuIndex = 35; // 2.0V to 3.5V
+            menuIndex = (int)(portData[selectedPort].customCutoff * 100 + 0.5); // 2.50V = 250
+            minMenuIndex = 200; // 2.00V
+            maxMenuIndex = 350; // 3.50V
+            if (menuIndex < minMenuIndex) menuIndex = minMenuIndex;
+            if (menuIndex > maxMenuIndex) menuIndex = maxMenuIndex;
             break;
             
         case MENU_CUTOFF_ADJUST:
-            // Set cutoff and confirm
-            portData[selectedPort].customCutoff = menuIndex / 10.0;
-            portData[selectedPort].useCustomCutoff = true;
+            // Choose cutoff and confirm
+            wizard.cutoff = menuIndex / 100.0;
             currentMenu = MENU_CONFIRM;
             menuIndex = 0;
+            minMenuIndex = 0;
             maxMenuIndex = 1; // Yes/No
             break;
             
         case MENU_CONFIRM:
+            // START applies every choice at once; CANCEL leaves the port as it was
             if (menuIndex == 0) {
-                // Confirm - activate port
-                portData[selectedPort].active = true;
-                portData[selectedPort].reset();
-                portData[selectedPort].startTime = millis();
-                playBeep(BEEP_COMPLETE);
+                if (commands && commands->pushSettings(wizard)) {
+                    playBeep(BEEP_COMPLETE);
+                } else {
+                    playBeep(BEEP_ERROR);
+                }
+            }
+            returnToMain();
+            break;
+            
+        case MENU_PERF:
+        case MENU_BINS:
+            returnToMain();
+            break;
+            
+        case MENU_RESUME:
+            if (checkpoint && commands) {
+                PortCommand command = {};
+                command.type = menuIndex == 0 ? CMD_RESUME : CMD_DISCARD_RESUME;
+                if (commands->push(command) && menuIndex == 0) {
+                    playBeep(BEEP_COMPLETE);
+                }
             }
             returnToMain();
             break;
     }
 }
 
+void PhysicalUI::handleLongPress() {
+    // Hidden diagnostics page, only reachable from the main screen
+    if (currentMenu != MENU_MAIN) return;
+    
+    playBeep(BEEP_SELECT);
+    currentMenu = MENU_PERF;
+    menuIndex = 0;
+    minMenuIndex = 0;
+    maxMenuIndex = PROF_COUNT > 5 ? PROF_COUNT - 5 : 0; // Scroll offset, 5 rows visible
+}
+
 void PhysicalUI::returnToMain() {
     currentMenu = MENU_MAIN;
     menuIndex = 0;
-    maxMenuIndex = NUM_PORTS - 1;
+    minMenuIndex = 0;
+    maxMenuIndex = MAIN_PAGES - 1;
+    lastPageFlip = millis();
 }
 
 // ============================================
@@ -257,25 +448,35 @@ void PhysicalUI::drawMainScreen() {
     // Header
     drawHeader("DIY Charger v2.0");
     
-    // Draw all ports (2x2 grid)
-    for (int i = 0; i < NUM_PORTS; i++) {
-        int x = (i % 2) * 64;
-        int y = 16 + (i / 2) * 24;
-        drawPortStatus(i, y);
+    // Ports on this page (2 columns x 3 rows)
+    int first = menuIndex * MAIN_PORTS_PER_PAGE;
+    for (int i = first; i < NUM_PORTS && i < first + MAIN_PORTS_PER_PAGE; i++) {
+        int slot = i - first;
+        int x = (slot % 2) * 64;
+        int y = 16 + (slot / 2) * 13;
+        drawPortStatus(i, x, y);
     }
     
     // Footer
     display->setCursor(0, 56);
     display->setTextSize(1);
     display->print("Press to config");
+    if (MAIN_PAGES > 1) {
+        display->setCursor(104, 56);
+        display->print(menuIndex + 1);
+        display->print("/");
+        display->print(MAIN_PAGES);
+    }
 }
 
 void PhysicalUI::drawPortSelect() {
     display->clearDisplay();
     drawHeader("Select Port");
     
-    for (int i = 0; i < NUM_PORTS; i++) {
-        int y = 16 + i * 12;
+    // Scroll so the selection stays visible
+    int first = menuIndex < MENU_VISIBLE_ROWS ? 0 : menuIndex - MENU_VISIBLE_ROWS + 1;
+    for (int i = first; i <= maxMenuIndex && i < first + MENU_VISIBLE_ROWS; i++) {
+        int y = 14 + (i - first) * 10;
         
         if (i == menuIndex) {
             display->fillRect(0, y, 128, 10, SSD1306_WHITE);
@@ -285,12 +486,17 @@ void PhysicalUI::drawPortSelect() {
         }
         
         display->setCursor(4, y + 1);
+        if (i == NUM_PORTS) {
+            display->print("Cell bins");
+            continue;
+        }
         display->print("Port ");
         display->print(i + 1);
         display->print(": ");
         display->print(portData[i].voltage, 2);
         display->print("V");
     }
+    display->setTextColor(SSD1306_WHITE);
 }
 
 void PhysicalUI::drawModeSelect() {
@@ -344,16 +550,20 @@ void PhysicalUI::drawCutoffAdjust() {
     display->clearDisplay();
     drawHeader("Cutoff Voltage");
     
-    float voltage = menuIndex / 10.0;
+    float voltage = menuIndex / 100.0;
     
     display->setTextSize(2);
-    display->setCursor(30, 25);
-    display->print(voltage, 1);
+    display->setCursor(24, 20);
+    display->print(voltage, 2);
     display->print(" V");
     
+    // Position within range (10mV steps, spin faster for bigger jumps)
+    float percentage = (menuIndex - minMenuIndex) * 100.0 / (maxMenuIndex - minMenuIndex);
+    drawProgressBar(14, 40, 100, 6, percentage);
+    
     display->setTextSize(1);
-    display->setCursor(20, 45);
-    display->print("Range: 2.0-3.5V");
+    display->setCursor(14, 52);
+    display->print("Range: 2.00-3.50V");
 }
 
 void PhysicalUI::drawConfirm() {
@@ -365,11 +575,11 @@ void PhysicalUI::drawConfirm() {
     display->print("Port: ");
     display->println(selectedPort + 1);
     display->print("Mode: ");
-    display->println(portData[selectedPort].getModeName());
+    display->println(MODE_NAMES[wizard.mode]);
     display->print("Battery: ");
-    display->println(portData[selectedPort].getBatteryName());
+    display->println(BATTERY_CONFIGS[wizard.batteryType].name);
     display->print("Cutoff: ");
-    display->print(portData[selectedPort].customCutoff, 1);
+    display->print(wizard.cutoff, 2);
     display->println("V");
     
     int y = 48;
@@ -389,6 +599,103 @@ void PhysicalUI::drawConfirm() {
     display->print("CANCEL");
 }
 
+void PhysicalUI::drawPerfPage() {
+    display->clearDisplay();
+    drawHeader("us   avg  p99   max");
+    
+    char line[24];
+    for (int row = 0; row < 5; row++) {
+        int slot = menuIndex + row;
+        if (slot >= PROF_COUNT) break;
+        
+        ProfileStats s;
+        Profiler::getSnapshot((ProfileSlot)slot, s);
+        snprintf(line, sizeof(line), "%-6.6s%4u %4u %5u",
+                 Profiler::getShortName((ProfileSlot)slot),
+                 Profiler::getAverageUs(s),
+                 Profiler::getPercentileUs(s, 99),
+                 Profiler::cyclesToUs(s.maxCycles));
+        
+        display->setCursor(0, 14 + row * 10);
+        display->print(line);
+    }
+}
+
+void PhysicalUI::drawResume() {
+    display->clearDisplay();
+    drawHeader("Resume tests?");
+    
+    if (!checkpoint) return;
+    const CheckpointRecord& rec = checkpoint->getPending();
+    
+    // One line per interrupted port (first 3 fit above the buttons)
+    int y = 14;
+    for (int i = 0; i < NUM_PORTS && y <= 34; i++) {
+        const PortCheckpoint& cp = rec.ports[i];
+        if (!(cp.flags & 0x01)) continue;
+        
+        display->setCursor(0, y);
+        display->print("P");
+        display->print(i + 1);
+        display->print(cp.mode == DISCHARGING ? " Dis " : " Chg ");
+        display->print(cp.mAh, 0);
+        display->print("mAh ");
+        display->print(cp.elapsedMs / 60000);
+        display->print("m");
+        y += 10;
+    }
+    
+    int by = 48;
+    if (menuIndex == 0) {
+        display->fillRect(0, by, 60, 12, SSD1306_WHITE);
+        display->setTextColor(SSD1306_BLACK);
+    }
+    display->setCursor(12, by + 2);
+    display->print("RESUME");
+    
+    display->setTextColor(SSD1306_WHITE);
+    if (menuIndex == 1) {
+        display->fillRect(68, by, 60, 12, SSD1306_WHITE);
+        display->setTextColor(SSD1306_BLACK);
+    }
+    display->setCursor(80, by + 2);
+    display->print("DISCARD");
+    display->setTextColor(SSD1306_WHITE);
+}
+
+void PhysicalUI::drawBins() {
+    display->clearDisplay();
+    drawHeader("mAh bin      cells");
+    
+    uint16_t start[5], count[5];
+    int bins = results ? results->getBins(menuIndex, start, count, 5) : 0;
+    if (bins == 0) {
+        display->setCursor(0, 24);
+        display->print("No results yet");
+        return;
+    }
+    
+    // Bars scaled to the fullest visible bin
+    uint16_t maxCount = 1;
+    for (int row = 0; row < bins; row++) {
+        if (count[row] > maxCount) maxCount = count[row];
+    }
+    
+    char line[8];
+    for (int row = 0; row < bins; row++) {
+        int y = 14 + row * 10;
+        display->setCursor(0, y);
+        display->print(start[row]);
+        
+        int barWidth = count[row] * 60 / maxCount;
+        display->fillRect(34, y, barWidth > 0 ? barWidth : 1, 7, SSD1306_WHITE);
+        
+        snprintf(line, sizeof(line), "%4u", count[row]);
+        display->setCursor(104, y);
+        display->print(line);
+    }
+}
+
 // ============================================
 // HELPER DRAWING FUNCTIONS
 // ============================================
@@ -403,25 +710,24 @@ void PhysicalUI::drawHeader(const char* title) {
     display->setTextColor(SSD1306_WHITE);
 }
 
-void PhysicalUI::drawPortStatus(int port, int y) {
+void PhysicalUI::drawPortStatus(int port, int x, int y) {
     display->setTextSize(1);
-    display->setCursor(0, y);
+    display->setCursor(x, y);
     display->print("P");
     display->print(port + 1);
-    display->print(":");
+    if (port < 9) display->print(":");
     
     // Battery icon
     float maxV = BATTERY_CONFIGS[portData[port].batteryType].maxVoltage;
-    drawBattery(18, y, portData[port].voltage, maxV);
+    drawBattery(x + 19, y, portData[port].voltage, maxV);
     
-    // Voltage
-    display->setCursor(32, y);
+    // Voltage (no unit - the cell is 64px wide)
+    display->setCursor(x + 33, y);
     display->print(portData[port].voltage, 2);
-    display->print("V");
     
     // Status indicator
     if (portData[port].active) {
-        display->fillCircle(60, y + 4, 2, SSD1306_WHITE);
+        display->fillCircle(x + 60, y + 3, 2, SSD1306_WHITE);
     }
 }
 
@@ -458,61 +764,8 @@ void PhysicalUI::drawProgressBar(int x, int y, int width, int height, float perc
 // BUZZER CONTROL
 // ============================================
 
-void PhysicalUI::playBeep(BuzzerPattern pattern) {
-    currentBeep = pattern;
-    beepStartTime = millis();
-    beepActive = true;
-    
-    int freq = BUZZER_FREQ_MENU;
-    
-    switch (pattern) {
-        case BEEP_MENU:
-            freq = BUZZER_FREQ_MENU;
-            break;
-        case BEEP_SELECT:
-            freq = BUZZER_FREQ_SELECT;
-            break;
-        case BEEP_COMPLETE:
-            freq = BUZZER_FREQ_COMPLETE;
-            break;
-        case BEEP_ERROR:
-            freq = BUZZER_FREQ_ERROR;
-            break;
-        default:
-            break;
-    }
-    
-    tone(BUZZER_PIN, freq);
-}
-
-void PhysicalUI::updateBuzzer() {
-    if (!beepActive) return;
-    
-    unsigned long elapsed = millis() - beepStartTime;
-    int duration = BUZZER_DURATION_SHORT;
-    
-    switch (currentBeep) {
-        case BEEP_MENU:
-            duration = BUZZER_DURATION_SHORT;
-            break;
-        case BEEP_SELECT:
-            duration = BUZZER_DURATION_LONG;
-            break;
-        case BEEP_COMPLETE:
-            duration = BUZZER_DURATION_COMPLETE;
-            break;
-        case BEEP_ERROR:
-            duration = BUZZER_DURATION_LONG;
-            break;
-        default:
-            break;
-    }
-    
-    if (elapsed >= duration) {
-        noTone(BUZZER_PIN);
-        beepActive = false;
-        currentBeep = BEEP_NONE;
-    }
+void PhysicalUI::playBeep(BuzzerPattern pattern, int port) {
+    buzzer.play(pattern, port);
 }
 
 // ============================================
@@ -520,15 +773,41 @@ void PhysicalUI::updateBuzzer() {
 // ============================================
 
 void PhysicalUI::notifyComplete(int port) {
-    playBeep(BEEP_COMPLETE);
+    playBeep(BEEP_COMPLETE, port);
     displayNeedsUpdate = true;
 }
 
 void PhysicalUI::notifyError(int port) {
-    playBeep(BEEP_ERROR);
+    playBeep(BEEP_ERROR, port);
     displayNeedsUpdate = true;
 }
 
 void PhysicalUI::forceRedraw() {
     displayNeedsUpdate = true;
 }
+
+void PhysicalUI::setDisplayOn(bool on) {
+    if (on == displayOn) return;
+    display->ssd1306_command(on ? SSD1306_DISPLAYON : SSD1306_DISPLAYOFF);
+    displayOn = on;
+    if (on) displayNeedsUpdate = true;
+}
+
+void PhysicalUI::setDimmed(bool dim) {
+    if (dim == displayDimmed) return;
+    display->dim(dim);
+    displayDimmed = dim;
+}
+
+void PhysicalUI::offerResume(CheckpointStore* store) {
+    checkpoint = store;
+    if (!store || !store->hasPendingResume()) return;
+    
+    currentMenu = MENU_RESUME;
+    menuIndex = 0;
+    minMenuIndex = 0;
+    maxMenuIndex = 1; // Resume/Discard
+    lastMenuActivity = millis();
+    displayNeedsUpdate = true;
+    playBeep(BEEP_SELECT);
+}
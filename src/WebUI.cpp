@@ -1,4 +1,5 @@
 #include "WebUI.h"
+#include <esp_mac.h>
 
 // ============================================
 // CONSTRUCTOR
@@ -6,9 +7,29 @@
 
 WebUI::WebUI(PortData* data) {
     portData = data;
+    checkpoint = nullptr;
+    logger = nullptr;
+    results = nullptr;
+    power = nullptr;
+    gateway = nullptr;
+    capture = nullptr;
+    compressor = nullptr;
+    commands = nullptr;
+    ota = nullptr;
+    hostname[0] = '\0';
+    staConnected = false;
+    apFallback = false;
+    staSince = 0;
+    memset(subscribers, 0, sizeof(subscribers));
+    subscriberLock = portMUX_INITIALIZER_UNLOCKED;
+    memset(sseSent, 0, sizeof(sseSent));
+    sseDeadbandV = SSE_DEADBAND_V;
+    sseDeadbandA = SSE_DEADBAND_A;
+    sseDeadbandMah = SSE_DEADBAND_MAH;
+    sseEventId = 0;
     server = new AsyncWebServer(WEB_PORT);
     ws = new AsyncWebSocket("/ws");
-    lastUpdate = 0;
+    events = new AsyncEventSource("/api/stream");
 }
 
 // ============================================
@@ -16,13 +37,42 @@ WebUI::WebUI(PortData* data) {
 // ============================================
 
 bool WebUI::begin() {
-    // Start WiFi Access Point
-    WiFi.mode(WIFI_AP);
-    WiFi.softAP(AP_SSID, AP_PASSWORD, AP_CHANNEL, 0, AP_MAX_CLIENTS);
+    // charger-<UNIT_ID>, or the last MAC bytes so units never collide
+    if (UNIT_ID > 0) {
+        snprintf(hostname, sizeof(hostname), "%s-%d", MDNS_PREFIX, UNIT_ID);
+    } else {
+        // From eFuse: WiFi.macAddress() reads zeros until mode() has started
+        // the driver, and the hostname has to be set before that
+        uint8_t mac[6];
+        esp_read_mac(mac, ESP_MAC_WIFI_STA);
+        snprintf(hostname, sizeof(hostname), "%s-%02x%02x", MDNS_PREFIX, mac[4], mac[5]);
+    }
     
-    IPAddress IP = WiFi.softAPIP();
-    DEBUG_PRINT("AP IP address: ");
-    DEBUG_PRINTLN(IP);
+    // Hostname before mode(): DHCP announces it when the station starts
+    if (NET_MODE != NET_MODE_AP) {
+        WiFi.setHostname(hostname);
+    }
+    WiFi.mode(NET_MODE == NET_MODE_STA ? WIFI_STA : NET_MODE == NET_MODE_AP_STA ? WIFI_AP_STA : WIFI_AP);
+    
+    if (NET_MODE != NET_MODE_STA) {
+        startAccessPoint();
+    }
+    
+    // Station connects in the background; updateStation() reports it
+    if (NET_MODE != NET_MODE_AP) {
+        WiFi.setAutoReconnect(true);
+        WiFi.begin(STA_SSID, STA_PASSWORD);
+        staSince = millis();
+        DEBUG_PRINTF("Joining \"%s\" as %s\n", STA_SSID, hostname);
+    }
+    
+    // Answers on every interface that is up (AP and/or STA)
+    if (MDNS.begin(hostname)) {
+        MDNS.addService("http", "tcp", WEB_PORT);
+        DEBUG_PRINTF("mDNS: http://%s.local\n", hostname);
+    } else {
+        DEBUG_PRINTLN("WARNING: mDNS responder failed");
+    }
     
     // Setup WebSocket
     ws->onEvent([this](AsyncWebSocket *server, AsyncWebSocketClient *client, 
@@ -31,6 +81,12 @@ bool WebUI::begin() {
     });
     server->addHandler(ws);
     
+    // SSE: the full status once, then only ports that changed
+    events->onConnect([this](AsyncEventSourceClient *client) {
+        client->send(getStatusJSON().c_str(), "status", sseEventId);
+    });
+    server->addHandler(events);
+    
     // Setup HTTP routes
     server->on("/", HTTP_GET, [this](AsyncWebServerRequest *request) {
         this->handleRoot(request);
@@ -52,6 +108,13 @@ bool WebUI::begin() {
         this->handleSetCutoff(request);
     });
     
+    // JSON body: collected by the body callback, handled once complete
+    server->on("/api/config", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        this->handleSetConfig(request);
+    }, nullptr, [this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+        this->handleConfigBody(request, data, len, index, total);
+    });
+    
     server->on("/api/reset", HTTP_POST, [this](AsyncWebServerRequest *request) {
         this->handleReset(request);
     });
@@ -60,6 +123,78 @@ bool WebUI::begin() {
         this->handleGetLogs(request);
     });
     
+    server->on("/api/perf", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        this->handleGetPerf(request);
+    });
+    
+    server->on("/api/perf/reset", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        this->handleResetPerf(request);
+    });
+    
+    server->on("/api/resume", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        this->handleGetResume(request);
+    });
+    
+    server->on("/api/resume", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        this->handleResume(request);
+    });
+    
+    server->on("/api/calibrate", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        this->handleGetCalibration(request);
+    });
+    
+    server->on("/api/calibrate", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        this->handleCalibrate(request);
+    });
+    
+    server->on("/api/capture", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        this->handleGetCapture(request);
+    });
+    
+    server->on("/api/capture", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        this->handleArmCapture(request);
+    });
+    
+    server->on("/api/capture/cancel", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        this->handleCancelCapture(request);
+    });
+    
+    server->on("/api/stream", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        this->handleSetStream(request);
+    });
+    
+    server->on("/api/compression", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        this->handleSetCompression(request);
+    });
+    
+    server->on("/api/ota", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        this->handleGetOta(request);
+    });
+    
+    server->on("/api/ota", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        this->handleStartOta(request);
+    });
+    
+    server->on("/api/ota/cancel", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        this->handleCancelOta(request);
+    });
+    
+    server->on("/api/results", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        this->handleGetResults(request);
+    });
+    
+    server->on("/api/results/clear", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        this->handleClearResults(request);
+    });
+    
+    server->on("/api/cell", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        this->handleSetCell(request);
+    });
+    
+    server->on("/metrics", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        this->handleMetrics(request);
+    });
+    
     // Start server
     server->begin();
     DEBUG_PRINTLN("Web server started");
@@ -72,12 +207,50 @@ bool WebUI::begin() {
 // ============================================
 
 void WebUI::update() {
-    ws->cleanupClients();
+    ws->cleanupClients(WS_MAX_CLIENTS);
+    updateStation();
     
-    unsigned long currentTime = millis();
-    if (currentTime - lastUpdate >= WS_UPDATE_INTERVAL) {
+    if (Scheduler::due(SCHED_WS_PUSH)) {
         broadcastStatus();
-        lastUpdate = currentTime;
+    }
+}
+
+// ============================================
+// NETWORK
+// ============================================
+
+void WebUI::startAccessPoint() {
+    WiFi.softAP(AP_SSID, AP_PASSWORD, AP_CHANNEL, 0, AP_MAX_CLIENTS);
+    
+    IPAddress IP = WiFi.softAPIP();
+    DEBUG_PRINT("AP IP address: ");
+    DEBUG_PRINTLN(IP);
+}
+
+void WebUI::updateStation() {
+    if (NET_MODE == NET_MODE_AP) return;
+    
+    unsigned long now = millis();
+    bool connected = WiFi.status() == WL_CONNECTED;
+    if (connected) staSince = now;
+    
+    if (connected != staConnected) {
+        staConnected = connected;
+        if (connected) {
+            DEBUG_PRINTF("WiFi: joined \"%s\" as http://%s (%s.local)\n",
+                         STA_SSID, WiFi.localIP().toString().c_str(), hostname);
+        } else {
+            DEBUG_PRINTLN("WiFi: station lost, reconnecting");
+        }
+    }
+    
+    // STA only: bring the AP up so the unit stays reachable (it stays up)
+    if (NET_MODE == NET_MODE_STA && !connected && !apFallback &&
+        now - staSince >= STA_CONNECT_TIMEOUT_MS) {
+        DEBUG_PRINTLN("WiFi: no station link, starting AP");
+        WiFi.mode(WIFI_AP_STA);
+        startAccessPoint();
+        apFallback = true;
     }
 }
 
@@ -86,6 +259,8 @@ void WebUI::update() {
 // ============================================
 
 void WebUI::handleRoot(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_ROOT);
+    
     String html = R"rawliteral(
 <!DOCTYPE html>
 <html>
@@ -102,6 +277,8 @@ void WebUI::handleRoot(AsyncWebServerRequest *request) {
         .port-card { background: #2a2a2a; border-radius: 10px; padding: 20px; border: 2px solid #333; }
         .port-card.active { border-color: #4CAF50; }
         .port-card.error { border-color: #f44336; }
+        .port-card.offline { opacity: 0.4; }
+        .unit-title { grid-column: 1 / -1; color: #999; margin-top: 10px; }
         .port-header { display: flex; justify-content: space-between; margin-bottom: 15px; }
         .port-title { font-size: 1.2em; font-weight: bold; }
         .status-badge { padding: 5px 10px; border-radius: 5px; font-size: 0.8em; }
@@ -153,6 +330,39 @@ void WebUI::handleRoot(AsyncWebServerRequest *request) {
                 const card = createPortCard(idx, port);
                 grid.appendChild(card);
             });
+            
+            // Gateway: other units' ports (controls stay on each unit's own AP)
+            (data.units || []).forEach((unit) => {
+                const title = document.createElement('div');
+                title.className = 'unit-title';
+                title.textContent = 'Unit ' + unit.id + (unit.online ? '' : ' (offline)');
+                grid.appendChild(title);
+                unit.ports.forEach((port, idx) => {
+                    grid.appendChild(createRemoteCard(unit, idx, port));
+                });
+            });
+        }
+        
+        function createRemoteCard(unit, idx, port) {
+            const div = document.createElement('div');
+            div.className = 'port-card ' + (port.active ? 'active' : '');
+            if (port.status === 3) div.className += ' error';
+            if (!unit.online) div.className += ' offline';
+            
+            div.innerHTML = `
+                <div class="port-header">
+                    <div class="port-title">${unit.id.slice(-5)} Port ${idx + 1}</div>
+                    <div class="status-badge status-${getStatusClass(port.status)}">${getStatusText(port.status)}</div>
+                </div>
+                <div class="metrics">
+                    <div class="metric"><span class="metric-label">Voltage:</span><span class="metric-value">${port.voltage.toFixed(3)} V</span></div>
+                    <div class="metric"><span class="metric-label">Current:</span><span class="metric-value">${port.current.toFixed(3)} A</span></div>
+                    <div class="metric"><span class="metric-label">Capacity:</span><span class="metric-value">${port.mAh.toFixed(0)} mAh</span></div>
+                    <div class="metric"><span class="metric-label">Energy:</span><span class="metric-value">${port.Wh.toFixed(2)} Wh</span></div>
+                </div>
+            `;
+            
+            return div;
         }
         
         function createPortCard(idx, port) {
@@ -191,7 +401,7 @@ void WebUI::handleRoot(AsyncWebServerRequest *request) {
                     </div>
                     <div class="control-group">
                         <label>Custom Cutoff (V):</label>
-                        <input type="number" id="cutoff${idx}" step="0.1" min="2.0" max="3.5" value="${port.customCutoff.toFixed(1)}" onchange="setCutoff(${idx}, this.value)">
+                        <input type="number" id="cutoff${idx}" step="0.01" min="2.0" max="3.5" value="${port.customCutoff.toFixed(2)}" onchange="setCutoff(${idx}, this.value)">
                     </div>
                     <button class="btn-reset" onclick="resetPort(${idx})">Reset Data</button>
                 </div>
@@ -254,27 +464,24 @@ void WebUI::handleRoot(AsyncWebServerRequest *request) {
 }
 
 void WebUI::handleGetStatus(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_STATUS);
+    
     request->send(200, "application/json", getStatusJSON());
 }
 
 void WebUI::handleSetMode(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
     if (request->hasParam("port", true) && request->hasParam("mode", true)) {
         int port = request->getParam("port", true)->value().toInt();
         int mode = request->getParam("mode", true)->value().toInt();
         
         if (port >= 0 && port < NUM_PORTS && mode >= 0 && mode <= 2) {
-            portData[port].mode = (OperationMode)mode;
-            
-            if (mode == SAFETY) {
-                portData[port].active = false;
-            } else {
-                portData[port].active = true;
-                if (portData[port].startTime == 0) {
-                    portData[port].startTime = millis();
-                }
-            }
-            
-            request->send(200, "text/plain", "OK");
+            PortSettings settings = {};
+            settings.port = port;
+            settings.fields = PORT_SET_MODE;
+            settings.mode = (OperationMode)mode;
+            queueSettings(request, settings);
             return;
         }
     }
@@ -282,13 +489,18 @@ void WebUI::handleSetMode(AsyncWebServerRequest *request) {
 }
 
 void WebUI::handleSetBattery(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
     if (request->hasParam("port", true) && request->hasParam("type", true)) {
         int port = request->getParam("port", true)->value().toInt();
         int type = request->getParam("type", true)->value().toInt();
         
         if (port >= 0 && port < NUM_PORTS && type >= 0 && type <= 2) {
-            portData[port].batteryType = (BatteryType)type;
-            request->send(200, "text/plain", "OK");
+            PortSettings settings = {};
+            settings.port = port;
+            settings.fields = PORT_SET_BATTERY;
+            settings.batteryType = (BatteryType)type;
+            queueSettings(request, settings);
             return;
         }
     }
@@ -296,14 +508,18 @@ void WebUI::handleSetBattery(AsyncWebServerRequest *request) {
 }
 
 void WebUI::handleSetCutoff(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
     if (request->hasParam("port", true) && request->hasParam("voltage", true)) {
         int port = request->getParam("port", true)->value().toInt();
         float voltage = request->getParam("voltage", true)->value().toFloat();
         
         if (port >= 0 && port < NUM_PORTS && voltage >= 2.0 && voltage <= 3.5) {
-            portData[port].customCutoff = voltage;
-            portData[port].useCustomCutoff = true;
-            request->send(200, "text/plain", "OK");
+            PortSettings settings = {};
+            settings.port = port;
+            settings.fields = PORT_SET_CUTOFF;
+            settings.cutoff = voltage;
+            queueSettings(request, settings);
             return;
         }
     }
@@ -311,19 +527,179 @@ void WebUI::handleSetCutoff(AsyncWebServerRequest *request) {
 }
 
 void WebUI::handleReset(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
     if (request->hasParam("port", true)) {
         int port = request->getParam("port", true)->value().toInt();
         
         if (port >= 0 && port < NUM_PORTS) {
-            portData[port].reset();
-            request->send(200, "text/plain", "OK");
+            PortSettings settings = {};
+            settings.port = port;
+            settings.fields = PORT_SET_RESET;
+            queueSettings(request, settings);
             return;
         }
     }
     request->send(400, "text/plain", "Invalid parameters");
 }
 
+// Applied by loop() before the next MOSFET update; the handler never waits
+void WebUI::queueSettings(AsyncWebServerRequest *request, const PortSettings& settings) {
+    if (!commands || !commands->pushSettings(settings)) {
+        request->send(503, "text/plain", "Busy");
+        return;
+    }
+    request->send(200, "text/plain", "OK");
+}
+
+// ============================================
+// BATCH CONFIGURATION
+// ============================================
+
+// The library hands the body over in TCP-sized pieces; collect it in the
+// request's scratch pointer (freed with the request)
+void WebUI::handleConfigBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+    if (total > CONFIG_BODY_MAX) return;
+    if (index == 0) {
+        ScopedHeapTag heapTag(HEAP_WEB_API);
+        request->_tempObject = malloc(total);
+    }
+    if (request->_tempObject && index + len <= total) {
+        memcpy((uint8_t*)request->_tempObject + index, data, len);
+    }
+}
+
+// [{"port":0,"batteryType":0,"cutoff":3.0,"mode":2}, ...] - all entries are
+// checked first; nothing changes unless every one is valid. The batch is
+// queued as one group, which loop() applies in a single drain.
+void WebUI::handleSetConfig(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
+    if (request->contentLength() > CONFIG_BODY_MAX) {
+        request->send(413, "text/plain", "Body too large");
+        return;
+    }
+    
+    StaticJsonDocument<JSON_CONFIG_SIZE> input;
+    if (!request->_tempObject ||
+        deserializeJson(input, (const char*)request->_tempObject, request->contentLength())) {
+        request->send(400, "text/plain", "Invalid JSON");
+        return;
+    }
+    JsonArrayConst entries = input.as<JsonArrayConst>();
+    if (entries.isNull() || entries.size() == 0 || entries.size() > NUM_PORTS) {
+        request->send(400, "text/plain", "Expected an array of 1-" + String(NUM_PORTS) + " ports");
+        return;
+    }
+    
+    StaticJsonDocument<JSON_CONFIG_SIZE> doc;
+    JsonArray results = doc.createNestedArray("ports");
+    PortCommand batch[NUM_PORTS];
+    uint32_t seen = 0;
+    int count = 0;
+    bool valid = true;
+    
+    for (JsonVariantConst item : entries) {
+        JsonObject result = results.createNestedObject();
+        result["index"] = count;
+        
+        batch[count].type = CMD_PORT_SETTINGS;
+        PortSettings& settings = batch[count++].settings;
+        const char* error = parsePortSettings(item.as<JsonObjectConst>(), settings);
+        if (!error && (seen & (1UL << settings.port))) error = "duplicate port";
+        if (!error) {
+            seen |= 1UL << settings.port;
+            result["port"] = settings.port;
+        } else {
+            result["error"] = error;
+            valid = false;
+        }
+        result["ok"] = error == nullptr;
+    }
+    
+    bool busy = valid && (!commands || !commands->push(batch, count));
+    doc["applied"] = valid && !busy;
+    if (busy) doc["error"] = "command queue full";
+    
+    String output;
+    serializeJson(doc, output);
+    request->send(!valid ? 400 : busy ? 503 : 200, "application/json", output);
+}
+
+// nullptr when the entry is valid, else the reason
+const char* WebUI::parsePortSettings(JsonObjectConst entry, PortSettings& out) {
+    memset(&out, 0, sizeof(out));
+    if (entry.isNull()) return "not an object";
+    if (!entry["port"].is<int>()) return "missing port";
+    
+    int port = entry["port"].as<int>();
+    if (port < 0 || port >= NUM_PORTS) return "invalid port";
+    out.port = port;
+    
+    if (entry.containsKey("mode")) {
+        int mode = entry["mode"].as<int>();
+        if (!entry["mode"].is<int>() || mode < 0 || mode > 2) return "invalid mode";
+        out.mode = (OperationMode)mode;
+        out.fields |= PORT_SET_MODE;
+    }
+    if (entry.containsKey("batteryType")) {
+        int type = entry["batteryType"].as<int>();
+        if (!entry["batteryType"].is<int>() || type < 0 || type > 2) return "invalid batteryType";
+        out.batteryType = (BatteryType)type;
+        out.fields |= PORT_SET_BATTERY;
+    }
+    if (entry.containsKey("cutoff")) {
+        float voltage = entry["cutoff"].as<float>();
+        if (!entry["cutoff"].is<float>() || voltage < 2.0 || voltage > 3.5) return "invalid cutoff";
+        out.cutoff = voltage;
+        out.fields |= PORT_SET_CUTOFF;
+    }
+    if (entry["reset"].as<bool>()) {
+        out.fields |= PORT_SET_RESET;
+    }
+    
+    if (out.fields == 0) return "nothing to set";
+    return nullptr;
+}
+
 void WebUI::handleGetLogs(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_LOGS);
+    
+    bool binary = request->hasParam("format") && request->getParam("format")->value() == "bin";
+    
+    // Compressed history: every kept point, oldest first, streamed from the ring
+    if (binary && compressor) {
+        uint32_t first, count;
+        compressor->getHistoryRange(first, count);
+        TelemetryCompressor* tc = compressor;
+        size_t total = sizeof(LogFileHeader) + count * sizeof(LogRecord);
+        AsyncWebServerResponse *response = request->beginResponse("application/octet-stream", total,
+            [tc, first, count](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+                return tc->readHistory(buffer, maxLen, index, first, count);
+            });
+        response->addHeader("Content-Disposition", "attachment; filename=\"logs.bin\"");
+        request->send(response);
+        return;
+    }
+    
+    // Binary records: 24 bytes per sample instead of ~70 bytes of CSV text
+    if (logger && binary) {
+        AsyncResponseStream *response = request->beginResponseStream("application/octet-stream");
+        LogFileHeader header;
+        logger->getLogHeader(header);
+        response->write((const uint8_t*)&header, sizeof(header));
+        
+        for (int i = 0; i < NUM_PORTS; i++) {
+            if (portData[i].active) {
+                LogRecord record;
+                logger->getLogRecord(i, record);
+                response->write((const uint8_t*)&record, sizeof(record));
+            }
+        }
+        request->send(response);
+        return;
+    }
+    
     String csv = "Timestamp,Port,Voltage,Current,Power,mAh,Wh,Mode,Battery,Status\n";
     
     // This is a placeholder - in full implementation, read from storage
@@ -348,6 +724,617 @@ csv += "\n";
     request->send(200, "text/csv", csv);
 }
 
+void WebUI::handleGetPerf(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
+    request->send(200, "application/json", getPerfJSON());
+}
+
+void WebUI::handleResetPerf(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
+    Profiler::reset();
+    request->send(200, "text/plain", "OK");
+}
+
+void WebUI::handleGetResume(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
+    StaticJsonDocument<JSON_RESUME_SIZE> doc;
+    bool pending = checkpoint && checkpoint->hasPendingResume();
+    doc["pending"] = pending;
+    
+    if (pending) {
+        const CheckpointRecord& rec = checkpoint->getPending();
+        JsonArray ports = doc.createNestedArray("ports");
+        for (int i = 0; i < NUM_PORTS; i++) {
+            const PortCheckpoint& cp = rec.ports[i];
+            JsonObject port = ports.createNestedObject();
+            port["active"] = (cp.flags & 0x01) != 0;
+            port["mode"] = cp.mode;
+            port["batteryType"] = cp.batteryType;
+            port["mAh"] = cp.mAh;
+            port["Wh"] = cp.Wh;
+            port["elapsed"] = cp.elapsedMs / 1000;
+        }
+    }
+    
+    String output;
+    serializeJson(doc, output);
+    request->send(200, "application/json", output);
+}
+
+void WebUI::handleResume(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
+    if (!checkpoint || !checkpoint->hasPendingResume()) {
+        request->send(409, "text/plain", "Nothing to resume");
+        return;
+    }
+    
+    if (request->hasParam("action", true)) {
+        String action = request->getParam("action", true)->value();
+        if (action == "resume" || action == "discard") {
+            PortCommand command = {};
+            command.type = action == "resume" ? CMD_RESUME : CMD_DISCARD_RESUME;
+            if (!commands || !commands->push(command)) {
+                request->send(503, "text/plain", "Busy");
+                return;
+            }
+            request->send(200, "text/plain", "OK");
+            return;
+        }
+    }
+    request->send(400, "text/plain", "Invalid parameters");
+}
+
+void WebUI::handleGetCalibration(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
+    if (!logger) {
+        request->send(503, "text/plain", "Logger unavailable");
+        return;
+    }
+    
+    StaticJsonDocument<JSON_CALIBRATION_SIZE> doc;
+    JsonArray ports = doc.createNestedArray("ports");
+    for (int i = 0; i < NUM_PORTS; i++) {
+        const PortCalibration& cal = logger->getCalibration(i);
+        JsonObject port = ports.createNestedObject();
+        port["voltageGain"] = cal.voltageGain;
+        port["voltageOffset"] = cal.voltageOffset;
+        port["currentGain"] = cal.currentGain;
+        port["currentOffset"] = cal.currentOffset;
+        port["running"] = logger->isCalibrating(i);
+        port["result"] = logger->getCalibrationResult(i);
+    }
+    
+    String output;
+    serializeJson(doc, output);
+    request->send(200, "application/json", output);
+}
+
+void WebUI::handleCalibrate(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
+    if (!logger || !request->hasParam("port", true) || !request->hasParam("step", true)) {
+        request->send(400, "text/plain", "Invalid parameters");
+        return;
+    }
+    
+    int port = request->getParam("port", true)->value().toInt();
+    String step = request->getParam("step", true)->value();
+    if (port < 0 || port >= NUM_PORTS) {
+        request->send(400, "text/plain", "Invalid parameters");
+        return;
+    }
+    
+    // Both kinds apply in loop(), which owns the I2C bus
+    PortCommand command = {};
+    CalibrationCommand& cal = command.calibration;
+    cal.port = port;
+    
+    // Direct coefficient entry / factory reset
+    if (step == "set" || step == "reset") {
+        command.type = CMD_CALIBRATE_SET;
+        cal.values = {1.0f, 0.0f, 1.0f, 0.0f};
+        if (step == "reset") {
+            cal.fields = CAL_SET_ALL;
+        } else {
+            if (request->hasParam("voltageGain", true)) {
+                cal.values.voltageGain = request->getParam("voltageGain", true)->value().toFloat();
+                cal.fields |= CAL_SET_VOLTAGE_GAIN;
+            }
+            if (request->hasParam("voltageOffset", true)) {
+                cal.values.voltageOffset = request->getParam("voltageOffset", true)->value().toFloat();
+                cal.fields |= CAL_SET_VOLTAGE_OFFSET;
+            }
+            if (request->hasParam("currentGain", true)) {
+                cal.values.currentGain = request->getParam("currentGain", true)->value().toFloat();
+                cal.fields |= CAL_SET_CURRENT_GAIN;
+            }
+            if (request->hasParam("currentOffset", true)) {
+                cal.values.currentOffset = request->getParam("currentOffset", true)->value().toFloat();
+                cal.fields |= CAL_SET_CURRENT_OFFSET;
+            }
+            
+            // Fields not given keep their current (already checked) values
+            if (fabs(cal.values.voltageGain - 1.0f) > CALIBRATION_MAX_GAIN_ERROR ||
+                fabs(cal.values.currentGain - 1.0f) > CALIBRATION_MAX_GAIN_ERROR) {
+                request->send(400, "text/plain", "Gain out of range");
+                return;
+            }
+        }
+        if (!commands || !commands->push(command)) {
+            request->send(503, "text/plain", "Busy");
+            return;
+        }
+        request->send(200, "text/plain", "OK");
+        return;
+    }
+    
+    // Reference measurement steps (run over the next CALIBRATION_SAMPLES readings)
+    CalibrationStep calStep = CAL_NONE;
+    if (step == "zero") calStep = CAL_ZERO;
+    else if (step == "current") calStep = CAL_CURRENT;
+    else if (step == "voltage") calStep = CAL_VOLTAGE;
+    
+    float reference = 0;
+    bool isLoad = false;
+    if (request->hasParam("load", true)) {
+        reference = request->getParam("load", true)->value().toFloat();
+        isLoad = true;
+    } else if (request->hasParam("ref", true)) {
+        reference = request->getParam("ref", true)->value().toFloat();
+    }
+    
+    if (calStep == CAL_NONE || (isLoad && calStep != CAL_CURRENT)) {
+        request->send(400, "text/plain", "Invalid parameters");
+        return;
+    }
+    
+    // Checked again when loop() starts it; a late refusal shows as the result
+    if (!logger->canCalibrate(port, calStep, reference)) {
+        request->send(409, "text/plain", "Port not in required state");
+        return;
+    }
+    command.type = CMD_CALIBRATE_START;
+    cal.step = calStep;
+    cal.reference = reference;
+    cal.referenceIsLoad = isLoad;
+    if (!commands || !commands->push(command)) {
+        request->send(503, "text/plain", "Busy");
+        return;
+    }
+    request->send(202, "text/plain", "Started");
+}
+
+void WebUI::handleGetCapture(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
+    if (!capture) {
+        request->send(503, "text/plain", "Capture unavailable");
+        return;
+    }
+    
+    // Streamed from the ring in TCP-sized chunks, never copied whole
+    if (request->hasParam("format") && request->getParam("format")->value() == "bin") {
+        if (capture->getState() != CAPTURE_DONE) {
+            request->send(409, "text/plain", "No finished capture");
+            return;
+        }
+        WaveformCapture* wc = capture;
+        uint32_t generation = wc->getGeneration();
+        AsyncWebServerResponse *response = request->beginResponse("application/octet-stream", wc->getBinarySize(),
+            [wc, generation](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+                // Re-armed mid-download: stop rather than mix two captures
+                if (wc->getState() != CAPTURE_DONE || wc->getGeneration() != generation) return 0;
+                return wc->readBinary(buffer, maxLen, index);
+            });
+        response->addHeader("Content-Disposition", "attachment; filename=\"capture.bin\"");
+        request->send(response);
+        return;
+    }
+    
+    StaticJsonDocument<JSON_CAPTURE_SIZE> doc;
+    capture->addStatusJSON(doc.to<JsonObject>());
+    
+    String output;
+    serializeJson(doc, output);
+    request->send(200, "application/json", output);
+}
+
+void WebUI::handleArmCapture(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
+    if (!capture || !request->hasParam("port", true)) {
+        request->send(400, "text/plain", "Invalid parameters");
+        return;
+    }
+    
+    int port = request->getParam("port", true)->value().toInt();
+    String trigger = request->hasParam("trigger", true) ? request->getParam("trigger", true)->value() : String("load");
+    long preMs = request->hasParam("pre", true) ? request->getParam("pre", true)->value().toInt() : CAPTURE_DEFAULT_PRE_MS;
+    long postMs = request->hasParam("post", true) ? request->getParam("post", true)->value().toInt() : CAPTURE_DEFAULT_POST_MS;
+    long dipMv = request->hasParam("dip", true) ? request->getParam("dip", true)->value().toInt() : CAPTURE_DIP_MV;
+    
+    if (port < 0 || port >= NUM_PORTS || (trigger != "load" && trigger != "dip") ||
+        preMs < 0 || postMs <= 0 || preMs + postMs > CAPTURE_MAX_WINDOW_MS || dipMv <= 0) {
+        request->send(400, "text/plain", "Invalid parameters");
+        return;
+    }
+    
+    // Checked here for the 409, armed by loop()
+    PortCommand command = {};
+    CaptureCommand& c = command.capture;
+    command.type = CMD_CAPTURE_ARM;
+    c.port = port;
+    c.trigger = trigger == "dip" ? CAPTURE_TRIGGER_DIP : CAPTURE_TRIGGER_LOAD;
+    c.preMs = preMs;
+    c.postMs = postMs;
+    c.dipMv = dipMv;
+    
+    const char* refused = capture->checkArm(c.port, c.trigger);
+    if (refused) {
+        request->send(409, "text/plain", refused);
+        return;
+    }
+    if (!commands || !commands->push(command)) {
+        request->send(503, "text/plain", "Busy");
+        return;
+    }
+    request->send(202, "text/plain", "Armed");
+}
+
+void WebUI::handleCancelCapture(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
+    if (capture) capture->cancel();
+    request->send(200, "text/plain", "OK");
+}
+
+void WebUI::handleSetStream(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
+    float v = request->hasParam("voltage", true) ? request->getParam("voltage", true)->value().toFloat() : sseDeadbandV;
+    float a = request->hasParam("current", true) ? request->getParam("current", true)->value().toFloat() : sseDeadbandA;
+    float mah = request->hasParam("mAh", true) ? request->getParam("mAh", true)->value().toFloat() : sseDeadbandMah;
+    if (v < 0 || a < 0 || mah < 0) {
+        request->send(400, "text/plain", "Invalid parameters");
+        return;
+    }
+    
+    sseDeadbandV = v;
+    sseDeadbandA = a;
+    sseDeadbandMah = mah;
+    request->send(200, "text/plain", "OK");
+}
+
+// Compression tolerances: what the log history keeps
+void WebUI::handleSetCompression(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
+    static const char* PARAMS[SIGNAL_COUNT] = { "voltage", "current", "power" };
+    
+    // loop() applies it between samples; parameters left out are not sent
+    PortCommand command;
+    command.type = CMD_COMPRESSION;
+    command.compression.fields = 0;
+    for (int s = 0; s < SIGNAL_COUNT; s++) {
+        command.compression.tolerance[s] = 0;
+        if (!request->hasParam(PARAMS[s], true)) continue;
+        float value = request->getParam(PARAMS[s], true)->value().toFloat();
+        if (!isfinite(value) || value < 0) {
+            request->send(400, "text/plain", "Invalid parameters");
+            return;
+        }
+        command.compression.tolerance[s] = value;
+        command.compression.fields |= 1 << s;
+    }
+    
+    if (!commands || !commands->push(command)) {
+        request->send(503, "text/plain", "Busy");
+        return;
+    }
+    request->send(200, "text/plain", "OK");
+}
+
+void WebUI::handleGetOta(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
+    if (!ota) {
+        request->send(503, "text/plain", "OTA unavailable");
+        return;
+    }
+    
+    StaticJsonDocument<JSON_OTA_SIZE> doc;
+    ota->addStatusJSON(doc.to<JsonObject>());
+    
+    String output;
+    serializeJson(doc, output);
+    request->send(200, "application/json", output);
+}
+
+// Starts the background download; the device pulls the image itself
+// Sends 403 unless the request carries OTA_KEY. Compares every byte so
+// the reply time does not give away how much of a guess matched.
+bool WebUI::checkOtaKey(AsyncWebServerRequest *request) {
+    static const char expected[] = OTA_KEY;
+    const size_t expectedLen = sizeof(expected) - 1;
+    
+    if (expectedLen == 0) {
+        request->send(403, "text/plain", "OTA disabled (no OTA_KEY)");
+        return false;
+    }
+    
+    bool match = false;
+    if (request->hasParam("key", true)) {
+        const String& key = request->getParam("key", true)->value();
+        uint8_t diff = key.length() == expectedLen ? 0 : 1;
+        for (size_t i = 0; i < expectedLen; i++) {
+            uint8_t c = i < key.length() ? (uint8_t)key[i] : 0;
+            diff |= c ^ (uint8_t)expected[i];
+        }
+        match = diff == 0;
+    }
+    
+    if (!match) {
+        request->send(403, "text/plain", "Invalid key");
+    }
+    return match;
+}
+
+void WebUI::handleStartOta(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
+    if (!checkOtaKey(request)) return;
+    
+    if (!ota || !request->hasParam("url", true) || !request->hasParam("sha256", true)) {
+        request->send(400, "text/plain", "Invalid parameters");
+        return;
+    }
+    
+    String url = request->getParam("url", true)->value();
+    String sha256 = request->getParam("sha256", true)->value();
+    bool validHash = sha256.length() == 64;
+    for (size_t i = 0; validHash && i < sha256.length(); i++) {
+        validHash = isxdigit((unsigned char)sha256[i]);
+    }
+    if (!url.startsWith("http://") || url.length() >= OTA_URL_MAX || !validHash) {
+        request->send(400, "text/plain", "Invalid parameters");
+        return;
+    }
+    
+    bool force = false;
+    if (request->hasParam("force", true)) {
+        String value = request->getParam("force", true)->value();
+        force = value == "1" || value == "true";
+    }
+    
+    const char* error = ota->start(url.c_str(), sha256.c_str(), force);
+    if (error) {
+        request->send(409, "text/plain", error);
+        return;
+    }
+    request->send(202, "text/plain", "Started");
+}
+
+void WebUI::handleCancelOta(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
+    if (!checkOtaKey(request)) return;
+    
+    const char* error = ota ? ota->cancel() : nullptr;
+    if (error) {
+        request->send(409, "text/plain", error);
+        return;
+    }
+    request->send(200, "text/plain", "OK");
+}
+
+// Format into a stack buffer and write to the stream. Print::printf falls
+// back to malloc for lines over 64 bytes, which most metric and result lines are.
+static void streamPrintf(AsyncResponseStream *out, const char* format, ...) {
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    
+    if (len > 0) {
+        out->write((const uint8_t*)line, len < (int)sizeof(line) ? len : sizeof(line) - 1);
+    }
+}
+
+// Prometheus text exposition format (version 0.0.4). Rendered line by line
+// straight into the response stream - no intermediate String objects.
+void WebUI::handleMetrics(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
+    AsyncResponseStream *response = request->beginResponseStream("text/plain; version=0.0.4");
+    
+    // Per-port gauges
+    struct PortGauge {
+        const char* name;
+        const char* help;
+        int field;
+    };
+    static const PortGauge gauges[] = {
+        {"charger_port_voltage_volts", "Filtered battery voltage", 0},
+        {"charger_port_current_amps", "Filtered battery current", 1},
+        {"charger_port_power_watts", "Instantaneous power", 2},
+        {"charger_port_capacity_mah", "Accumulated capacity since test start", 3},
+        {"charger_port_energy_wh", "Accumulated energy since test start", 4},
+        {"charger_port_status", "Port status (0=Idle 1=Active 2=Complete 3=Error)", 5},
+        {"charger_port_mode", "Operation mode (0=Safety 1=Charging 2=Discharging)", 6},
+        {"charger_port_active", "Port active flag", 7}
+    };
+    
+    for (const PortGauge& g : gauges) {
+        streamPrintf(response, "# HELP %s %s\n# TYPE %s gauge\n", g.name, g.help, g.name);
+        for (int i = 0; i < NUM_PORTS; i++) {
+            const PortData& p = portData[i];
+            float value = 0;
+            switch (g.field) {
+                case 0: value = p.voltage; break;
+                case 1: value = p.current; break;
+                case 2: value = p.power; break;
+                case 3: value = p.mAh; break;
+                case 4: value = p.Wh; break;
+                case 5: value = p.status; break;
+                case 6: value = p.mode; break;
+                case 7: value = p.active ? 1 : 0; break;
+            }
+            streamPrintf(response, "%s{port=\"%d\"} %.4f\n", g.name, i, value);
+        }
+    }
+    
+    // Per-port counters
+    struct PortCounter {
+        const char* name;
+        const char* help;
+        uint32_t PortData::*field;
+    };
+    static const PortCounter counters[] = {
+        {"charger_port_samples_total", "Valid samples taken", &PortData::sampleCount},
+        {"charger_port_invalid_readings_total", "Readings rejected by validation", &PortData::invalidCount},
+        {"charger_port_i2c_errors_total", "Failed INA226 I2C transactions", &PortData::i2cErrorCount}
+    };
+    
+    for (const PortCounter& c : counters) {
+        streamPrintf(response, "# HELP %s %s\n# TYPE %s counter\n", c.name, c.help, c.name);
+        for (int i = 0; i < NUM_PORTS; i++) {
+            streamPrintf(response, "%s{port=\"%d\"} %u\n", c.name, i, portData[i].*(c.field));
+        }
+    }
+    
+    // Loop stage timing histograms (power-of-4 boundaries from 4us to ~1s)
+    streamPrintf(response, "# HELP charger_stage_duration_seconds Time spent per loop stage\n"
+                           "# TYPE charger_stage_duration_seconds histogram\n");
+    for (int i = 0; i < PROF_COUNT; i++) {
+        ProfileStats st;
+        Profiler::getSnapshot((ProfileSlot)i, st);
+        const char* stage = Profiler::getName((ProfileSlot)i);
+        
+        for (uint32_t le = 4; le <= 1048576; le *= 4) {
+            streamPrintf(response, "charger_stage_duration_seconds_bucket{stage=\"%s\",le=\"%.6f\"} %u\n",
+                         stage, le / 1000000.0, Profiler::countAtOrBelowUs(st, le));
+        }
+        streamPrintf(response, "charger_stage_duration_seconds_bucket{stage=\"%s\",le=\"+Inf\"} %u\n",
+                     stage, st.count);
+        streamPrintf(response, "charger_stage_duration_seconds_sum{stage=\"%s\"} %.6f\n",
+                     stage, Profiler::cyclesToSeconds(st.totalCycles));
+        streamPrintf(response, "charger_stage_duration_seconds_count{stage=\"%s\"} %u\n",
+                     stage, st.count);
+    }
+    
+    // Heap
+    HeapSnapshot heap;
+    HeapMonitor::getSnapshot(heap);
+    streamPrintf(response, "# HELP charger_heap_free_bytes Free heap\n"
+                           "# TYPE charger_heap_free_bytes gauge\n"
+                           "charger_heap_free_bytes %u\n", heap.freeHeap);
+    streamPrintf(response, "# HELP charger_heap_largest_block_bytes Largest free heap block\n"
+                           "# TYPE charger_heap_largest_block_bytes gauge\n"
+                           "charger_heap_largest_block_bytes %u\n", heap.largestBlock);
+    streamPrintf(response, "# HELP charger_heap_min_free_bytes Lowest free heap since boot\n"
+                           "# TYPE charger_heap_min_free_bytes gauge\n"
+                           "charger_heap_min_free_bytes %u\n", heap.minFreeHeap);
+    streamPrintf(response, "# HELP charger_uptime_seconds Time since boot\n"
+                           "# TYPE charger_uptime_seconds counter\n"
+                           "charger_uptime_seconds %lu\n", millis() / 1000);
+    
+    request->send(response);
+}
+
+struct ResultStreamContext {
+    AsyncResponseStream *out;
+    bool first;
+};
+
+static void streamResult(const CellResult& r, void* ctx) {
+    ResultStreamContext* c = (ResultStreamContext*)ctx;
+    streamPrintf(c->out, "%s{\"id\":%u,\"cell\":\"%.12s\",\"mAh\":%.1f,\"Wh\":%.3f,"
+                         "\"duration\":%u,\"dcir\":%.1f,\"batteryType\":%u,\"port\":%u}",
+                 c->first ? "" : ",", r.id, r.label, r.capacityMah, r.energyWh,
+                 r.durationSec, r.dcirTenthMilliOhm / 10.0f, r.batteryType, r.port);
+    c->first = false;
+}
+
+// Finished cells in ascending capacity. Streamed record by record so a
+// large result set never has to fit in one JSON document.
+void WebUI::handleGetResults(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
+    if (!results) {
+        request->send(503, "text/plain", "Result store unavailable");
+        return;
+    }
+    
+    long minMah = request->hasParam("min") ? request->getParam("min")->value().toInt() : 0;
+    long maxMah = request->hasParam("max") ? request->getParam("max")->value().toInt() : 65535;
+    long limit = request->hasParam("limit") ? request->getParam("limit")->value().toInt() : RESULT_QUERY_LIMIT;
+    minMah = constrain(minMah, 0, 65535);
+    maxMah = constrain(maxMah, 0, 65535);
+    limit = constrain(limit, 0, RESULT_QUERY_LIMIT);
+    
+    AsyncResponseStream *response = request->beginResponseStream("application/json");
+    streamPrintf(response, "{\"total\":%u,\"matched\":%u,\"results\":[",
+                 results->getCount(), results->countInRange(minMah, maxMah));
+    
+    ResultStreamContext ctx = {response, true};
+    results->query(minMah, maxMah, limit, streamResult, &ctx);
+    
+    streamPrintf(response, "]}");
+    request->send(response);
+}
+
+void WebUI::handleClearResults(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
+    if (!results || !results->clear()) {
+        request->send(500, "text/plain", "Clear failed");
+        return;
+    }
+    request->send(200, "text/plain", "OK");
+}
+
+// Label the cell on a port; stored with its result when the discharge completes
+void WebUI::handleSetCell(AsyncWebServerRequest *request) {
+    ScopedHeapTag heapTag(HEAP_WEB_API);
+    
+    if (!request->hasParam("port", true) || !request->hasParam("label", true)) {
+        request->send(400, "text/plain", "Invalid parameters");
+        return;
+    }
+    
+    int port = request->getParam("port", true)->value().toInt();
+    String label = request->getParam("label", true)->value();
+    if (port < 0 || port >= NUM_PORTS || label.length() >= sizeof(portData[port].cellLabel)) {
+        request->send(400, "text/plain", "Invalid parameters");
+        return;
+    }
+    
+    // Restrict to characters that need no escaping in JSON or CSV
+    for (size_t i = 0; i < label.length(); i++) {
+        char c = label[i];
+        if (!isalnum(c) && c != '-' && c != '_' && c != '.') {
+            request->send(400, "text/plain", "Invalid label");
+            return;
+        }
+    }
+    
+    PortCommand command = {};
+    command.type = CMD_CELL_LABEL;
+    command.label.port = port;
+    strlcpy(command.label.label, label.c_str(), sizeof(command.label.label));
+    if (!commands || !commands->push(command)) {
+        request->send(503, "text/plain", "Busy");
+        return;
+    }
+    request->send(200, "text/plain", "OK");
+}
+
 // ============================================
 // WEBSOCKET HANDLERS
 // ============================================
@@ -356,28 +1343,228 @@ void WebUI::onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
                       AwsEventType type, void *arg, uint8_t *data, size_t len) {
     if (type == WS_EVT_CONNECT) {
         DEBUG_PRINTF("WebSocket client #%u connected\n", client->id());
+        
+        // New sockets get every port at the default rate until they subscribe
+        portENTER_CRITICAL(&subscriberLock);
+        WsSubscriber* sub = findSubscriber(0);
+        if (sub) {
+            memset(sub, 0, sizeof(WsSubscriber));
+            sub->id = client->id();
+            sub->portMask = WS_ALL_PORTS;
+            sub->intervalMs = WS_UPDATE_INTERVAL;
+            sub->lastSent = millis();
+            sub->sent = 1;
+        }
+        portEXIT_CRITICAL(&subscriberLock);
+        
+        if (!sub) {
+            client->close();
+            return;
+        }
         client->text(getStatusJSON());
     } else if (type == WS_EVT_DISCONNECT) {
         DEBUG_PRINTF("WebSocket client #%u disconnected\n", client->id());
+        portENTER_CRITICAL(&subscriberLock);
+        WsSubscriber* sub = findSubscriber(client->id());
+        if (sub) sub->id = 0;
+        portEXIT_CRITICAL(&subscriberLock);
+    } else if (type == WS_EVT_DATA) {
+        // Commands are short: whole, unfragmented text frames only
+        AwsFrameInfo *info = (AwsFrameInfo*)arg;
+        if (info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT) {
+            handleWsMessage(client, data, len);
+        }
+    }
+}
+
+// Caller holds subscriberLock
+WsSubscriber* WebUI::findSubscriber(uint32_t id) {
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (subscribers[i].id == id) return &subscribers[i];
+    }
+    return nullptr;
+}
+
+// Copy of one slot; false if it is free
+bool WebUI::readSubscriber(int slot, WsSubscriber& out) {
+    portENTER_CRITICAL(&subscriberLock);
+    out = subscribers[slot];
+    portEXIT_CRITICAL(&subscriberLock);
+    return out.id != 0;
+}
+
+// {"ports":[0,2],"interval":5000} - either key may be left out;
+// "ports":"all" restores every port
+void WebUI::handleWsMessage(AsyncWebSocketClient *client, const uint8_t *data, size_t len) {
+    StaticJsonDocument<JSON_WS_COMMAND_SIZE> doc;
+    if (deserializeJson(doc, (const char*)data, len)) {
+        DEBUG_PRINTF("WebSocket client #%u: bad command\n", client->id());
+        return;
+    }
+    JsonObjectConst cmd = doc.as<JsonObjectConst>();
+    
+    bool setMask = cmd.containsKey("ports");
+    uint32_t mask = WS_ALL_PORTS;
+    if (setMask && cmd["ports"].is<JsonArrayConst>()) {
+        mask = 0;
+        for (JsonVariantConst p : cmd["ports"].as<JsonArrayConst>()) {
+            int port = p.as<int>();
+            if (port >= 0 && port < NUM_PORTS) mask |= 1UL << port;
+        }
+    }
+    
+    bool setInterval = cmd.containsKey("interval");
+    long interval = constrain(cmd["interval"].as<long>(), (long)WS_UPDATE_INTERVAL, (long)WS_MAX_INTERVAL_MS);
+    
+    portENTER_CRITICAL(&subscriberLock);
+    WsSubscriber* sub = findSubscriber(client->id());
+    if (sub) {
+        if (setMask) sub->portMask = mask;
+        if (setInterval) sub->intervalMs = interval;
+        
+        // Answer with a frame in the new shape at the next push
+        sub->lastSent = millis() - sub->intervalMs;
+        mask = sub->portMask;
+        interval = sub->intervalMs;
+    }
+    portEXIT_CRITICAL(&subscriberLock);
+    
+    if (sub) {
+        DEBUG_PRINTF("WebSocket client #%u: ports 0x%x every %lums\n",
+                     client->id(), mask, interval);
     }
 }
 
+// Every client gets its own ports at its own rate. A client whose queue
+// is still full is skipped rather than queued to: status frames are
+// snapshots, so it receives the newest one once it drains (coalesced).
+// One that stays full for WS_STALL_CLOSE_MS is closed, so a phone on a
+// weak link cannot hold heap for everyone else.
 void WebUI::broadcastStatus() {
-    if (ws->count() > 0) {
-        ws->textAll(getStatusJSON());
+    ScopedHeapTag heapTag(HEAP_WS_BROADCAST);
+    
+    if (ws->count() == 0 && events->count() == 0) return;
+    
+    unsigned long now = millis();
+    
+    // One serialization per distinct port selection per push, shared by
+    // every WebSocket subscriber and all SSE clients
+    uint32_t frameMasks[WS_MAX_CLIENTS + 1];
+    String frames[WS_MAX_CLIENTS + 1];
+    int frameCount = 0;
+    auto frameFor = [&](uint32_t mask) -> const String& {
+        int f = 0;
+        while (f < frameCount && frameMasks[f] != mask) f++;
+        if (f == frameCount) {
+            frameMasks[f] = mask;
+            frames[f] = getStatusJSON(mask);
+            frameCount++;
+        }
+        return frames[f];
+    };
+    
+    // Each slot is worked on as a copy; only the push bookkeeping goes
+    // back, and only if the socket still holds the slot
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        WsSubscriber sub;
+        if (!readSubscriber(i, sub)) continue;
+        unsigned long lastSent = sub.lastSent;
+        
+        AsyncWebSocketClient *client = ws->client(sub.id);
+        if (!client) continue;
+        
+        // Half a push period of slack so scheduling jitter never skips a beat
+        if (now - sub.lastSent + WS_UPDATE_INTERVAL / 2 < sub.intervalMs) continue;
+        
+        bool full = client->queueIsFull();
+        if (full) {
+            if (!sub.queueFull) sub.fullSince = now;
+            sub.coalesced++;
+            if (now - sub.fullSince >= WS_STALL_CLOSE_MS) {
+                DEBUG_PRINTF("WebSocket client #%u stalled, closing\n", sub.id);
+                client->close();
+            }
+        } else {
+            client->text(frameFor(sub.portMask));
+            sub.lastSent = now;
+            sub.sent++;
+        }
+        sub.queueFull = full;
+        
+        portENTER_CRITICAL(&subscriberLock);
+        WsSubscriber& slot = subscribers[i];
+        if (slot.id == sub.id) {
+            // A subscribe in between asked for an immediate push: keep that
+            if (slot.lastSent == lastSent) slot.lastSent = sub.lastSent;
+            slot.fullSince = sub.fullSince;
+            slot.queueFull = sub.queueFull;
+            slot.sent = sub.sent;
+            slot.coalesced = sub.coalesced;
+        }
+        portEXIT_CRITICAL(&subscriberLock);
+    }
+    
+    // SSE: only the ports that moved past a deadband, one event for all clients
+    if (events->count() > 0) {
+        uint32_t changed = getStreamChanges();
+        if (changed) {
+            events->send(frameFor(changed).c_str(), "status", ++sseEventId);
+        }
+    }
+}
+
+// Ports whose state changed or whose values left the deadband since they
+// were last streamed; those values become the new reference
+uint32_t WebUI::getStreamChanges() {
+    uint32_t mask = 0;
+    for (int i = 0; i < NUM_PORTS; i++) {
+        const PortData& p = portData[i];
+        SsePortState& last = sseSent[i];
+        
+        bool changed = p.mode != last.mode || p.batteryType != last.batteryType ||
+                       p.status != last.status || p.active != last.active ||
+                       p.getCutoffVoltage() != last.cutoff || p.dcir != last.dcir ||
+                       fabs(p.voltage - last.voltage) > sseDeadbandV ||
+                       fabs(p.current - last.current) > sseDeadbandA ||
+                       fabs(p.mAh - last.mAh) > sseDeadbandMah;
+        if (!changed) continue;
+        
+        last.voltage = p.voltage;
+        last.current = p.current;
+        last.mAh = p.mAh;
+        last.cutoff = p.getCutoffVoltage();
+        last.dcir = p.dcir;
+        last.mode = p.mode;
+        last.batteryType = p.batteryType;
+        last.status = p.status;
+        last.active = p.active;
+        mask |= 1UL << i;
     }
+    return mask;
 }
 
 // ============================================
 // JSON GENERATION
 // ============================================
 
-String WebUI::getStatusJSON() {
-    StaticJsonDocument<2048> doc;
+String WebUI::getStatusJSON(uint32_t portMask) {
+    ScopedTimer timer(PROF_JSON);
+    
+    // Heap, not the loop stack: 16 ports need ~5KB (plus remote units on a gateway)
+    size_t capacity = JSON_STATUS_SIZE;
+    int unitCount = 0;
+    if (gateway && gateway->isGateway()) {
+        unitCount = gateway->getUnitCount();
+        capacity += gateway->getJsonCapacity(unitCount);
+    }
+    DynamicJsonDocument doc(capacity);
     JsonArray ports = doc.createNestedArray("ports");
     
     for (int i = 0; i < NUM_PORTS; i++) {
+        if (!(portMask & (1UL << i))) continue;
+        
         JsonObject port = ports.createNestedObject();
+        port["port"] = i;
         port["voltage"] = portData[i].voltage;
         port["current"] = portData[i].current;
         port["power"] = portData[i].power;
@@ -388,6 +1575,124 @@ String WebUI::getStatusJSON() {
         port["customCutoff"] = portData[i].customCutoff;
         port["status"] = portData[i].status;
         port["active"] = portData[i].active;
+        port["dcir"] = portData[i].dcir;
+        port["cell"] = portData[i].cellLabel;
+    }
+    
+    // Gateway role: every remote unit's ports, read-only
+    if (gateway && gateway->isGateway()) {
+        gateway->addUnitsJSON(doc.createNestedArray("units"), unitCount);
+    }
+    
+    doc["power"] = PowerManager::getStateName(power ? power->getState() : POWER_ACTIVE);
+    
+    HeapSnapshot heap;
+    HeapMonitor::getSnapshot(heap);
+    JsonObject heapObj = doc.createNestedObject("heap");
+    heapObj["free"] = heap.freeHeap;
+    heapObj["largestBlock"] = heap.largestBlock;
+    heapObj["minFree"] = heap.minFreeHeap;
+    heapObj["minLargestBlock"] = heap.minLargestBlock;
+    heapObj["fragmentation"] = heap.fragmentation;
+    heapObj["failedAllocs"] = heap.failedAllocs;
+    
+    JsonObject allocs = heapObj.createNestedObject("allocs");
+    for (int i = 0; i < HEAP_SUBSYSTEM_COUNT; i++) {
+        HeapSubsystemStats sub;
+        HeapMonitor::getSubsystemStats((HeapSubsystem)i, sub);
+        JsonObject entry = allocs.createNestedObject(HeapMonitor::getName((HeapSubsystem)i));
+        entry["calls"] = sub.calls;
+        entry["allocs"] = sub.allocs;
+        entry["bytes"] = sub.allocBytes;
+    }
+    
+    String output;
+    serializeJson(doc, output);
+    return output;
+}
+
+String WebUI::getPerfJSON() {
+    DynamicJsonDocument doc(JSON_PERF_SIZE);
+    doc["uptime"] = millis() / 1000;
+    doc["cpuMHz"] = ESP.getCpuFreqMHz();
+    JsonArray slots = doc.createNestedArray("slots");
+    
+    for (int i = 0; i < PROF_COUNT; i++) {
+        ProfileStats s;
+        Profiler::getSnapshot((ProfileSlot)i, s);
+        
+        JsonObject slot = slots.createNestedObject();
+        slot["name"] = Profiler::getName((ProfileSlot)i);
+        slot["count"] = s.count;
+        slot["minUs"] = s.count ? Profiler::cyclesToUs(s.minCycles) : 0;
+        slot["avgUs"] = Profiler::getAverageUs(s);
+        slot["p99Us"] = Profiler::getPercentileUs(s, 99);
+        slot["maxUs"] = Profiler::cyclesToUs(s.maxCycles);
+    }
+    
+    JsonArray schedule = doc.createNestedArray("schedule");
+    for (int i = 0; i < SCHED_COUNT; i++) {
+        ScheduleStats s;
+        Scheduler::getStats((ScheduleSlot)i, s);
+        
+        JsonObject entry = schedule.createNestedObject();
+        entry["name"] = Scheduler::getName((ScheduleSlot)i);
+        entry["periodUs"] = s.periodUs;
+        entry["runs"] = s.runs;
+        entry["skipped"] = s.skipped;
+        entry["maxLateUs"] = s.maxLateUs;
+    }
+    
+    if (power) {
+        JsonObject powerObj = doc.createNestedObject("power");
+        powerObj["state"] = PowerManager::getStateName(power->getState());
+        powerObj["wakeups"] = power->getWakeups();
+        powerObj["activeMs"] = power->getTimeInState(POWER_ACTIVE);
+        powerObj["dimMs"] = power->getTimeInState(POWER_DIM);
+        powerObj["sleepMs"] = power->getTimeInState(POWER_SLEEP);
+    }
+    
+    JsonObject net = doc.createNestedObject("network");
+    net["hostname"] = hostname;
+    net["ap"] = NET_MODE != NET_MODE_STA || apFallback;
+    net["apStations"] = WiFi.softAPgetStationNum();
+    net["sta"] = staConnected;
+    if (staConnected) {
+        net["ip"] = WiFi.localIP().toString();
+        net["rssi"] = WiFi.RSSI();
+    }
+    net["wsClients"] = ws->count();
+    
+    JsonArray sockets = doc.createNestedArray("websocket");
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        WsSubscriber sub;
+        if (!readSubscriber(i, sub)) continue;
+        JsonObject entry = sockets.createNestedObject();
+        entry["id"] = sub.id;
+        entry["ports"] = sub.portMask;
+        entry["intervalMs"] = sub.intervalMs;
+        entry["sent"] = sub.sent;
+        entry["coalesced"] = sub.coalesced;
+        entry["queueFull"] = sub.queueFull;
+        entry["fullMs"] = sub.queueFull ? millis() - sub.fullSince : 0;
+    }
+    
+    JsonObject stream = doc.createNestedObject("stream");
+    stream["clients"] = events->count();
+    stream["events"] = sseEventId;
+    stream["deadbandV"] = sseDeadbandV;
+    stream["deadbandA"] = sseDeadbandA;
+    stream["deadbandMah"] = sseDeadbandMah;
+    
+    if (compressor) {
+        compressor->addStatsJSON(doc.createNestedObject("compression"));
+    }
+    if (commands) {
+        commands->addStatsJSON(doc.createNestedObject("commands"));
+    }
+    
+    if (gateway) {
+        gateway->addStatsJSON(doc.createNestedObject("gateway"));
     }
     
     String output;
@@ -395,8 +1700,12 @@ String WebUI::getStatusJSON() {
     return output;
 }
 
+// Events go to every client with room; a backed-up one misses them
 void WebUI::notifyClients(const String& message) {
-    if (ws->count() > 0) {
-        ws->textAll(message);
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        WsSubscriber sub;
+        if (!readSubscriber(i, sub)) continue;
+        AsyncWebSocketClient *client = ws->client(sub.id);
+        if (client && !client->queueIsFull()) client->text(message);
     }
 }
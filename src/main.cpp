@@ -4,6 +4,18 @@
 #include "Logger.h"
 #include "WebUI.h"
 #include "UI.h"
+#include "Profiler.h"
+#include "HeapMonitor.h"
+#include "Scheduler.h"
+#include "Checkpoint.h"
+#include "ConfigStore.h"
+#include "ResultStore.h"
+#include "PowerManager.h"
+#include "Gateway.h"
+#include "Capture.h"
+#include "Compressor.h"
+#include "CommandQueue.h"
+#include "Ota.h"
 
 // ============================================
 // GLOBAL OBJECTS
@@ -13,28 +25,112 @@ PortData portData[NUM_PORTS];
 BatteryLogger* logger;
 WebUI* webUI;
 PhysicalUI* physicalUI;
+CheckpointStore* checkpoint;
+ConfigStore* configStore;
+ResultStore* resultStore;
+PowerManager* power;
+GatewayLink* gateway;
+WaveformCapture* capture;
+TelemetryCompressor* compressor;
+CommandQueue* commands;
+OtaUpdater* ota;
 
 // ============================================
 // MOSFET CONTROL
 // ============================================
 
+#if MOSFET_SHIFT_REGISTER
+static uint8_t mosfetBits[SR_BYTES];
+static uint8_t mosfetLatched[SR_BYTES];
+
+// Last register in the chain first, so bit n ends up on port n
+static void latchMOSFETs() {
+    for (int b = SR_BYTES - 1; b >= 0; b--) {
+        shiftOut(SR_DATA_PIN, SR_CLOCK_PIN, MSBFIRST, mosfetBits[b]);
+    }
+    digitalWrite(SR_LATCH_PIN, HIGH);
+    digitalWrite(SR_LATCH_PIN, LOW);
+    memcpy(mosfetLatched, mosfetBits, SR_BYTES);
+}
+#endif
+
 void initMOSFETs() {
+#if MOSFET_SHIFT_REGISTER
+    // Outputs stay high-Z until an all-off frame is latched
+    pinMode(SR_OE_PIN, OUTPUT);
+    digitalWrite(SR_OE_PIN, HIGH);
+    pinMode(SR_DATA_PIN, OUTPUT);
+    pinMode(SR_CLOCK_PIN, OUTPUT);
+    pinMode(SR_LATCH_PIN, OUTPUT);
+    digitalWrite(SR_CLOCK_PIN, LOW);
+    digitalWrite(SR_LATCH_PIN, LOW);
+    memset(mosfetBits, 0, sizeof(mosfetBits));
+    latchMOSFETs();
+    digitalWrite(SR_OE_PIN, LOW);
+    DEBUG_PRINTF("MOSFETs initialized (%d x 74HC595)\n", SR_BYTES);
+#else
     for (int i = 0; i < NUM_PORTS; i++) {
         pinMode(MOSFET_PINS[i], OUTPUT);
         digitalWrite(MOSFET_PINS[i], LOW); // OFF by default
     }
     DEBUG_PRINTLN("MOSFETs initialized");
+#endif
+}
+
+static void setMOSFET(int port, bool on) {
+#if MOSFET_SHIFT_REGISTER
+    if (on) {
+        mosfetBits[port / 8] |= 1 << (port % 8);
+    } else {
+        mosfetBits[port / 8] &= ~(1 << (port % 8));
+    }
+#else
+    digitalWrite(MOSFET_PINS[port], on ? HIGH : LOW);
+#endif
+}
+
+// Load-step capture: the gate switches at the exact sample boundary
+static void switchLoad(int port, bool on) {
+    setMOSFET(port, on);
+#if MOSFET_SHIFT_REGISTER
+    latchMOSFETs();
+#endif
 }
 
 void updateMOSFETs() {
+    // Per port: when a started port began waiting for its first reading
+    static unsigned long waitingSince[NUM_PORTS];
+    static bool waiting[NUM_PORTS];
+    unsigned long now = millis();
+    
     for (int i = 0; i < NUM_PORTS; i++) {
         bool shouldBeOn = false;
         PortStatus previousStatus = portData[i].status;
         
+        // A sensor that never answers would leave the port ACTIVE, load off, forever
+        if (portData[i].active && !logger->hasSample(i)) {
+            if (!waiting[i]) {
+                waiting[i] = true;
+                waitingSince[i] = now;
+            } else if (now - waitingSince[i] >= FIRST_SAMPLE_TIMEOUT_MS) {
+                portData[i].status = ERROR;
+                portData[i].active = false;
+                snprintf(portData[i].errorMsg, 64, "No reading");
+                DEBUG_PRINTF("Port %d: no reading after start\n", i);
+                if (previousStatus != ERROR) {
+                    physicalUI->notifyError(i);
+                }
+            }
+        } else {
+            waiting[i] = false;
+        }
+        
         // MOSFET ON only during discharge mode
         if (portData[i].mode == DISCHARGING && portData[i].active) {
-            // Check if voltage is above cutoff
-            if (portData[i].voltage > portData[i].getCutoffVoltage()) {
+            // Check if voltage is above cutoff (only once it has been measured)
+            if (!logger->hasSample(i)) {
+                portData[i].status = ACTIVE;
+            } else if (portData[i].voltage > portData[i].getCutoffVoltage()) {
                 shouldBeOn = true;
                 portData[i].status = ACTIVE;
             } else {
@@ -43,9 +139,10 @@ void updateMOSFETs() {
                 portData[i].active = false;
                 DEBUG_PRINTF("Port %d: Discharge complete (%.3fV)\n", i, portData[i].voltage);
                 
-                // Notify UI if status changed
+                // Notify UI and store the cell result if status changed
                 if (previousStatus != COMPLETE) {
                     physicalUI->notifyComplete(i);
+                    resultStore->recordCompletion(i);
                 }
             }
         }
@@ -100,9 +197,21 @@ void updateMOSFETs() {
             }
         }
         
+        // DCIR open-circuit phase / load-step capture - keep load off briefly
+        if (shouldBeOn && (logger->isLoadHeld(i) || capture->isLoadHeld(i))) {
+            shouldBeOn = false;
+        }
+        
         // Apply MOSFET state
-        digitalWrite(MOSFET_PINS[i], shouldBeOn ? HIGH : LOW);
+        setMOSFET(i, shouldBeOn);
+    }
+    
+#if MOSFET_SHIFT_REGISTER
+    // One frame for all ports, only when a gate changed
+    if (memcmp(mosfetBits, mosfetLatched, SR_BYTES) != 0) {
+        latchMOSFETs();
     }
+#endif
 }
 
 // ============================================
@@ -110,15 +219,31 @@ void updateMOSFETs() {
 // ============================================
 
 void printSystemStatus() {
-    static unsigned long lastPrint = 0;
-    
-    if (millis() - lastPrint < 10000) return; // Print every 10 seconds
-    lastPrint = millis();
+    if (!Scheduler::due(SCHED_STATUS_PRINT)) return;
     
     DEBUG_PRINTLN("\n===== System Status =====");
     DEBUG_PRINTF("Uptime: %lu seconds\n", millis() / 1000);
-    DEBUG_PRINTF("Free heap: %d bytes\n", ESP.getFreeHeap());
+    HeapSnapshot heap;
+    HeapMonitor::getSnapshot(heap);
+    DEBUG_PRINTF("Free heap: %u bytes (min %u)\n", heap.freeHeap, heap.minFreeHeap);
+    DEBUG_PRINTF("Largest block: %u bytes (min %u), fragmentation %u%%\n",
+                 heap.largestBlock, heap.minLargestBlock, heap.fragmentation);
+    if (heap.failedAllocs > 0) {
+        DEBUG_PRINTF("Failed allocations: %u\n", heap.failedAllocs);
+    }
+    for (int i = 0; i < HEAP_SUBSYSTEM_COUNT; i++) {
+        HeapSubsystemStats sub;
+        HeapMonitor::getSubsystemStats((HeapSubsystem)i, sub);
+        if (sub.calls == 0) continue;
+        DEBUG_PRINTF("  %-12s calls %u, allocs %u, bytes %u\n",
+                     HeapMonitor::getName((HeapSubsystem)i), sub.calls, sub.allocs, sub.allocBytes);
+    }
     DEBUG_PRINTF("WiFi clients: %d\n", WiFi.softAPgetStationNum());
+    if (NET_MODE != NET_MODE_AP) {
+        DEBUG_PRINTF("Station: %s\n", WiFi.status() == WL_CONNECTED ? WiFi.localIP().toString().c_str() : "not connected");
+    }
+    DEBUG_PRINTF("Power: %s at %u MHz (%u wakeups)\n", PowerManager::getStateName(power->getState()),
+                 getCpuFrequencyMhz(), power->getWakeups());
     
     for (int i = 0; i < NUM_PORTS; i++) {
         DEBUG_PRINTF("\nPort %d: %s\n", i, portData[i].getStatusName());
@@ -129,12 +254,33 @@ void printSystemStatus() {
         DEBUG_PRINTF("  Power: %.2fW\n", portData[i].power);
         DEBUG_PRINTF("  Capacity: %.1f mAh\n", portData[i].mAh);
         DEBUG_PRINTF("  Energy: %.2f Wh\n", portData[i].Wh);
-        DEBUG_PRINTF("  Cutoff: %.1fV\n", portData[i].getCutoffVoltage());
+        DEBUG_PRINTF("  Cutoff: %.2fV\n", portData[i].getCutoffVoltage());
         
         if (portData[i].errorMsg[0] != '\0') {
             DEBUG_PRINTF("  Error: %s\n", portData[i].errorMsg);
         }
     }
+    
+    DEBUG_PRINTLN("\nTiming (us)       count    min    avg    p99    max");
+    for (int i = 0; i < PROF_COUNT; i++) {
+        ProfileStats s;
+        Profiler::getSnapshot((ProfileSlot)i, s);
+        if (s.count == 0) continue;
+        DEBUG_PRINTF("  %-12s %8u %6u %6u %6u %6u\n",
+                     Profiler::getName((ProfileSlot)i), s.count,
+                     Profiler::cyclesToUs(s.minCycles),
+                     Profiler::getAverageUs(s),
+                     Profiler::getPercentileUs(s, 99),
+                     Profiler::cyclesToUs(s.maxCycles));
+    }
+    
+    DEBUG_PRINTLN("\nSchedule      period ms    runs  skipped  max late us");
+    for (int i = 0; i < SCHED_COUNT; i++) {
+        ScheduleStats s;
+        Scheduler::getStats((ScheduleSlot)i, s);
+        DEBUG_PRINTF("  %-12s %9u %7u %8u %12u\n", Scheduler::getName((ScheduleSlot)i),
+                     s.periodUs / 1000, s.runs, s.skipped, s.maxLateUs);
+    }
     DEBUG_PRINTLN("========================\n");
 }
 
@@ -146,12 +292,10 @@ void syncUIStates() {
     // This function ensures Web UI and Physical UI stay in sync
     // Called periodically in main loop
     
-    static unsigned long lastSync = 0;
-    if (millis() - lastSync < 1000) return;
-    lastSync = millis();
+    if (!Scheduler::due(SCHED_UI_SYNC)) return;
     
     // Physical UI will force redraw if any state changed
-    static PortStatus lastStatus[NUM_PORTS] = {IDLE, IDLE, IDLE, IDLE};
+    static PortStatus lastStatus[NUM_PORTS] = {};   // IDLE
     
     for (int i = 0; i < NUM_PORTS; i++) {
         if (portData[i].status != lastStatus[i]) {
@@ -182,6 +326,14 @@ void setup() {
     // Initialize MOSFETs first (safety)
     initMOSFETs();
     
+    Profiler::begin();
+    HeapMonitor::begin();
+    
+    // Firmware updates over HTTP; counts this boot if the image is new, and
+    // reverts one that keeps failing before it could be confirmed
+    ota = new OtaUpdater(portData);
+    ota->begin();
+    
     // Initialize all ports to safety mode
     for (int i = 0; i < NUM_PORTS; i++) {
         portData[i].mode = SAFETY;
@@ -192,9 +344,22 @@ void setup() {
         portData[i].useCustomCutoff = false;
     }
     
+    // Restore saved battery type / cutoff / mode (ports stay inactive)
+    configStore = new ConfigStore(portData);
+    if (configStore->begin()) {
+        configStore->apply();
+    }
+    
+    // Finished-cell database (LittleFS)
+    resultStore = new ResultStore(portData);
+    if (!resultStore->begin()) {
+        DEBUG_PRINTLN("WARNING: Result store unavailable");
+    }
+    
     // Initialize Physical UI (OLED + Encoder + Buzzer)
     DEBUG_PRINTLN("Initializing Physical UI...");
     physicalUI = new PhysicalUI(portData);
+    physicalUI->setResultStore(resultStore);
     if (!physicalUI->begin()) {
         DEBUG_PRINTLN("WARNING: Physical UI failed to initialize");
     } else {
@@ -206,30 +371,96 @@ void setup() {
     // Initialize Logger (INA226)
     DEBUG_PRINTLN("Initializing Logger (INA226)...");
     logger = new BatteryLogger(portData);
+    logger->setConfigStore(configStore);
     if (!logger->begin()) {
         DEBUG_PRINTLN("WARNING: Some INA226 sensors failed");
     } else {
         DEBUG_PRINTLN("Logger ready!");
     }
     
+    // Waveform capture ring (allocated now, before the heap fragments)
+    capture = new WaveformCapture(portData);
+    capture->setLogger(logger);
+    capture->setLoadSwitch(switchLoad);
+    if (!capture->begin()) {
+        DEBUG_PRINTLN("WARNING: Waveform capture unavailable");
+    }
+    
+    // Swinging-door compression of the sample stream (log history + pushes)
+    compressor = new TelemetryCompressor(portData);
+    logger->setCompressor(compressor);
+    if (!compressor->begin()) {
+        DEBUG_PRINTLN("WARNING: Log history unavailable");
+    }
+    
     delay(500);
     
+    // Look for tests interrupted by a reset (ports stay in SAFETY until resumed)
+    checkpoint = new CheckpointStore(portData);
+    if (!checkpoint->begin()) {
+        DEBUG_PRINTLN("WARNING: Checkpoint store unavailable");
+    }
+    physicalUI->offerResume(checkpoint);
+    
+    // Port changes from the web task and encoder, applied in loop()
+    commands = new CommandQueue(portData);
+    commands->setCheckpointStore(checkpoint);
+    commands->setLogger(logger);
+    commands->setCapture(capture);
+    commands->setCompressor(compressor);
+    physicalUI->setCommandQueue(commands);
+    
     // Initialize Web UI (WiFi AP + HTTP Server)
     DEBUG_PRINTLN("Initializing Web UI...");
     webUI = new WebUI(portData);
-    if (!webUI->begin()) {
+    webUI->setCheckpointStore(checkpoint);
+    webUI->setLogger(logger);
+    webUI->setResultStore(resultStore);
+    webUI->setCapture(capture);
+    webUI->setCompressor(compressor);
+    webUI->setCommandQueue(commands);
+    webUI->setOta(ota);
+    bool webUp = webUI->begin();
+    if (!webUp) {
         DEBUG_PRINTLN("ERROR: Web UI failed to start");
     } else {
         DEBUG_PRINTLN("\nWeb UI started successfully!");
-        DEBUG_PRINT("  SSID: ");
-        DEBUG_PRINTLN(AP_SSID);
-        DEBUG_PRINT("  Password: ");
-        DEBUG_PRINTLN(AP_PASSWORD);
-        DEBUG_PRINT("  IP Address: http://");
-        DEBUG_PRINTLN(WiFi.softAPIP());
+        if (NET_MODE != NET_MODE_STA) {
+            DEBUG_PRINT("  SSID: ");
+            DEBUG_PRINTLN(AP_SSID);
+            DEBUG_PRINT("  Password: ");
+            DEBUG_PRINTLN(AP_PASSWORD);
+            DEBUG_PRINT("  IP Address: http://");
+            DEBUG_PRINTLN(WiFi.softAPIP());
+        }
+        DEBUG_PRINTF("  mDNS: http://%s.local\n", webUI->getHostname());
         DEBUG_PRINTLN("  Open browser to access dashboard");
     }
     
+    // ESP-NOW telemetry to / from other units (no-op when standalone)
+    gateway = new GatewayLink(portData);
+    if (!gateway->begin()) {
+        DEBUG_PRINTLN("WARNING: Gateway link unavailable");
+    }
+    webUI->setGateway(gateway);
+    
+    // Idle power mode (all ports in SAFETY, nobody at the controls)
+    power = new PowerManager(portData);
+    power->setLogger(logger);
+    power->setPhysicalUI(physicalUI);
+    power->setWebUI(webUI);
+    power->setCheckpointStore(checkpoint);
+    power->setOta(ota);
+    webUI->setPowerManager(power);
+    power->begin();
+    
+    // A new image is only confirmed once it has reached its sensors and network
+    bool sensorsUp = false;
+    for (int i = 0; i < NUM_PORTS; i++) {
+        if (logger->isPortReady(i)) sensorsUp = true;
+    }
+    if (sensorsUp && webUp) ota->setSystemUp();
+    
     DEBUG_PRINTLN("\n=====================================");
     DEBUG_PRINTLN("System ready!");
     DEBUG_PRINTLN("=====================================");
@@ -238,6 +469,9 @@ void setup() {
     DEBUG_PRINTLN("  - Press encoder: Select/Confirm");
     DEBUG_PRINTLN("  - Web UI: http://192.168.4.1");
     DEBUG_PRINTLN("=====================================\n");
+    
+    // Periodic deadlines start with the loop, not before setup's delays
+    Scheduler::begin();
 }
 
 // ============================================
@@ -245,24 +479,67 @@ void setup() {
 // ============================================
 
 void loop() {
-    // Update measurements from INA226
-    logger->update();
-    
-    // Update MOSFET states based on mode and voltage
-    updateMOSFETs();
-    
-    // Update Physical UI (OLED + Encoder + Buzzer)
-    physicalUI->update();
-    
-    // Update Web UI (WebSocket broadcasts)
-    webUI->update();
-    
-    // Sync UI states
-    syncUIStates();
-    
-    // Print status to serial (debug)
-    printSystemStatus();
+    {
+        ScopedTimer loopTimer(PROF_LOOP);
+        
+        // Update measurements from INA226
+        {
+            ScopedTimer timer(PROF_LOGGER);
+            logger->update();
+        }
+        
+        // Burst sampling while a waveform capture is armed
+        capture->update();
+        
+        // Queued mode/type/cutoff/start changes, whole batches at a time
+        commands->drain();
+        
+        // Update MOSFET states based on mode and voltage
+        {
+            ScopedTimer timer(PROF_MOSFET);
+            updateMOSFETs();
+        }
+        
+        // Close compression segments at mode/status changes (before the push)
+        compressor->update();
+        
+        // Snapshot for crash-safe resume (flash write runs on its own task)
+        checkpoint->update();
+        
+        // Persist settings changes (debounced)
+        configStore->update();
+        
+        // Confirm a new image after OTA_CONFIRM_MS; reboot into a downloaded one
+        ota->update();
+        
+        // Update Physical UI (OLED + Encoder + Buzzer)
+        {
+            ScopedTimer timer(PROF_PHYSICAL_UI);
+            physicalUI->update();
+        }
+        
+        // Update Web UI (WebSocket broadcasts)
+        {
+            ScopedTimer timer(PROF_WEB_UI);
+            webUI->update();
+        }
+        
+        // Batched telemetry frame to the gateway (node role)
+        gateway->update();
+        
+        // Sync UI states
+        syncUIStates();
+        
+        // Track heap fragmentation watermark
+        HeapMonitor::update();
+        
+        // Print status to serial (debug)
+        printSystemStatus();
+        
+        // Dim / sleep when idle, wake on input, WiFi client or running port
+        power->update();
+    }
     
-    // Small delay to prevent watchdog timeout
-    delay(10);
+    // Short delay when active; encoder-interruptible wait when asleep
+    power->idleWait();
 }
@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+"""
+Log Parser Benchmark for DIY Charger Simple
+
+Generates synthetic discharge logs (CSV and binary) and times:
+- the original row-by-row csv.DictReader loader (baseline)
+- the chunked numpy CSV and memory-mapped binary loaders
+- serial vs parallel processing across files
+
+Usage:
+    python bench_parse_logs.py
+    python bench_parse_logs.py --files 8 --rows 2000000 --jobs 8
+    python bench_parse_logs.py --keep /tmp/charger_logs
+"""
+
+import os
+import csv
+import time
+import shutil
+import tempfile
+import argparse
+from pathlib import Path
+
+import numpy as np
+
+from parse_logs import (BIN_HEADER, BIN_MAGIC, BIN_RECORD, BIN_VERSION,
+                        load_logs)
+
+
+def synthetic_arrays(rows, seed):
+    """1 Hz discharge: ~1 A load, voltage sagging 4.2 V -> 3.0 V with noise"""
+    rng = np.random.default_rng(seed)
+    t = np.arange(rows, dtype=np.float64)
+    frac = t / max(rows - 1, 1)
+    voltage = 4.2 - 0.9 * frac - 0.3 * frac ** 8 + rng.normal(0, 0.002, rows)
+    current = 1.0 + rng.normal(0, 0.005, rows)
+    mah = np.cumsum(current) / 3.6
+    wh = np.cumsum(voltage * current) / 3600
+    return t, voltage, current, mah, wh
+
+
+def write_csv(path, rows, seed, port=0):
+    t, voltage, current, mah, wh = synthetic_arrays(rows, seed)
+    table = np.column_stack([t, np.full(rows, port), voltage, current, voltage * current, mah, wh])
+    with open(path, 'w') as f:
+        f.write("Timestamp,Port,Voltage(V),Current(A),Power(W),mAh,Wh,Mode,Battery,Status\n")
+        np.savetxt(f, table, fmt=['%d', '%d', '%.3f', '%.3f', '%.3f', '%.1f', '%.2f'],
+                   delimiter=',', newline=',Discharging,Li-ion,Active\n')
+
+
+def write_bin(path, rows, seed, port=0):
+    t, voltage, current, mah, wh = synthetic_arrays(rows, seed)
+    header = np.zeros(1, dtype=BIN_HEADER)
+    header['magic'] = BIN_MAGIC
+    header['version'] = BIN_VERSION
+    header['record_size'] = BIN_RECORD.itemsize
+    records = np.zeros(rows, dtype=BIN_RECORD)
+    records['timestamp'] = t
+    records['port'] = port
+    records['mode'] = 2     # DISCHARGING
+    records['status'] = 1   # ACTIVE
+    records['voltage'] = voltage
+    records['current'] = current
+    records['mah'] = mah
+    records['wh'] = wh
+    with open(path, 'wb') as f:
+        header.tofile(f)
+        records.tofile(f)
+
+
+def legacy_load(filename):
+    """The pre-numpy loader: one dict per row, then Python reductions"""
+    data = []
+    with open(filename, 'r') as f:
+        for row in csv.DictReader(f):
+            data.append({
+                'timestamp': int(row['Timestamp']),
+                'port': int(row['Port']),
+                'voltage': float(row['Voltage(V)']),
+                'current': float(row['Current(A)']),
+                'power': float(row['Power(W)']),
+                'mah': float(row['mAh']),
+                'wh': float(row['Wh']),
+                'mode': row['Mode'],
+                'battery': row['Battery'],
+                'status': row['Status']
+            })
+    voltages = [d['voltage'] for d in data]
+    return data[-1]['mah'], sum(voltages) / len(voltages)
+
+
+def timed(label, rows, size, func):
+    start = time.perf_counter()
+    result = func()
+    elapsed = time.perf_counter() - start
+    print(f"  {label:<34} {elapsed:>8.2f}s {rows / elapsed / 1e6:>8.2f} Mrow/s "
+          f"{size / elapsed / 1e6:>8.1f} MB/s")
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Benchmark parse_logs.py loaders on synthetic logs')
+    parser.add_argument('--files', type=int, default=4, help='Number of log files per format')
+    parser.add_argument('--rows', type=int, default=1000000, help='Rows per file (1 Hz samples)')
+    parser.add_argument('--jobs', type=int, default=os.cpu_count() or 1, help='Parallel workers')
+    parser.add_argument('--keep', metavar='DIR', help='Write logs to DIR and keep them')
+    args = parser.parse_args()
+
+    workdir = Path(args.keep) if args.keep else Path(tempfile.mkdtemp(prefix='charger_bench_'))
+    workdir.mkdir(parents=True, exist_ok=True)
+
+    try:
+        print(f"\nGenerating {args.files} x {args.rows} rows (CSV + binary) in {workdir}...")
+        csv_files, bin_files = [], []
+        for i in range(args.files):
+            csv_files.append(str(workdir / f"log_{i}.csv"))
+            bin_files.append(str(workdir / f"log_{i}.bin"))
+            write_csv(csv_files[-1], args.rows, seed=i, port=i % 4)
+            write_bin(bin_files[-1], args.rows, seed=i, port=i % 4)
+
+        total_rows = args.files * args.rows
+        csv_size = sum(os.path.getsize(f) for f in csv_files)
+        bin_size = sum(os.path.getsize(f) for f in bin_files)
+        print(f"CSV: {csv_size / 1e6:.1f} MB   binary: {bin_size / 1e6:.1f} MB")
+
+        print("\n" + "=" * 74)
+        print(f"  {'loader':<34} {'time':>9} {'rows':>15} {'input':>11}")
+        print("-" * 74)
+        timed("legacy DictReader (1 file)", args.rows, csv_size / args.files,
+              lambda: legacy_load(csv_files[0]))
+        timed("numpy CSV (1 file)", args.rows, csv_size / args.files,
+              lambda: load_logs(csv_files[:1], 1))
+        timed("binary memmap (1 file)", args.rows, bin_size / args.files,
+              lambda: load_logs(bin_files[:1], 1))
+        print("-" * 74)
+        timed("numpy CSV, serial", total_rows, csv_size, lambda: load_logs(csv_files, 1))
+        timed(f"numpy CSV, {args.jobs} jobs", total_rows, csv_size, lambda: load_logs(csv_files, args.jobs))
+        timed("binary, serial", total_rows, bin_size, lambda: load_logs(bin_files, 1))
+        logs = timed(f"binary, {args.jobs} jobs", total_rows, bin_size, lambda: load_logs(bin_files, args.jobs))
+        print("=" * 74)
+
+        # Both formats must agree with the baseline
+        mah, avg_v = legacy_load(csv_files[0])
+        log, error = logs[0]
+        assert error is None, error
+        print(f"Check: legacy {mah:.1f} mAh / {avg_v:.4f} V, "
+              f"binary {log.metadata['final_capacity_mah']:.1f} mAh / {log.metadata['avg_voltage']:.4f} V\n")
+    finally:
+        if not args.keep:
+            shutil.rmtree(workdir, ignore_errors=True)
+
+
+if __name__ == '__main__':
+    main()
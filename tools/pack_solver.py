@@ -0,0 +1,348 @@
+#!/usr/bin/env python3
+"""
+Pack Matching Solver for DIY Charger Simple
+
+Chooses cells for series/parallel packs (e.g. 4S3P) from measured results
+so the parallel groups are as equal as possible:
+- Capacity: series pack is limited by its weakest group
+- Internal resistance: unequal groups sag and heat unequally
+
+Heuristic:
+1. Pick the S*P cells with the tightest capacity window
+2. Greedy (largest cell first into the weakest group that has room)
+3. Local search: best improving swap between the extreme groups and
+   every other group, repeated until no swap helps
+
+Input is the JSON from GET /api/results or a CSV with cell,mAh,dcir columns.
+
+Usage:
+    python pack_solver.py results.json --pack 4S3P
+    python pack_solver.py results.json --pack 13S4P --count 2
+    python pack_solver.py --benchmark
+"""
+
+import sys
+import csv
+import json
+import time
+import random
+import argparse
+from pathlib import Path
+
+# Relative IR spread is weighted lower than capacity spread: a few mOhm
+# between groups matters less than a few percent of capacity.
+IR_WEIGHT = 0.5
+MAX_SWEEPS = 200
+
+
+class Cell:
+    """One measured cell"""
+
+    __slots__ = ('name', 'mah', 'dcir')
+
+    def __init__(self, name, mah, dcir=0.0):
+        self.name = str(name)
+        self.mah = float(mah)
+        self.dcir = float(dcir)
+
+    def __repr__(self):
+        return f"Cell({self.name}, {self.mah:.0f}mAh, {self.dcir:.1f}mOhm)"
+
+
+def parse_config(text):
+    """Parse '4S3P' into (4, 3)"""
+    text = text.upper().strip()
+    try:
+        s_part, p_part = text.rstrip('P').split('S')
+        series, parallel = int(s_part), int(p_part)
+    except ValueError:
+        raise ValueError(f"Invalid pack configuration '{text}' (expected e.g. 4S3P)")
+    if series < 1 or parallel < 1:
+        raise ValueError(f"Invalid pack configuration '{text}'")
+    return series, parallel
+
+
+def load_cells(filename):
+    """Load cells from /api/results JSON or a cell,mAh,dcir CSV"""
+    path = Path(filename)
+    cells = []
+
+    if path.suffix.lower() == '.json':
+        with open(path) as f:
+            doc = json.load(f)
+        for r in doc.get('results', doc if isinstance(doc, list) else []):
+            name = r.get('cell') or f"#{r.get('id', len(cells))}"
+            cells.append(Cell(name, r['mAh'], r.get('dcir', 0)))
+    else:
+        with open(path, newline='') as f:
+            for row in csv.DictReader(f):
+                try:
+                    name = row.get('cell') or row.get('id') or f"#{len(cells)}"
+                    cells.append(Cell(name, row['mAh'], row.get('dcir') or 0))
+                except (ValueError, KeyError) as e:
+                    print(f"Warning: Skipping invalid row: {e}")
+
+    return cells
+
+
+# ============================================
+# PACK EVALUATION
+# ============================================
+
+def group_ir(group):
+    """Parallel resistance of a group, 0 if any cell is unmeasured"""
+    if any(c.dcir <= 0 for c in group):
+        return 0.0
+    return 1.0 / sum(1.0 / c.dcir for c in group)
+
+
+def pack_cost(caps, irs):
+    """Relative capacity spread plus weighted relative IR spread"""
+    mean_cap = sum(caps) / len(caps)
+    cost = (max(caps) - min(caps)) / mean_cap if mean_cap > 0 else 0.0
+
+    if irs and all(r > 0 for r in irs):
+        mean_ir = sum(irs) / len(irs)
+        cost += IR_WEIGHT * (max(irs) - min(irs)) / mean_ir
+    return cost
+
+
+class Pack:
+    """Solved pack: one list of cells per series group"""
+
+    def __init__(self, groups):
+        self.groups = groups
+
+    @property
+    def capacities(self):
+        return [sum(c.mah for c in g) for g in self.groups]
+
+    @property
+    def resistances(self):
+        return [group_ir(g) for g in self.groups]
+
+    @property
+    def cost(self):
+        return pack_cost(self.capacities, self.resistances)
+
+    def print_summary(self, title="Pack"):
+        caps = self.capacities
+        irs = self.resistances
+        print(f"\n{title}: {len(self.groups)}S{len(self.groups[0])}P")
+        print("-" * 60)
+        for i, g in enumerate(self.groups):
+            names = ' '.join(c.name for c in g)
+            ir_text = f"{irs[i]:6.1f} mOhm" if irs[i] > 0 else "     - mOhm"
+            print(f"  S{i + 1:<3} {caps[i]:8.0f} mAh {ir_text}   {names}")
+        print("-" * 60)
+        print(f"  Capacity spread: {max(caps) - min(caps):.0f} mAh "
+              f"({(max(caps) - min(caps)) * 100 / (sum(caps) / len(caps)):.2f}%)")
+        if all(r > 0 for r in irs):
+            print(f"  IR spread:       {max(irs) - min(irs):.2f} mOhm")
+        print(f"  Pack capacity:   {min(caps):.0f} mAh (weakest group)")
+
+
+# ============================================
+# SOLVER
+# ============================================
+
+def select_cells(cells, count):
+    """Tightest capacity window of 'count' cells (sorted sliding window)"""
+    ordered = sorted(cells, key=lambda c: c.mah)
+    best = 0
+    best_range = float('inf')
+    for i in range(len(ordered) - count + 1):
+        spread = ordered[i + count - 1].mah - ordered[i].mah
+        if spread < best_range:
+            best_range = spread
+            best = i
+    return ordered[best:best + count]
+
+
+def greedy_groups(cells, series, parallel):
+    """Largest cell first into the group with the lowest capacity that has room"""
+    groups = [[] for _ in range(series)]
+    sums = [0.0] * series
+    for cell in sorted(cells, key=lambda c: c.mah, reverse=True):
+        target = min((i for i in range(series) if len(groups[i]) < parallel),
+                     key=lambda i: sums[i])
+        groups[target].append(cell)
+        sums[target] += cell.mah
+    return groups
+
+
+def improve_groups(groups, max_sweeps=MAX_SWEEPS):
+    """Swap cells between groups while the pack cost drops"""
+    series = len(groups)
+    caps = [sum(c.mah for c in g) for g in groups]
+    mean_cap = sum(caps) / series  # Swaps never change the total
+    use_ir = all(c.dcir > 0 for g in groups for c in g)
+    cond = [sum(1.0 / c.dcir for c in g) for g in groups] if use_ir else [1.0] * series
+    irs = [1.0 / g for g in cond]
+    cost = pack_cost(caps, irs if use_ir else None)
+
+    for _ in range(max_sweeps):
+        # Only swaps touching an extreme group can shrink a max-min spread
+        extremes = {caps.index(max(caps)), caps.index(min(caps))}
+        if use_ir:
+            extremes |= {irs.index(max(irs)), irs.index(min(irs))}
+        ir_total = sum(irs)
+
+        best = None
+        for a in extremes:
+            for b in range(series):
+                if a == b:
+                    continue
+                # Spread of the groups the swap leaves alone
+                rest = [k for k in range(series) if k != a and k != b]
+                rest_cap_hi = max((caps[k] for k in rest), default=-1e18)
+                rest_cap_lo = min((caps[k] for k in rest), default=1e18)
+                rest_ir_hi = max((irs[k] for k in rest), default=-1e18)
+                rest_ir_lo = min((irs[k] for k in rest), default=1e18)
+
+                for i, ca in enumerate(groups[a]):
+                    for j, cb in enumerate(groups[b]):
+                        delta = cb.mah - ca.mah
+                        cap_a, cap_b = caps[a] + delta, caps[b] - delta
+                        new_cost = (max(rest_cap_hi, cap_a, cap_b) -
+                                    min(rest_cap_lo, cap_a, cap_b)) / mean_cap
+                        if use_ir:
+                            dg = 1.0 / cb.dcir - 1.0 / ca.dcir
+                            ir_a, ir_b = 1.0 / (cond[a] + dg), 1.0 / (cond[b] - dg)
+                            mean_ir = (ir_total - irs[a] - irs[b] + ir_a + ir_b) / series
+                            new_cost += IR_WEIGHT * (max(rest_ir_hi, ir_a, ir_b) -
+                                                     min(rest_ir_lo, ir_a, ir_b)) / mean_ir
+                        if new_cost < cost - 1e-12:
+                            cost = new_cost
+                            best = (a, i, b, j)
+
+        if best is None:
+            break
+        a, i, b, j = best
+        groups[a][i], groups[b][j] = groups[b][j], groups[a][i]
+        for k in (a, b):
+            caps[k] = sum(c.mah for c in groups[k])
+            if use_ir:
+                cond[k] = sum(1.0 / c.dcir for c in groups[k])
+                irs[k] = 1.0 / cond[k]
+
+    return groups
+
+
+def solve_pack(cells, series, parallel):
+    """Build one balanced pack from the pool"""
+    needed = series * parallel
+    if len(cells) < needed:
+        raise ValueError(f"{series}S{parallel}P needs {needed} cells, only {len(cells)} available")
+    chosen = select_cells(cells, needed)
+    return Pack(improve_groups(greedy_groups(chosen, series, parallel)))
+
+
+def solve_packs(cells, series, parallel, count):
+    """Build up to 'count' packs, each from the tightest remaining window"""
+    pool = list(cells)
+    packs = []
+    while len(packs) < count and len(pool) >= series * parallel:
+        pack = solve_pack(pool, series, parallel)
+        used = {id(c) for g in pack.groups for c in g}
+        pool = [c for c in pool if id(c) not in used]
+        packs.append(pack)
+    return packs
+
+
+# ============================================
+# BENCHMARK
+# ============================================
+
+def synthetic_cells(count, seed=1):
+    """Cells with a realistic spread: 2500 +/- 80 mAh, 45 +/- 8 mOhm"""
+    rng = random.Random(seed)
+    return [Cell(f"C{i}", rng.gauss(2500, 80), max(15.0, rng.gauss(45, 8)))
+            for i in range(count)]
+
+
+def naive_pack(cells, series, parallel):
+    """Baseline: tightest window, then round-robin by capacity (what we do by hand)"""
+    chosen = sorted(select_cells(cells, series * parallel), key=lambda c: c.mah)
+    groups = [[] for _ in range(series)]
+    for k, cell in enumerate(chosen):
+        row, col = divmod(k, series)
+        groups[col if row % 2 == 0 else series - 1 - col].append(cell)
+    return Pack(groups)
+
+
+def run_benchmark(pool_sizes=(1000, 5000, 20000), configs=('4S3P', '13S4P', '20S10P')):
+    print("\nPack solver benchmark (synthetic cells)")
+    print("=" * 78)
+    print(f"{'cells':>6} {'config':>7} {'time ms':>9} {'cap spread':>11} {'naive':>9} "
+          f"{'IR spread':>10} {'naive':>9}")
+    print("-" * 78)
+
+    for n in pool_sizes:
+        cells = synthetic_cells(n)
+        for config in configs:
+            series, parallel = parse_config(config)
+
+            start = time.perf_counter()
+            pack = solve_pack(cells, series, parallel)
+            elapsed = (time.perf_counter() - start) * 1000
+
+            base = naive_pack(cells, series, parallel)
+            caps, base_caps = pack.capacities, base.capacities
+            irs, base_irs = pack.resistances, base.resistances
+            print(f"{n:>6} {config:>7} {elapsed:>9.1f} "
+                  f"{max(caps) - min(caps):>8.1f}mAh {max(base_caps) - min(base_caps):>6.1f}mAh "
+                  f"{max(irs) - min(irs):>7.2f}mOhm {max(base_irs) - min(base_irs):>5.2f}mOhm")
+
+    # Whole-pool throughput: as many 13S4P packs as the pool allows
+    cells = synthetic_cells(5000)
+    start = time.perf_counter()
+    packs = solve_packs(cells, 13, 4, len(cells))
+    elapsed = time.perf_counter() - start
+    worst = max((max(p.capacities) - min(p.capacities)) for p in packs)
+    print("-" * 78)
+    print(f"5000 cells -> {len(packs)} x 13S4P in {elapsed:.2f}s, worst capacity spread {worst:.1f} mAh")
+    print("=" * 78 + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Group measured cells into balanced series/parallel packs'
+    )
+    parser.add_argument('input_file', nargs='?', help='/api/results JSON or cell,mAh,dcir CSV')
+    parser.add_argument('--pack', metavar='SxP', help='Pack configuration, e.g. 4S3P')
+    parser.add_argument('--count', type=int, default=1, help='Number of packs to build')
+    parser.add_argument('--benchmark', action='store_true', help='Run solver benchmark on synthetic cells')
+
+    args = parser.parse_args()
+
+    if args.benchmark:
+        run_benchmark()
+        return
+
+    if not args.input_file or not args.pack:
+        parser.error("input_file and --pack are required")
+
+    if not Path(args.input_file).exists():
+        print(f"Error: File '{args.input_file}' not found")
+        sys.exit(1)
+
+    try:
+        series, parallel = parse_config(args.pack)
+        cells = load_cells(args.input_file)
+        packs = solve_packs(cells, series, parallel, args.count)
+    except ValueError as e:
+        print(f"Error: {e}")
+        sys.exit(1)
+
+    if not packs:
+        print(f"Error: {args.pack} needs {series * parallel} cells, only {len(cells)} available")
+        sys.exit(1)
+
+    for i, pack in enumerate(packs):
+        pack.print_summary(f"Pack {i + 1}")
+    print()
+
+
+if __name__ == '__main__':
+    main()
@@ -2,38 +2,181 @@
 """
 Battery Log Parser & Analyzer for DIY Charger Simple
 
-This script parses CSV logs from the charger and generates:
+This script parses CSV and binary logs from the charger and generates:
 - Discharge/charge curves
 - Capacity statistics
 - Battery health analysis
 - Comparison charts
 
+Logs are streamed in chunks and reduced with numpy, so multi-GB archives
+never have to fit in memory. Both the CSV from BatteryLogger::getCSVHeader()
+and the binary LogRecord format (include/Logger.h) are accepted; several
+files are processed in parallel.
+
 Usage:
     python parse_logs.py battery_log.csv
     python parse_logs.py battery_log.csv --plot --export
+    python parse_logs.py archive/*.bin --jobs 8
+    python parse_logs.py logs/*.csv --pack 4S3P
+    python parse_logs.py results.json --pack 4S3P
 """
 
+import os
 import sys
-import csv
 import argparse
+import itertools
 from datetime import datetime
 from pathlib import Path
+from concurrent.futures import ProcessPoolExecutor
 
 try:
-    import matplotlib.pyplot as plt
     import numpy as np
+except ImportError:
+    print("Error: numpy not installed.")
+    print("Install with: pip install numpy")
+    sys.exit(1)
+
+try:
+    import matplotlib.pyplot as plt
     PLOTTING_AVAILABLE = True
 except ImportError:
     PLOTTING_AVAILABLE = False
     print("Warning: matplotlib not installed. Plotting disabled.")
-    print("Install with: pip install matplotlib numpy")
+    print("Install with: pip install matplotlib")
+
+# ============================================
+# LOG FORMATS
+# ============================================
+
+# CSV columns by name; the unit suffix is optional (/api/logs omits it)
+CSV_NUMERIC_COLUMNS = ['Timestamp', 'Port', 'Voltage', 'Current', 'Power', 'mAh', 'Wh']
+CSV_TEXT_COLUMNS = ['Mode', 'Battery', 'Status']
+
+# Binary: LogFileHeader followed by LogRecord[] (little-endian, packed)
+BIN_MAGIC = b'CHGL'
+BIN_VERSION = 1
+BIN_HEADER = np.dtype([('magic', 'S4'), ('version', '<u2'), ('record_size', '<u2'),
+                       ('reserved', '<u4', (2,))])
+BIN_RECORD = np.dtype([('timestamp', '<u4'), ('port', 'u1'), ('mode', 'u1'),
+                       ('battery', 'u1'), ('status', 'u1'), ('voltage', '<f4'),
+                       ('current', '<f4'), ('mah', '<f4'), ('wh', '<f4')])
+
+# Enum order matches BatteryTypes.h
+MODE_NAMES = ['Safety', 'Charging', 'Discharging']
+BATTERY_NAMES = ['Li-ion', 'LiFePO4', 'LiPo']
+STATUS_NAMES = ['Idle', 'Active', 'Complete', 'Error']
+
+CHUNK_ROWS = 1 << 20    # Rows per chunk (~60 MB CSV / 24 MB binary)
+PLOT_POINTS = 20000     # Decimated series kept for plots
+
+def _enum_name(names, code):
+    return names[code] if 0 <= code < len(names) else 'Unknown'
+
+def is_binary_log(filename):
+    with open(filename, 'rb') as f:
+        return f.read(4) == BIN_MAGIC
+
+def _parse_csv_lines(lines, numeric_cols):
+    """Parse a block of CSV lines; falls back to per-line parsing on bad rows"""
+    try:
+        return np.loadtxt(lines, delimiter=',', usecols=numeric_cols,
+                          dtype=np.float64, ndmin=2), lines, 0
+    except ValueError:
+        pass
+    
+    good = []
+    for line in lines:
+        try:
+            np.loadtxt([line], delimiter=',', usecols=numeric_cols, dtype=np.float64)
+            good.append(line)
+        except ValueError:
+            continue
+    skipped = len(lines) - len(good)
+    if not good:
+        return np.empty((0, len(numeric_cols))), good, skipped
+    return np.loadtxt(good, delimiter=',', usecols=numeric_cols,
+                      dtype=np.float64, ndmin=2), good, skipped
+
+def iter_csv_chunks(filename, chunk_rows=CHUNK_ROWS):
+    """Yield column arrays for each block of chunk_rows CSV lines"""
+    with open(filename, 'r') as f:
+        names = [h.split('(')[0].strip() for h in f.readline().strip().split(',')]
+        try:
+            numeric_cols = [names.index(c) for c in CSV_NUMERIC_COLUMNS]
+            text_cols = [names.index(c) for c in CSV_TEXT_COLUMNS]
+        except ValueError as e:
+            raise ValueError(f"Unexpected CSV header: {e}")
+        
+        while True:
+            lines = list(itertools.islice(f, chunk_rows))
+            if not lines:
+                break
+            values, good, skipped = _parse_csv_lines(lines, numeric_cols)
+            if skipped:
+                print(f"Warning: Skipped {skipped} invalid rows in {Path(filename).name}")
+            if not good:
+                continue
+            
+            first = good[0].rstrip('\n').split(',')
+            last = good[-1].rstrip('\n').split(',')
+            yield {
+                'timestamp': values[:, 0],
+                'port': values[:, 1],
+                'voltage': values[:, 2],
+                'current': values[:, 3],
+                'power': values[:, 4],
+                'mah': values[:, 5],
+                'wh': values[:, 6],
+                'first_text': [first[c] for c in text_cols],
+                'last_text': [last[c] for c in text_cols],
+            }
+
+def iter_bin_chunks(filename, chunk_rows=CHUNK_ROWS):
+    """Yield column arrays from a memory-mapped binary log"""
+    header = np.fromfile(filename, dtype=BIN_HEADER, count=1)
+    if len(header) == 0 or header['magic'][0] != BIN_MAGIC:
+        raise ValueError("Not a binary charger log")
+    if header['version'][0] != BIN_VERSION or header['record_size'][0] != BIN_RECORD.itemsize:
+        raise ValueError(f"Unsupported binary log version {header['version'][0]}")
+    
+    # A truncated last record (power loss mid-write) is ignored
+    count = (os.path.getsize(filename) - BIN_HEADER.itemsize) // BIN_RECORD.itemsize
+    if count <= 0:
+        return
+    records = np.memmap(filename, dtype=BIN_RECORD, mode='r',
+                        offset=BIN_HEADER.itemsize, shape=(count,))
+    
+    for start in range(0, count, chunk_rows):
+        r = records[start:start + chunk_rows]
+        voltage = r['voltage'].astype(np.float64)
+        current = r['current'].astype(np.float64)
+        text = lambda k: [_enum_name(MODE_NAMES, int(r['mode'][k])),
+                          _enum_name(BATTERY_NAMES, int(r['battery'][k])),
+                          _enum_name(STATUS_NAMES, int(r['status'][k]))]
+        yield {
+            'timestamp': r['timestamp'].astype(np.float64),
+            'port': r['port'].astype(np.float64),
+            'voltage': voltage,
+            'current': current,
+            'power': voltage * current,
+            'mah': r['mah'].astype(np.float64),
+            'wh': r['wh'].astype(np.float64),
+            'first_text': text(0),
+            'last_text': text(-1),
+        }
+
+# ============================================
+# LOG ANALYSIS
+# ============================================
 
 class BatteryLog:
     """Represents a single battery test log"""
     
+    SERIES_FIELDS = ('timestamp', 'voltage', 'current', 'mah', 'power')
+    
     def __init__(self, filename):
         self.filename = filename
-        self.data = []
+        self.series = {}
         self.metadata = {
             'port': None,
             'battery_type': None,
@@ -44,60 +187,68 @@ class BatteryLog:
             'final_capacity_mah': 0,
             'final_energy_wh': 0,
             'avg_voltage': 0,
-            'avg_current': 0
+            'avg_current': 0,
+            'points': 0
         }
         
-    def load(self):
-        """Load CSV file and parse data"""
-        with open(self.filename, 'r') as f:
-            reader = csv.DictReader(f)
-            
-            for row in reader:
-                try:
-                    data_point = {
-                        'timestamp': int(row['Timestamp']),
-                        'port': int(row['Port']),
-                        'voltage': float(row['Voltage(V)']),
-                        'current': float(row['Current(A)']),
-                        'power': float(row['Power(W)']),
-                        'mah': float(row['mAh']),
-                        'wh': float(row['Wh']),
-                        'mode': row['Mode'],
-                        'battery': row['Battery'],
-                        'status': row['Status']
-                    }
-                    self.data.append(data_point)
-                except (ValueError, KeyError) as e:
-                    print(f"Warning: Skipping invalid row: {e}")
-                    continue
+    def load(self, chunk_rows=CHUNK_ROWS):
+        """Stream the log chunk by chunk, keeping only running sums and a decimated series"""
+        reader = iter_bin_chunks if is_binary_log(self.filename) else iter_csv_chunks
         
-        if not self.data:
-            raise ValueError("No valid data found in CSV file")
+        count = 0
+        sum_voltage = 0.0
+        sum_current = 0.0
+        min_voltage = np.inf
+        max_voltage = -np.inf
+        first = last = None
         
-        # Calculate metadata
-        self._calculate_metadata()
+        # Every stride-th row is kept; stride doubles when the buffer fills
+        stride = 1
+        kept = {k: [] for k in self.SERIES_FIELDS}
+        kept_rows = 0
         
-    def _calculate_metadata(self):
-        """Calculate summary statistics"""
-        if not self.data:
-            return
+        for chunk in reader(self.filename, chunk_rows):
+            n = len(chunk['voltage'])
+            if first is None:
+                first = {'timestamp': chunk['timestamp'][0], 'port': chunk['port'][0],
+                         'text': chunk['first_text']}
+            last = {'timestamp': chunk['timestamp'][-1], 'mah': chunk['mah'][-1],
+                    'wh': chunk['wh'][-1]}
+            
+            sum_voltage += float(np.sum(chunk['voltage']))
+            sum_current += float(np.sum(chunk['current']))
+            min_voltage = min(min_voltage, float(np.min(chunk['voltage'])))
+            max_voltage = max(max_voltage, float(np.max(chunk['voltage'])))
+            
+            offset = (-count) % stride
+            for k in self.SERIES_FIELDS:
+                kept[k].append(chunk[k][offset::stride].copy())
+            kept_rows += len(range(offset, n, stride))
+            count += n
+            
+            if kept_rows > 2 * PLOT_POINTS:
+                for k in self.SERIES_FIELDS:
+                    kept[k] = [np.concatenate(kept[k])[::2]]
+                kept_rows = len(kept['voltage'][0])
+                stride *= 2
         
-        self.metadata['port'] = self.data[0]['port']
-        self.metadata['battery_type'] = self.data[0]['battery']
-        self.metadata['mode'] = self.data[0]['mode']
-        self.metadata['start_time'] = self.data[0]['timestamp']
-        self.metadata['end_time'] = self.data[-1]['timestamp']
-        self.metadata['duration_seconds'] = self.metadata['end_time'] - self.metadata['start_time']
-        self.metadata['final_capacity_mah'] = self.data[-1]['mah']
-        self.metadata['final_energy_wh'] = self.data[-1]['wh']
+        if count == 0:
+            raise ValueError("No valid data found in log file")
         
-        voltages = [d['voltage'] for d in self.data]
-        currents = [d['current'] for d in self.data]
+        self.series = {k: np.concatenate(v) for k, v in kept.items()}
         
-        self.metadata['avg_voltage'] = sum(voltages) / len(voltages)
-        self.metadata['avg_current'] = sum(currents) / len(currents)
-        self.metadata['min_voltage'] = min(voltages)
-        self.metadata['max_voltage'] = max(voltages)
+        self.metadata['port'] = int(first['port'])
+        self.metadata['mode'], self.metadata['battery_type'] = first['text'][0], first['text'][1]
+        self.metadata['start_time'] = int(first['timestamp'])
+        self.metadata['end_time'] = int(last['timestamp'])
+        self.metadata['duration_seconds'] = self.metadata['end_time'] - self.metadata['start_time']
+        self.metadata['final_capacity_mah'] = float(last['mah'])
+        self.metadata['final_energy_wh'] = float(last['wh'])
+        self.metadata['avg_voltage'] = sum_voltage / count
+        self.metadata['avg_current'] = sum_current / count
+        self.metadata['min_voltage'] = min_voltage
+        self.metadata['max_voltage'] = max_voltage
+        self.metadata['points'] = count
         
     def print_summary(self):
         """Print summary statistics"""
@@ -113,7 +264,7 @@ class BatteryLog:
         print(f"\nVoltage Range: {self.metadata['min_voltage']:.3f}V - {self.metadata['max_voltage']:.3f}V")
         print(f"Avg Voltage:   {self.metadata['avg_voltage']:.3f}V")
         print(f"Avg Current:   {self.metadata['avg_current']:.3f}A")
-        print(f"\nData Points:   {len(self.data)}")
+        print(f"\nData Points:   {self.metadata['points']}")
         print("="*60 + "\n")
         
     def plot_curves(self, save_path=None):
@@ -122,14 +273,14 @@ class BatteryLog:
             print("Plotting not available. Install matplotlib.")
             return
         
-        timestamps = [d['timestamp'] for d in self.data]
-        voltages = [d['voltage'] for d in self.data]
-        currents = [d['current'] for d in self.data]
-        capacities = [d['mah'] for d in self.data]
-        powers = [d['power'] for d in self.data]
+        timestamps = self.series['timestamp']
+        voltages = self.series['voltage']
+        currents = self.series['current']
+        capacities = self.series['mah']
+        powers = self.series['power']
         
         # Convert timestamps to hours
-        time_hours = [(t - timestamps[0]) / 3600 for t in timestamps]
+        time_hours = (timestamps - timestamps[0]) / 3600
         
         # Create figure with subplots
         fig, axes = plt.subplots(2, 2, figsize=(12, 10))
@@ -205,8 +356,8 @@ class BatteryLog:
             
             f.write("DATA QUALITY\n")
             f.write("-" * 60 + "\n")
-            f.write(f"Data Points:   {len(self.data)}\n")
-            f.write(f"Sample Rate:   {len(self.data) / (self.metadata['duration_seconds']/60):.2f} samples/minute\n\n")
+            f.write(f"Data Points:   {self.metadata['points']}\n")
+            f.write(f"Sample Rate:   {self.metadata['points'] / (self.metadata['duration_seconds']/60):.2f} samples/minute\n\n")
             
             # Battery health estimation
             f.write("BATTERY HEALTH ESTIMATION\n")
@@ -230,38 +381,62 @@ class BatteryLog:
         
         print(f"Summary exported to: {output_file}")
 
-def main():
-    parser = argparse.ArgumentParser(
-        description='Parse and analyze battery test logs from DIY Charger Simple'
-    )
-    parser.add_argument('input_file', help='CSV log file to analyze')
-    parser.add_argument('--plot', action='store_true', help='Generate plots')
-    parser.add_argument('--export', action='store_true', help='Export summary to text file')
-    parser.add_argument('--save-plot', metavar='FILE', help='Save plot to file instead of displaying')
+def load_log(input_file, chunk_rows=CHUNK_ROWS):
+    """Load one log; returns (log, error) so a worker never raises across processes"""
+    log = BatteryLog(input_file)
+    try:
+        log.load(chunk_rows)
+    except Exception as e:
+        return log, str(e)
+    return log, None
+
+def load_logs(input_files, jobs, chunk_rows=CHUNK_ROWS):
+    """Load logs in input order, one file per worker process"""
+    if jobs <= 1 or len(input_files) <= 1:
+        return [load_log(f, chunk_rows) for f in input_files]
+    with ProcessPoolExecutor(max_workers=min(jobs, len(input_files))) as pool:
+        return list(pool.map(load_log, input_files, itertools.repeat(chunk_rows)))
+
+def build_packs(input_files, config, count, jobs):
+    """Group the tested cells into balanced packs (see pack_solver.py)"""
+    from pack_solver import Cell, load_cells, parse_config, solve_packs
     
-    args = parser.parse_args()
+    series, parallel = parse_config(config)
     
-    # Check if file exists
-    if not Path(args.input_file).exists():
-        print(f"Error: File '{args.input_file}' not found")
-        sys.exit(1)
+    # /api/results exports carry DCIR; a discharge log is one cell (capacity only)
+    cells = []
+    log_files = []
+    for input_file in input_files:
+        if Path(input_file).suffix.lower() == '.json':
+            cells.extend(load_cells(input_file))
+        else:
+            log_files.append(input_file)
     
-    # Load and analyze log
-    print(f"Loading log file: {args.input_file}")
-    log = BatteryLog(args.input_file)
+    for log, error in load_logs(log_files, jobs):
+        if error:
+            print(f"Skipping {log.filename}: {error}")
+            continue
+        if log.metadata['mode'] != 'Discharging':
+            print(f"Skipping {log.filename}: not a discharge log")
+            continue
+        cells.append(Cell(Path(log.filename).stem, log.metadata['final_capacity_mah']))
     
-    try:
-        log.load()
-    except Exception as e:
-        print(f"Error loading file: {e}")
-        sys.exit(1)
+    packs = solve_packs(cells, series, parallel, count)
+    if not packs:
+        raise ValueError(f"{config} needs {series * parallel} cells, only {len(cells)} available")
     
+    for i, pack in enumerate(packs):
+        pack.print_summary(f"Pack {i + 1}")
+    print()
+
+def analyze_log(log, args):
+    """Summary, export and plots for one loaded log"""
     # Print summary
     log.print_summary()
     
     # Export summary if requested
     if args.export:
-        base_name = Path(args.input_file).stem
+        base_name = Path(log.filename).stem
         output_file = f"{base_name}_summary.txt"
         log.export_summary(output_file)
     
@@ -269,18 +444,59 @@ def main():
     if args.plot or args.save_plot:
         if not PLOTTING_AVAILABLE:
             print("Error: matplotlib not installed")
-            print("Install with: pip install matplotlib numpy")
+            print("Install with: pip install matplotlib")
             sys.exit(1)
         
         save_path = args.save_plot if args.save_plot else None
         if args.plot and not save_path:
             save_path = None  # Will show interactive plot
         elif not save_path:
-            base_name = Path(args.input_file).stem
+            base_name = Path(log.filename).stem
             save_path = f"{base_name}_plot.png"
         
         log.plot_curves(save_path)
 
+def main():
+    parser = argparse.ArgumentParser(
+        description='Parse and analyze battery test logs from DIY Charger Simple'
+    )
+    parser.add_argument('input_files', nargs='+', metavar='input_file', help='CSV or binary log file(s) to analyze')
+    parser.add_argument('--plot', action='store_true', help='Generate plots')
+    parser.add_argument('--export', action='store_true', help='Export summary to text file')
+    parser.add_argument('--save-plot', metavar='FILE', help='Save plot to file instead of displaying')
+    parser.add_argument('--pack', metavar='SxP', help='Group tested cells into balanced packs, e.g. 4S3P')
+    parser.add_argument('--pack-count', type=int, default=1, help='Number of packs to build with --pack')
+    parser.add_argument('--jobs', type=int, default=os.cpu_count() or 1, help='Files processed in parallel (default: all cores)')
+    parser.add_argument('--chunk-rows', type=int, default=CHUNK_ROWS, help='Rows per streamed chunk')
+    
+    args = parser.parse_args()
+    
+    # Check if files exist
+    for input_file in args.input_files:
+        if not Path(input_file).exists():
+            print(f"Error: File '{input_file}' not found")
+            sys.exit(1)
+    
+    if args.pack:
+        try:
+            build_packs(args.input_files, args.pack, args.pack_count, args.jobs)
+        except Exception as e:
+            print(f"Error building packs: {e}")
+            sys.exit(1)
+        return
+    
+    print(f"Loading {len(args.input_files)} log file(s)...")
+    failed = False
+    for log, error in load_logs(args.input_files, args.jobs, args.chunk_rows):
+        if error:
+            print(f"Error loading {log.filename}: {error}")
+            failed = True
+            continue
+        analyze_log(log, args)
+    
+    if failed:
+        sys.exit(1)
+
 if __name__ == '__main__':
     main()
 
@@ -296,6 +512,14 @@ python parse_logs.py battery_log_port1.csv --plot
 # Export summary and save plot
 python parse_logs.py battery_log_port1.csv --export --save-plot output.png
 
+# Build two balanced 4S3P packs from discharge logs or an /api/results export
+python parse_logs.py logs/*.csv --pack 4S3P --pack-count 2
+curl http://192.168.4.1/api/results > results.json
+python parse_logs.py results.json --pack 4S3P
+
+# Summarize a whole archive, 8 files at a time
+python parse_logs.py archive/*.bin archive/*.csv --jobs 8
+
 # Batch process multiple files
 for file in *.csv; do
     python parse_logs.py "$file" --export --save-plot "${file%.csv}_plot.png"